@@ -0,0 +1,33 @@
+﻿#include "snakeAllocations.h"
+
+#ifdef SNAKE_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+static atomic<uint64_t> allocationCount{ 0 };
+
+uint64_t AllocationCount() {
+    return allocationCount.load(memory_order_relaxed);
+}
+
+// Les autres formes (tableaux, sans exception) passent par celle-ci
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* memory = malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+#endif
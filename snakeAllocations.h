@@ -0,0 +1,23 @@
+﻿// Compteur d'allocations (sans dépendance à SFML)
+//
+// Avec -DSNAKE_COUNT_ALLOCATIONS (ou -DSNAKE_PROFILING), snakeAllocations.cpp
+// remplace l'opérateur new global par une version qui compte chaque
+// allocation, tous fils confondus. Sans ces drapeaux, le fichier est vide et
+// l'opérateur new reste celui de la bibliothèque standard.
+
+#pragma once
+
+#if defined(SNAKE_PROFILING) && !defined(SNAKE_COUNT_ALLOCATIONS)
+#define SNAKE_COUNT_ALLOCATIONS
+#endif
+
+#ifdef SNAKE_COUNT_ALLOCATIONS
+
+#include <cstdint>
+
+/*
+  retourne Le nombre d'allocations (opérateur new) depuis le lancement
+*/
+uint64_t AllocationCount();
+
+#endif
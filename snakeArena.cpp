@@ -0,0 +1,504 @@
+﻿#include "snakeArena.h"
+
+#include <cstdlib>
+#include <thread>
+using namespace std;
+
+// Tentatives de tirage d'une case vide avant de renoncer jusqu'au pas suivant
+static const uint32_t SPAWN_ATTEMPTS = 64;
+
+// Prétendant à une case : longueur (15 bits), égalité (1 bit), numéro du serpent (16 bits).
+// Le plus long l'emporte quel que soit l'ordre d'arrivée ; l'égalité n'est gardée
+// que si personne de plus long n'arrive ensuite.
+static const uint32_t CLAIM_LENGTH_SHIFT = 17;
+static const uint32_t CLAIM_MAX_LENGTH = 0x7FFF;
+static const uint32_t CLAIM_TIE = 1u << 16;
+static const uint32_t CLAIM_SNAKE = 0xFFFF;
+
+// Directions, dans l'ordre de SimAction (Up, Down, Left, Right)
+static const int MOVES[4][2] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+
+/*
+  Change la direction d'un serpent, sauf demi-tour
+*/
+static void Turn(ArenaSnake& snake, SimAction action) {
+    if (action == SimAction::None) {
+        return;
+    }
+    const int* move = MOVES[(int)action - (int)SimAction::Up];
+    if (move[0] != -snake.dirX || move[1] != -snake.dirY) {
+        snake.dirX = move[0];
+        snake.dirY = move[1];
+    }
+}
+
+void Arena::Init(const GridShape& shape, uint32_t snakeCount, uint32_t fruitCount, uint32_t obstacleCount,
+                 uint64_t seed, uint32_t threadCount, const Level* arenaLevel) {
+    level = arenaLevel;
+    grid = level != nullptr ? level->Grid() : shape;
+    grid.width = min(max(grid.width, MIN_GRID_SIZE), MAX_GRID_SIZE);
+    grid.height = min(max(grid.height, MIN_GRID_SIZE), MAX_GRID_SIZE);
+    snakeCount = min(snakeCount, ARENA_MAX_SNAKES);
+    uint32_t cellCount = grid.CellCount();
+    occupancy.assign(cellCount, (uint32_t)EMPTY);
+    claims.assign(cellCount, 0);
+    rng = seed;
+    tick = 0;
+
+    snakes.assign(snakeCount, ArenaSnake());
+    for (uint32_t i = 0; i < snakeCount; i++) {
+        snakes[i].rng = StreamSeed(seed, i);
+        snakes[i].body.Init(16, grid);
+    }
+    actions.assign(snakeCount, SimAction::None);
+    targets.assign(snakeCount, NO_CELL);
+    releasedTails.assign(snakeCount, NO_CELL);
+    eatenFruits.assign(snakeCount, 0);
+    leavingTails.assign(snakeCount, NO_CELL);
+    outcomes.assign(snakeCount, ArenaOutcome::Idle);
+
+    // Le fil appelant travaille aussi ; au moins un bloc de serpents par fil
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    chunkCount = (snakeCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    pool.Init(min(threadCount, max(1u, chunkCount)));
+
+    // Murs du niveau : chaque bloc écrit ses propres cases, sans verrou
+    nextFruit = 0;
+    if (level != nullptr) {
+        auto load = [this](uint32_t chunk) {
+            level->ForEachWall(chunk, [this](Cell wall) { occupancy[wall] = OBSTACLE; });
+        };
+        pool.Run(level->ChunkCount(), load);
+    }
+
+    obstacles.clear();
+    for (uint32_t i = 0; i < obstacleCount; i++) {
+        Cell cell = RandomEmptyCell(rng);
+        if (cell == NO_CELL) {
+            break;
+        }
+        occupancy[cell] = OBSTACLE;
+        obstacles.push_back(cell);
+    }
+    for (uint32_t i = 0; i < snakeCount; i++) {
+        Spawn(i);
+    }
+    fruits.assign(fruitCount, NO_CELL);
+    missingFruits.clear();
+    missingFruits.reserve(fruitCount);
+    for (uint32_t slot = 0; slot < fruitCount; slot++) {
+        PlaceFruit(slot);
+    }
+    changedCells.clear();
+
+    bandCount = min((uint32_t)grid.height, pool.ThreadCount() * BANDS_PER_THREAD);
+    rowBands.resize(grid.height);
+    for (int y = 0; y < grid.height; y++) {
+        rowBands[y] = (uint32_t)((uint64_t)y * bandCount / grid.height);
+    }
+    chunkBands.assign(chunkCount * bandCount, 0);
+    bandStarts.assign(bandCount + 1, 0);
+    bandOrder.assign(snakeCount, 0);
+}
+
+void Arena::Step() {
+    auto decide = [this](uint32_t chunk) { DecideRange(chunk); };
+    pool.Run(chunkCount, decide);
+
+    // Position d'écriture de chaque bloc dans chaque bande : bandes dans l'ordre,
+    // puis blocs dans l'ordre, ce qui range chaque bande par numéro de serpent
+    uint32_t position = 0;
+    for (uint32_t band = 0; band < bandCount; band++) {
+        bandStarts[band] = position;
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            uint32_t& slot = chunkBands[chunk * bandCount + band];
+            uint32_t count = slot;
+            slot = position;
+            position += count;
+        }
+    }
+    bandStarts[bandCount] = position;
+
+    auto sort = [this](uint32_t chunk) { SortRange(chunk); };
+    pool.Run(chunkCount, sort);
+    auto resolve = [this](uint32_t band) { ResolveBand(band); };
+    pool.Run(bandCount, resolve);
+    // Les queues d'abord : une tête peut prendre la case que libère la queue d'un autre serpent
+    auto release = [this](uint32_t chunk) { ReleaseRange(chunk); };
+    pool.Run(chunkCount, release);
+    auto advance = [this](uint32_t chunk) { AdvanceRange(chunk); };
+    pool.Run(chunkCount, advance);
+
+    Finish();
+    tick++;
+}
+
+void Arena::DecideRange(uint32_t chunk) {
+    uint32_t begin = chunk * CHUNK_SIZE;
+    uint32_t end = min(begin + CHUNK_SIZE, SnakeCount());
+    uint32_t* counts = &chunkBands[chunk * bandCount];
+    fill(counts, counts + bandCount, 0);
+    for (uint32_t i = begin; i < end; i++) {
+        ArenaSnake& snake = snakes[i];
+        releasedTails[i] = NO_CELL;
+        if (!snake.alive) {
+            targets[i] = NO_CELL;
+            outcomes[i] = ArenaOutcome::Idle;
+            continue;
+        }
+        Turn(snake, snake.bot ? DecideBot(snake) : actions[i]);
+        actions[i] = SimAction::None;
+        Cell target = Neighbour(snake.body.Head(), snake.dirX, snake.dirY);
+        targets[i] = target;
+        outcomes[i] = ArenaOutcome::Moved;
+        counts[rowBands[grid.CellY(target)]]++;
+    }
+}
+
+void Arena::SortRange(uint32_t chunk) {
+    uint32_t begin = chunk * CHUNK_SIZE;
+    uint32_t end = min(begin + CHUNK_SIZE, SnakeCount());
+    uint32_t* positions = &chunkBands[chunk * bandCount];
+    for (uint32_t i = begin; i < end; i++) {
+        if (targets[i] != NO_CELL) {
+            bandOrder[positions[rowBands[grid.CellY(targets[i])]]++] = i;
+        }
+    }
+}
+
+void Arena::ResolveBand(uint32_t band) {
+    uint32_t begin = bandStarts[band];
+    uint32_t end = bandStarts[band + 1];
+
+    // Collisions avec ce qui occupe la case, puis prétendants encore en lice
+    for (uint32_t k = begin; k < end; k++) {
+        uint32_t snake = bandOrder[k];
+        Cell cell = targets[snake];
+        if (occupancy[cell] == OBSTACLE) {
+            outcomes[snake] = ArenaOutcome::HitObstacle;
+            continue;
+        }
+        if (IsBlocked(cell)) {
+            outcomes[snake] = ArenaOutcome::HitSnake;
+            continue;
+        }
+        uint32_t length = min(snakes[snake].body.Length(), CLAIM_MAX_LENGTH);
+        uint32_t claim = claims[cell];
+        uint32_t claimLength = claim >> CLAIM_LENGTH_SHIFT;
+        if (claim == 0 || length > claimLength) {
+            claims[cell] = length << CLAIM_LENGTH_SHIFT | snake;
+        }
+        else if (length == claimLength) {
+            claims[cell] = claim | CLAIM_TIE;
+        }
+    }
+
+    // Seul le prétendant le plus long, sans égal, prend la case (et sa nourriture)
+    for (uint32_t k = begin; k < end; k++) {
+        uint32_t snake = bandOrder[k];
+        if (outcomes[snake] != ArenaOutcome::Moved) {
+            continue;
+        }
+        Cell cell = targets[snake];
+        uint32_t claim = claims[cell];
+        if ((claim & CLAIM_TIE) != 0 || (claim & CLAIM_SNAKE) != snake) {
+            outcomes[snake] = ArenaOutcome::HeadOn;
+        }
+        else if ((occupancy[cell] & FRUIT) != 0) {
+            outcomes[snake] = ArenaOutcome::AteFruit;
+        }
+    }
+
+    for (uint32_t k = begin; k < end; k++) {
+        claims[targets[bandOrder[k]]] = 0;
+    }
+}
+
+void Arena::ReleaseRange(uint32_t chunk) {
+    uint32_t begin = chunk * CHUNK_SIZE;
+    uint32_t end = min(begin + CHUNK_SIZE, SnakeCount());
+    for (uint32_t i = begin; i < end; i++) {
+        if (outcomes[i] == ArenaOutcome::Idle) {
+            continue;
+        }
+        ArenaSnake& snake = snakes[i];
+        if (snake.shouldGrow) {
+            snake.shouldGrow = false;
+        }
+        else {
+            Cell tail = snake.body.PopTail();
+            occupancy[tail] = EMPTY;
+            releasedTails[i] = tail;
+        }
+    }
+}
+
+void Arena::AdvanceRange(uint32_t chunk) {
+    uint32_t begin = chunk * CHUNK_SIZE;
+    uint32_t end = min(begin + CHUNK_SIZE, SnakeCount());
+    for (uint32_t i = begin; i < end; i++) {
+        ArenaOutcome outcome = outcomes[i];
+        if (outcome != ArenaOutcome::Moved && outcome != ArenaOutcome::AteFruit) {
+            continue;
+        }
+        ArenaSnake& snake = snakes[i];
+        Cell cell = targets[i];
+        if (outcome == ArenaOutcome::AteFruit) {
+            eatenFruits[i] = occupancy[cell] & ~FRUIT;
+            snake.shouldGrow = true;
+            snake.score++;
+        }
+        if (snake.body.Length() == snake.body.Capacity()) {
+            snake.body.Grow(2 * snake.body.Capacity());
+        }
+        snake.body.PushHead(cell);
+        occupancy[cell] = i + 1;
+        leavingTails[i] = snake.shouldGrow ? NO_CELL : snake.body.Tail();
+    }
+}
+
+void Arena::Finish() {
+    // Parcours dans l'ordre des numéros : nourritures et réapparitions tirées dans le même ordre à chaque exécution
+    uint32_t snakeCount = SnakeCount();
+    for (uint32_t i = 0; i < snakeCount; i++) {
+        ArenaOutcome outcome = outcomes[i];
+        if (releasedTails[i] != NO_CELL) {
+            MarkChanged(releasedTails[i]);
+        }
+        if (outcome == ArenaOutcome::Moved) {
+            MarkChanged(targets[i]);
+        }
+        else if (outcome == ArenaOutcome::AteFruit) {
+            MarkChanged(targets[i]);
+            fruits[eatenFruits[i]] = NO_CELL;
+            missingFruits.push_back(eatenFruits[i]);
+        }
+        else if (IsDeath(outcome)) {
+            ArenaSnake& snake = snakes[i];
+            snake.body.ForEach([this](Cell cell) {
+                occupancy[cell] = EMPTY;
+                MarkChanged(cell);
+            });
+            snake.body.Clear();
+            snake.alive = false;
+            snake.deaths++;
+        }
+    }
+
+    uint32_t missingCount = (uint32_t)missingFruits.size();
+    uint32_t kept = 0;
+    for (uint32_t k = 0; k < missingCount; k++) {
+        uint32_t slot = missingFruits[k];
+        Cell cell = FruitCell();
+        if (cell == NO_CELL) {
+            missingFruits[kept++] = slot;
+            continue;
+        }
+        occupancy[cell] = FRUIT | slot;
+        fruits[slot] = cell;
+        MarkChanged(cell);
+    }
+    missingFruits.resize(kept);
+
+    for (uint32_t i = 0; i < snakeCount; i++) {
+        if (!snakes[i].alive) {
+            Spawn(i);
+        }
+    }
+}
+
+SimAction Arena::DecideBot(ArenaSnake& snake) {
+    // Nouvelle cible si la nourriture visée a été mangée
+    if (snake.target == NO_CELL || occupancy[snake.target] == OBSTACLE || (occupancy[snake.target] & FRUIT) == 0) {
+        snake.target = fruits.empty() ? NO_CELL : fruits[RandomBelow(snake.rng, (uint32_t)fruits.size())];
+    }
+
+    // Case libre la plus proche de la cible, départagée au hasard.
+    // Coordonnées calculées une fois : pas de division par case examinée.
+    Cell head = snake.body.Head();
+    int headX = grid.CellX(head);
+    int headY = grid.CellY(head);
+    int targetX = snake.target != NO_CELL ? grid.CellX(snake.target) : 0;
+    int targetY = snake.target != NO_CELL ? grid.CellY(snake.target) : 0;
+    SimAction best = SimAction::None;
+    uint32_t bestDistance = 0xFFFFFFFF;
+    uint32_t first = RandomBelow(snake.rng, 4);
+    for (uint32_t k = 0; k < 4; k++) {
+        uint32_t move = (first + k) & 3;
+        int dx = MOVES[move][0];
+        int dy = MOVES[move][1];
+        if (dx == -snake.dirX && dy == -snake.dirY) {
+            continue;
+        }
+        int x = headX + dx;
+        int y = headY + dy;
+        if (x < 0) { x = grid.width - 1; } else if (x >= grid.width) { x = 0; }
+        if (y < 0) { y = grid.height - 1; } else if (y >= grid.height) { y = 0; }
+        if (IsBlocked(grid.MakeCell(x, y))) {
+            continue;
+        }
+        uint32_t distance = 0;
+        if (snake.target != NO_CELL) {
+            int distanceX = abs(x - targetX);
+            int distanceY = abs(y - targetY);
+            distance = (uint32_t)(min(distanceX, grid.width - distanceX) + min(distanceY, grid.height - distanceY));
+        }
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = (SimAction)((int)SimAction::Up + move);
+        }
+    }
+    return best;
+}
+
+bool Arena::IsBlocked(Cell cell) const {
+    uint32_t occupant = occupancy[cell];
+    if (occupant == EMPTY) {
+        return false;
+    }
+    if (occupant == OBSTACLE) {
+        return true;
+    }
+    if ((occupant & FRUIT) != 0) {
+        return false;
+    }
+    // La queue d'un serpent qui ne grandit pas quitte sa case pendant ce pas
+    // (tableau à part : pas besoin de lire le corps du serpent)
+    return leavingTails[occupant - 1] != cell;
+}
+
+Cell Arena::Neighbour(Cell cell, int dx, int dy) const {
+    int x = grid.CellX(cell) + dx;
+    int y = grid.CellY(cell) + dy;
+    if (x < 0) { x = grid.width - 1; } else if (x >= grid.width) { x = 0; }
+    if (y < 0) { y = grid.height - 1; } else if (y >= grid.height) { y = 0; }
+    return grid.MakeCell(x, y);
+}
+
+Cell Arena::RandomEmptyCell(uint64_t& random) const {
+    // L'arène reste peu remplie : quelques tirages suffisent en pratique
+    for (uint32_t attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+        Cell cell = RandomBelow(random, grid.CellCount());
+        if (occupancy[cell] == EMPTY) {
+            return cell;
+        }
+    }
+    return NO_CELL;
+}
+
+bool Arena::Spawn(uint32_t index) {
+    ArenaSnake& snake = snakes[index];
+    // Point de départ du niveau d'abord, s'il est libre
+    if (level != nullptr) {
+        const LevelSpawn& spawn = level->Spawn(index % level->SpawnCount());
+        if (Place(index, grid.MakeCell(spawn.x, spawn.y), MOVES[spawn.direction - (int)SimAction::Up])) {
+            return true;
+        }
+    }
+    for (uint32_t attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+        Cell head = RandomEmptyCell(snake.rng);
+        if (head == NO_CELL) {
+            return false;
+        }
+        if (Place(index, head, MOVES[RandomBelow(snake.rng, 4)])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  Pose un serpent si sa tête, son corps droit derrière elle et la case devant sont libres
+  parametre "index" Numéro du serpent
+  parametre "head" Case de la tête
+  parametre "move" Direction (ligne de MOVES)
+  retourne false si la place est prise
+*/
+bool Arena::Place(uint32_t index, Cell head, const int* move) {
+    ArenaSnake& snake = snakes[index];
+    Cell neck = Neighbour(head, -move[0], -move[1]);
+    Cell tail = Neighbour(neck, -move[0], -move[1]);
+    Cell ahead = Neighbour(head, move[0], move[1]);
+    if (occupancy[head] != EMPTY || occupancy[neck] != EMPTY || occupancy[tail] != EMPTY || IsBlocked(ahead)) {
+        return false;
+    }
+    snake.body.Clear();
+    for (Cell cell : { tail, neck, head }) {
+        snake.body.PushHead(cell);
+        occupancy[cell] = index + 1;
+        MarkChanged(cell);
+    }
+    leavingTails[index] = tail;
+    snake.dirX = move[0];
+    snake.dirY = move[1];
+    snake.alive = true;
+    snake.shouldGrow = false;
+    snake.score = 0;
+    snake.target = NO_CELL;
+    return true;
+}
+
+Cell Arena::FruitCell() {
+    // Table du niveau d'abord : l'entrée suivante, si elle est libre
+    if (level != nullptr && level->FruitCount() > 0) {
+        Cell cell = level->Fruit(nextFruit);
+        nextFruit = nextFruit + 1 == level->FruitCount() ? 0 : nextFruit + 1;
+        if (occupancy[cell] == EMPTY) {
+            return cell;
+        }
+    }
+    return RandomEmptyCell(rng);
+}
+
+void Arena::PlaceFruit(uint32_t slot) {
+    Cell cell = FruitCell();
+    fruits[slot] = cell;
+    if (cell == NO_CELL) {
+        missingFruits.push_back(slot);
+        return;
+    }
+    occupancy[cell] = FRUIT | slot;
+    MarkChanged(cell);
+}
+
+void Arena::MarkChanged(Cell cell) {
+    if (trackChanges) {
+        changedCells.push_back(cell);
+    }
+}
+
+CellContent Arena::ClassifyCell(Cell cell) const {
+    uint32_t occupant = occupancy[cell];
+    if (occupant == EMPTY) {
+        return CellContent::Empty;
+    }
+    if (occupant == OBSTACLE) {
+        return CellContent::Obstacle;
+    }
+    return (occupant & FRUIT) != 0 ? CellContent::Fruit : CellContent::Snake;
+}
+
+SimAction Arena::Direction(uint32_t index) const {
+    const ArenaSnake& snake = snakes[index];
+    if (snake.dirX < 0) { return SimAction::Left; }
+    if (snake.dirX > 0) { return SimAction::Right; }
+    return snake.dirY < 0 ? SimAction::Up : SimAction::Down;
+}
+
+uint64_t Arena::Checksum() const {
+    // FNV-1a sur des mots de 64 bits
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 0x100000001B3ull; };
+    mix(tick);
+    for (const ArenaSnake& snake : snakes) {
+        mix(snake.alive ? snake.body.Head() : NO_CELL);
+        mix(snake.body.Length());
+        mix((uint64_t)(uint32_t)snake.score << 32 | snake.deaths);
+    }
+    for (Cell fruit : fruits) {
+        mix(fruit);
+    }
+    return hash;
+}
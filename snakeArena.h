@@ -0,0 +1,190 @@
+﻿// Arène : des centaines à des milliers de serpents sur une grande grille (sans dépendance à SFML)
+//
+// Tous les serpents avancent en même temps à chaque pas. Une grille
+// d'occupation partagée donne pour chaque case son occupant (serpent,
+// nourriture ou obstacle). Un pas se fait en phases parallèles :
+//   1. chaque serpent choisit sa direction (joueur ou robot) et sa case
+//      d'arrivée, lues sur la grille sans la modifier ;
+//   2. les serpents sont rangés par bande de lignes de leur case d'arrivée ;
+//      chaque bande est arbitrée par un seul fil, sans verrou : tous les
+//      prétendants à une même case sont dans la même bande ;
+//   3. les queues libèrent leur case, puis les têtes prennent la leur.
+// Les règles d'arbitrage ne dépendent pas de l'ordre de traitement : le
+// résultat est le même quel que soit le nombre de fils.
+//
+// Règles : une tête qui arrive sur un obstacle ou sur le corps d'un serpent
+// (le sien compris) meurt ; la queue d'un serpent qui ne grandit pas quitte
+// sa case pendant le pas. Plusieurs têtes sur la même case : le plus long
+// serpent gagne la case (et la nourriture), à longueur égale tous meurent.
+// Un serpent mort libère ses cases et réapparaît aussitôt ailleurs.
+//
+// Avec un niveau, ses murs sont des obstacles de la grille d'occupation,
+// posés au départ bloc par bloc sur les fils ; les serpents apparaissent
+// d'abord sur ses points de départ et la nourriture sur sa table.
+
+#pragma once
+
+#include "snakeLevel.h"
+#include "snakeSim.h"
+#include "snakeWorkers.h"
+
+#include <cstdint>
+#include <vector>
+
+const uint32_t ARENA_MAX_SNAKES = 0xFFFF;  // Numéro de serpent sur 16 bits dans l'arbitrage
+const uint32_t ARENA_START_LENGTH = 3;     // Longueur d'un serpent à son apparition
+
+/*
+  Résultat du dernier pas pour un serpent
+*/
+enum class ArenaOutcome : uint8_t {
+    Idle,         // Serpent en attente d'une place pour réapparaître
+    Moved,        // Le serpent a avancé
+    AteFruit,     // Le serpent a mangé une nourriture
+    HitSnake,     // Tête sur le corps d'un serpent : mort
+    HitObstacle,  // Tête sur un obstacle : mort
+    HeadOn        // Face-à-face perdu (ou à égalité) : mort
+};
+
+/*
+  retourne true si le résultat est une mort
+*/
+inline bool IsDeath(ArenaOutcome outcome) {
+    return outcome == ArenaOutcome::HitSnake || outcome == ArenaOutcome::HitObstacle || outcome == ArenaOutcome::HeadOn;
+}
+
+/*
+  Un serpent de l'arène
+*/
+struct ArenaSnake {
+    SnakeBody body;                // Corps (tampon agrandi au besoin)
+    int dirX = 1;                  // Direction du mouvement
+    int dirY = 0;
+    bool alive = false;            // Le serpent est sur la grille
+    bool shouldGrow = false;       // Le serpent doit grandir au prochain mouvement
+    bool bot = true;               // Dirigé par le robot plutôt que par SetAction
+    int score = 0;                 // Nourritures mangées depuis l'apparition
+    uint32_t deaths = 0;           // Morts depuis le début
+    uint64_t rng = 0;              // Générateur propre au serpent (décisions, apparitions)
+    Cell target = NO_CELL;         // Nourriture visée par le robot
+};
+
+/*
+  Arène de nombreux serpents avancés ensemble par un groupe de fils
+*/
+class Arena {
+public:
+    /*
+      Crée l'arène, place les obstacles, les serpents et la nourriture, et lance les fils
+      parametre "grid" Dimensions de la grille (ignorées avec un niveau)
+      parametre "snakeCount" Nombre de serpents (au plus ARENA_MAX_SNAKES)
+      parametre "fruitCount" Nombre de nourritures présentes en permanence
+      parametre "obstacleCount" Nombre d'obstacles (fixes), en plus des murs du niveau
+      parametre "seed" Graine commune ; chaque serpent a son propre flux
+      parametre "threadCount" Nombre de fils (0 : un par cœur)
+      parametre "level" Niveau (murs, départs, nourriture), nullptr : grille vide
+    */
+    void Init(const GridShape& grid, uint32_t snakeCount, uint32_t fruitCount, uint32_t obstacleCount,
+              uint64_t seed, uint32_t threadCount = 0, const Level* level = nullptr);
+
+    /*
+      Confie un serpent au robot, ou le rend aux actions données par SetAction
+    */
+    void SetBot(uint32_t snake, bool bot) { snakes[snake].bot = bot; }
+
+    /*
+      Donne l'action d'un serpent qui n'est pas un robot, pour le prochain pas seulement
+    */
+    void SetAction(uint32_t snake, SimAction action) { actions[snake] = action; }
+
+    /*
+      Fait avancer tous les serpents d'un pas
+    */
+    void Step();
+
+    /*
+      Donne le contenu d'une case
+    */
+    CellContent ClassifyCell(Cell cell) const;
+
+    /*
+      retourne La direction d'un serpent sous forme d'action
+    */
+    SimAction Direction(uint32_t snake) const;
+
+    /*
+      Empreinte de l'état (têtes, longueurs, scores, nourritures) pour comparer deux exécutions
+    */
+    uint64_t Checksum() const;
+
+    const GridShape& Grid() const { return grid; }
+    uint32_t SnakeCount() const { return (uint32_t)snakes.size(); }
+    const ArenaSnake& Snake(uint32_t snake) const { return snakes[snake]; }
+    ArenaOutcome Outcome(uint32_t snake) const { return outcomes[snake]; }
+    const std::vector<Cell>& Fruits() const { return fruits; }
+    const std::vector<Cell>& Obstacles() const { return obstacles; }
+    uint64_t Tick() const { return tick; }
+    uint32_t ThreadCount() const { return pool.ThreadCount(); }
+
+    // Journal des cases modifiées, comme SimState::changedCells
+    bool trackChanges = false;
+    std::vector<Cell> changedCells;
+
+private:
+    // Serpents traités d'un bloc par un fil
+    static const uint32_t CHUNK_SIZE = 128;
+    // Bandes de lignes par fil pour l'arbitrage (équilibre les bandes chargées)
+    static const uint32_t BANDS_PER_THREAD = 4;
+
+    // Occupant d'une case : 0 vide, 1 + numéro de serpent, obstacle, ou nourriture | numéro de nourriture
+    static const uint32_t EMPTY = 0;
+    static const uint32_t OBSTACLE = 0xFFFFFFFF;
+    static const uint32_t FRUIT = 0x80000000;
+
+    void DecideRange(uint32_t chunk);
+    void SortRange(uint32_t chunk);
+    void ResolveBand(uint32_t band);
+    void ReleaseRange(uint32_t chunk);
+    void AdvanceRange(uint32_t chunk);
+    void Finish();
+
+    SimAction DecideBot(ArenaSnake& snake);
+    bool IsBlocked(Cell cell) const;
+    Cell Neighbour(Cell cell, int dx, int dy) const;
+    Cell RandomEmptyCell(uint64_t& random) const;
+    bool Spawn(uint32_t snake);
+    bool Place(uint32_t snake, Cell head, const int* move);
+    Cell FruitCell();
+    void PlaceFruit(uint32_t slot);
+    void MarkChanged(Cell cell);
+
+    GridShape grid;
+    std::vector<ArenaSnake> snakes;
+    std::vector<uint32_t> occupancy;      // Occupant de chaque case
+    std::vector<Cell> fruits;             // Case de chaque nourriture (NO_CELL : à replacer)
+    std::vector<uint32_t> missingFruits;  // Nourritures sans place, replacées au pas suivant
+    std::vector<Cell> obstacles;          // Obstacles tirés au hasard (sans les murs du niveau)
+    const Level* level = nullptr;
+    uint32_t nextFruit = 0;               // Prochaine entrée de la table de nourriture du niveau
+    uint64_t rng = 0;                     // Générateur de l'arène (nourriture, obstacles)
+    uint64_t tick = 0;
+
+    // Données d'un pas, une case par serpent
+    std::vector<SimAction> actions;       // Actions données par SetAction
+    std::vector<Cell> targets;            // Case d'arrivée de la tête (NO_CELL si en attente)
+    std::vector<Cell> releasedTails;      // Case libérée par la queue (NO_CELL si le serpent grandit)
+    std::vector<uint32_t> eatenFruits;    // Nourriture mangée
+    std::vector<Cell> leavingTails;       // Queue qui quittera sa case au prochain pas (NO_CELL si le serpent grandit)
+    std::vector<ArenaOutcome> outcomes;
+
+    // Partition par bandes de lignes
+    uint32_t chunkCount = 0;
+    uint32_t bandCount = 0;
+    std::vector<uint32_t> rowBands;       // Bande de chaque ligne
+    std::vector<uint32_t> chunkBands;     // Serpents de chaque bloc par bande, puis position d'écriture
+    std::vector<uint32_t> bandStarts;     // Début de chaque bande dans "bandOrder"
+    std::vector<uint32_t> bandOrder;      // Serpents rangés par bande (puis par numéro)
+    std::vector<uint32_t> claims;         // Prétendant le plus long de chaque case (0 : aucun)
+
+    WorkerPool pool;
+};
@@ -0,0 +1,150 @@
+﻿#include "snakeAssets.h"
+
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+using namespace std;
+
+// Manifeste : chemin de chaque image, dans l'ordre de AssetId
+static const char* ASSET_PATHS[(uint32_t)AssetId::Count] = {
+    "./Sprites/snake/corps.png",
+    "./Sprites/fruites/Strawberry.png",
+    "./Sprites/obstacle/obstacle.png",
+    "./Sprites/background/Grass.png",
+    "./Sprites/background/Green.png",
+    "./Sprites/background/Blue.png",
+    "./Sprites/background/Brown.png",
+    "./Sprites/background/Gray.png",
+    "./Sprites/background/Pink.png",
+    "./Sprites/background/Purple.png",
+    "./Sprites/background/Yellow.png"
+};
+
+/*
+  retourne true si les deux noms sont égaux sans tenir compte de la casse (ASCII)
+*/
+static bool EqualsIgnoreCase(const string& a, const string& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+string ResolveAssetPath(const string& path) {
+    error_code error;
+    if (filesystem::exists(path, error)) {
+        return path;
+    }
+    // Élément par élément : le nom exact d'abord, sinon le premier nom égal à la casse près
+    filesystem::path requested(path);
+    filesystem::path current = requested.root_path();
+    for (const filesystem::path& part : requested.relative_path()) {
+        filesystem::path exact = current / part;
+        if (filesystem::exists(exact, error)) {
+            current = exact;
+            continue;
+        }
+        bool found = false;
+        for (const filesystem::directory_entry& entry : filesystem::directory_iterator(current.empty() ? "." : current, error)) {
+            if (EqualsIgnoreCase(entry.path().filename().string(), part.string())) {
+                current = entry.path();
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return "";
+        }
+    }
+    return current.string();
+}
+
+const char* AssetLoader::Path(AssetId asset) {
+    return ASSET_PATHS[(uint32_t)asset];
+}
+
+void AssetLoader::Start(uint32_t threadCount) {
+    Wait();
+    startTime = chrono::steady_clock::now();
+    pool.Init(threadCount);
+    threadsUsed = pool.ThreadCount();
+    thread = std::thread([this] {
+        auto task = [this](uint32_t asset) { Decode(asset); };
+        pool.Run(COUNT, task);
+        pool.Shutdown();
+    });
+}
+
+void AssetLoader::Wait() {
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void AssetLoader::Decode(uint32_t asset) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    resolved[asset] = ResolveAssetPath(ASSET_PATHS[asset]);
+    loaded[asset] = !resolved[asset].empty() && images[asset].loadFromFile(resolved[asset]);
+    decodeMs[asset] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    decoded[asset].store(true, memory_order_release);
+}
+
+bool AssetLoader::Poll() {
+    if (IsComplete()) {
+        return false;
+    }
+    bool changed = false;
+    for (uint32_t asset = 0; asset < COUNT; asset++) {
+        if (uploaded[asset] || !decoded[asset].load(memory_order_acquire)) {
+            continue;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (loaded[asset]) {
+            loaded[asset] = textures[asset].loadFromImage(images[asset]);
+        }
+        if (!loaded[asset]) {
+            std::cout << "Error loading texture " << ASSET_PATHS[asset] << std::endl;
+        }
+        uploadMs[asset] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        uploaded[asset] = true;
+        uploadedCount++;
+        changed |= loaded[asset];
+    }
+    if (IsComplete()) {
+        completeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+        Wait();
+    }
+    return changed;
+}
+
+const sf::Image* AssetLoader::Image(AssetId asset) const {
+    uint32_t index = (uint32_t)asset;
+    return uploaded[index] && loaded[index] ? &images[index] : nullptr;
+}
+
+sf::Texture* AssetLoader::Texture(AssetId asset) {
+    uint32_t index = (uint32_t)asset;
+    return uploaded[index] && loaded[index] ? &textures[index] : nullptr;
+}
+
+string AssetLoader::Report() const {
+    string report;
+    char line[256];
+    uint32_t loadedCount = 0;
+    for (uint32_t asset = 0; asset < COUNT; asset++) {
+        loadedCount += loaded[asset] ? 1 : 0;
+        snprintf(line, sizeof(line), "  %s: decode %.2f ms, upload %.2f ms%s\n",
+                 resolved[asset].empty() ? ASSET_PATHS[asset] : resolved[asset].c_str(), decodeMs[asset], uploadMs[asset],
+                 loaded[asset] ? "" : " (missing)");
+        report += line;
+    }
+    snprintf(line, sizeof(line), "Assets: %u/%u images ready after %.1f ms on %u threads\n", loadedCount, COUNT, completeMs,
+             threadsUsed);
+    return line + report;
+}
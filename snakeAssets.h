@@ -0,0 +1,123 @@
+﻿// SFML VERSION 3.0
+//
+// Images du jeu, chargées au démarrage sans retarder la première image.
+//
+// Le manifeste (snakeAssets.cpp) donne le chemin de chaque image sous
+// Sprites/. Les chemins sont résolus sans tenir compte de la casse : un
+// manifeste écrit sous Windows ("sprites/...") trouve aussi les fichiers sur
+// un système de fichiers qui distingue les majuscules. Les images sont
+// décodées en parallèle sur un groupe de fils ; le fil d'affichage n'envoie à
+// la carte graphique que celles qui sont prêtes (Poll), une fois par image,
+// et dessine en attendant avec les couleurs de secours.
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "snakeWorkers.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/*
+  Images du manifeste
+*/
+enum class AssetId : uint32_t {
+    SnakeTile,
+    FruitTile,
+    ObstacleTile,
+    BackgroundGrass,
+    BackgroundGreen,
+    BackgroundBlue,
+    BackgroundBrown,
+    BackgroundGray,
+    BackgroundPink,
+    BackgroundPurple,
+    BackgroundYellow,
+    Count
+};
+
+/*
+  Cherche un fichier sans tenir compte de la casse de chaque élément du chemin
+  parametre "path" Chemin relatif ou absolu
+  retourne Le chemin tel qu'il existe sur le disque, ou une chaîne vide s'il n'existe pas
+*/
+std::string ResolveAssetPath(const std::string& path);
+
+/*
+  Décodage en parallèle des images du manifeste et envoi à la carte graphique
+*/
+class AssetLoader {
+public:
+    ~AssetLoader() { Wait(); }
+
+    /*
+      Lance le décodage de toutes les images, sans attendre
+      parametre "threadCount" Nombre de fils (0 : un par cœur)
+    */
+    void Start(uint32_t threadCount = 0);
+
+    /*
+      Attend la fin du décodage (rendu hors écran : images identiques d'une exécution à l'autre)
+    */
+    void Wait();
+
+    /*
+      Envoie à la carte graphique les images décodées depuis le dernier appel.
+      À appeler sur le fil d'affichage (contexte OpenGL).
+      retourne true si au moins une texture est devenue disponible
+    */
+    bool Poll();
+
+    /*
+      retourne true quand toutes les images sont décodées et envoyées (ou en échec)
+    */
+    bool IsComplete() const { return uploadedCount == (uint32_t)AssetId::Count; }
+
+    /*
+      retourne L'image décodée, ou nullptr si elle n'est pas encore envoyée ou n'a pas pu être lue
+    */
+    const sf::Image* Image(AssetId asset) const;
+
+    /*
+      retourne La texture, ou nullptr si elle n'est pas encore envoyée ou n'a pas pu être lue
+    */
+    sf::Texture* Texture(AssetId asset);
+
+    /*
+      retourne Le chemin d'une image du manifeste (tel qu'écrit dans le manifeste)
+    */
+    static const char* Path(AssetId asset);
+
+    /*
+      retourne Le temps de chaque image (décodage, envoi) et du chargement complet, une ligne par image
+    */
+    std::string Report() const;
+
+private:
+    static const uint32_t COUNT = (uint32_t)AssetId::Count;
+
+    /*
+      Décode une image (sur un fil du groupe)
+    */
+    void Decode(uint32_t asset);
+
+    sf::Image images[COUNT];
+    sf::Texture textures[COUNT];
+    std::atomic<bool> decoded[COUNT] = {};  // Image décodée (ou en échec), publiée par le fil qui l'a lue
+    bool loaded[COUNT] = {};                // L'image a pu être lue (valable une fois "decoded" vu)
+    bool uploaded[COUNT] = {};              // Texture envoyée (fil d'affichage)
+    uint32_t uploadedCount = 0;
+    std::string resolved[COUNT];            // Chemin trouvé sur le disque
+    double decodeMs[COUNT] = {};
+    double uploadMs[COUNT] = {};
+    std::chrono::steady_clock::time_point startTime;
+    double completeMs = 0;                  // Temps écoulé depuis Start quand tout a été envoyé
+    uint32_t threadsUsed = 0;               // Fils de décodage, appelant compris
+
+    WorkerPool pool;
+    std::thread thread;                     // Lance le groupe sans bloquer l'appelant
+};
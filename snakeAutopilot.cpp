@@ -0,0 +1,402 @@
+﻿#include "snakeAutopilot.h"
+
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+// Directions essayées, dans l'ordre des actions
+static const SimAction MOVES[4] = { SimAction::Up, SimAction::Down, SimAction::Left, SimAction::Right };
+static const int MOVE_X[4] = { 0, 0, -1, 1 };
+static const int MOVE_Y[4] = { -1, 1, 0, 0 };
+
+// Place gardée devant la queue en plus du strict nécessaire pour prendre un raccourci
+static const uint32_t SHORTCUT_MARGIN = 2;
+
+// Pas d'avance exigés sur la queue pour suivre le corps (ReachableSpace) : une
+// nourriture mangée en chemin retarde la queue d'un pas
+static const uint32_t TAIL_MARGIN = 1;
+
+/*
+  retourne La case voisine dans une direction, en traversant les bords
+*/
+static Cell Neighbor(const GridShape& grid, Cell cell, int dx, int dy) {
+    int x = grid.CellX(cell) + dx;
+    int y = grid.CellY(cell) + dy;
+    if (x < 0) { x = grid.width - 1; } else if (x >= grid.width) { x = 0; }
+    if (y < 0) { y = grid.height - 1; } else if (y >= grid.height) { y = 0; }
+    return grid.MakeCell(x, y);
+}
+
+void DistanceField::Init(const GridShape& shape) {
+    grid = shape;
+    distances.assign(grid.CellCount(), 0);
+    marks.assign(grid.CellCount(), 0);
+    queue.assign(grid.CellCount(), 0);
+    queueHead = 0;
+    queueTail = 0;
+    generation = 0;
+}
+
+void DistanceField::Reset(Cell origin) {
+    if (++generation == 0) {
+        fill(marks.begin(), marks.end(), 0);
+        generation = 1;
+    }
+    queueHead = 0;
+    queueTail = 0;
+    if (origin != NO_CELL) {
+        marks[origin] = generation;
+        distances[origin] = 0;
+        queue[queueTail++] = origin;
+    }
+}
+
+uint32_t DistanceField::Distance(Cell cell, const Bitboard& walls) {
+    // Les cases sont atteintes par distance croissante : la première visite est la bonne
+    while (marks[cell] != generation && queueHead < queueTail) {
+        Cell current = queue[queueHead++];
+        uint32_t next = distances[current] + 1;
+        for (int move = 0; move < 4; move++) {
+            Cell neighbor = Neighbor(grid, current, MOVE_X[move], MOVE_Y[move]);
+            if (marks[neighbor] != generation && !walls.Test(neighbor)) {
+                marks[neighbor] = generation;
+                distances[neighbor] = next;
+                queue[queueTail++] = neighbor;
+            }
+        }
+    }
+    return marks[cell] == generation ? distances[cell] : UNREACHABLE;
+}
+
+void Autopilot::Init(const GridShape& shape) {
+    grid = shape;
+    cellCount = grid.CellCount();
+    cycleCells.clear();
+    cycleCells.reserve(cellCount);
+
+    // Lignes en zigzag sur les colonnes 1 à W-1, retour par la colonne 0.
+    // Avec un nombre impair de lignes, la ligne 0 est parcourue en entier
+    // et le retour passe par le bord droit (la grille est un tore).
+    int width = grid.width;
+    int height = grid.height;
+    int firstRow = 0;
+    if (height % 2 == 1) {
+        for (int x = 0; x < width; x++) {
+            cycleCells.push_back(grid.MakeCell(x, 0));
+        }
+        firstRow = 1;
+    }
+    for (int y = firstRow; y < height; y++) {
+        bool rightward = (y - firstRow) % 2 == 0;
+        if (firstRow == 1) {
+            rightward = !rightward;
+        }
+        for (int i = 1; i < width; i++) {
+            cycleCells.push_back(grid.MakeCell(rightward ? i : width - i, y));
+        }
+    }
+    for (int y = height - 1; y >= firstRow; y--) {
+        cycleCells.push_back(grid.MakeCell(0, y));
+    }
+
+    cycleIndex.assign(cellCount, 0);
+    for (uint32_t i = 0; i < cellCount; i++) {
+        cycleIndex[cycleCells[i]] = i;
+    }
+    fruitDistance.Init(grid);
+    fieldFruit = NO_CELL;
+    fieldObstacles.clear();
+    visitMarks.assign(cellCount, 0);
+    visitQueue.assign(cellCount, 0);
+    visitGeneration = 0;
+    enteredTick.assign(cellCount, 0);
+    lastHead = NO_CELL;
+    pathDepth.assign(cellCount, 0);
+    pathFirstMove.assign(cellCount, 0);
+    ordered = false;
+}
+
+bool Autopilot::BodyFollowsCycle(const SimState& state) const {
+    // De la queue vers la tête : chaque segment doit être plus loin sur le cycle que le précédent
+    uint64_t span = 0;
+    bool repeated = false;
+    Cell previous = NO_CELL;
+    state.body.ForEachFromTail([&](Cell cell) {
+        if (previous != NO_CELL) {
+            uint32_t step = CycleDistance(previous, cell);
+            repeated |= step == 0;
+            span += step;
+        }
+        previous = cell;
+    });
+    return !repeated && span < cellCount;
+}
+
+void Autopilot::TrackBody(const SimState& state) {
+    Cell head = state.body.Head();
+    if (state.tick == lastTick && head == lastHead) {
+        return;
+    }
+    // Un pas de plus : seule la nouvelle tête change ; sinon, chaque segment est daté
+    if (state.tick == lastTick + 1 && state.body.Length() > 1 && state.body.At(1) == lastHead) {
+        enteredTick[head] = (uint32_t)state.tick;
+    }
+    else {
+        uint32_t entered = (uint32_t)state.tick;
+        state.body.ForEach([&](Cell cell) { enteredTick[cell] = entered--; });
+    }
+    lastHead = head;
+}
+
+uint32_t Autopilot::ReachableSpace(const SimState& state, Cell next, uint32_t limit) {
+    uint32_t growth = next == state.fruitPosition ? 1 : 0;
+    if (++visitGeneration == 0) {
+        fill(visitMarks.begin(), visitMarks.end(), 0);
+        visitGeneration = 1;
+    }
+    uint32_t head = 0;
+    uint32_t count = 0;
+    visitMarks[state.body.Head()] = visitGeneration;
+    visitMarks[next] = visitGeneration;
+    visitQueue[count] = next;
+    pathDepth[count] = 1;
+    count++;
+    while (head < count && count < limit) {
+        uint32_t slot = head++;
+        Cell current = visitQueue[slot];
+        uint32_t depth = pathDepth[slot] + 1;
+        for (int move = 0; move < 4; move++) {
+            Cell neighbor = Neighbor(grid, current, MOVE_X[move], MOVE_Y[move]);
+            if (visitMarks[neighbor] == visitGeneration || state.obstacleCells.Test(neighbor)) {
+                continue;
+            }
+            if (state.blockedCells.Test(neighbor)) {
+                if (depth < FreeTime(state, neighbor) + growth + TAIL_MARGIN) {
+                    continue;
+                }
+                // Case libérée à l'arrivée : les segments plus près de la tête se libèrent
+                // ensuite un par pas, la tête peut les suivre jusqu'à sa propre trace
+                return limit;
+            }
+            visitMarks[neighbor] = visitGeneration;
+            visitQueue[count] = neighbor;
+            pathDepth[count] = depth;
+            count++;
+        }
+    }
+    return min(count, limit);
+}
+
+int Autopilot::FindPathMove(const SimState& state, const Cell* cells, int candidateCount) {
+    if (++visitGeneration == 0) {
+        fill(visitMarks.begin(), visitMarks.end(), 0);
+        visitGeneration = 1;
+    }
+    visitMarks[state.body.Head()] = visitGeneration;
+    uint32_t head = 0;
+    uint32_t count = 0;
+    for (int i = 0; i < candidateCount; i++) {
+        if (visitMarks[cells[i]] != visitGeneration) {
+            visitMarks[cells[i]] = visitGeneration;
+            visitQueue[count] = cells[i];
+            pathDepth[count] = 1;
+            pathFirstMove[count] = (uint8_t)i;
+            count++;
+        }
+    }
+    while (head < count) {
+        uint32_t slot = head++;
+        Cell current = visitQueue[slot];
+        if (current == state.fruitPosition) {
+            return pathFirstMove[slot];
+        }
+        uint32_t depth = pathDepth[slot] + 1;
+        for (int move = 0; move < 4; move++) {
+            Cell neighbor = Neighbor(grid, current, MOVE_X[move], MOVE_Y[move]);
+            if (visitMarks[neighbor] == visitGeneration || state.obstacleCells.Test(neighbor) ||
+                (state.blockedCells.Test(neighbor) && depth < FreeTime(state, neighbor))) {
+                continue;
+            }
+            visitMarks[neighbor] = visitGeneration;
+            visitQueue[count] = neighbor;
+            pathDepth[count] = depth;
+            pathFirstMove[count] = pathFirstMove[slot];
+            count++;
+        }
+    }
+    return -1;
+}
+
+SimAction Autopilot::Decide(const SimState& state) {
+    if (state.gameOver) {
+        return SimAction::None;
+    }
+    auto start = chrono::steady_clock::now();
+    if (state.grid != grid) {
+        Init(state.grid);
+    }
+    TrackBody(state);
+
+    // Nouvelle partie ou pas manqués : l'ordre du corps est vérifié en entier,
+    // de même qu'après un détour, une fois que la queue a dépassé les cases hors cycle
+    bool resync = state.tick != lastTick + 1;
+    if (resync || (!ordered && state.tick >= recheckTick)) {
+        ordered = BodyFollowsCycle(state);
+        recheckTick = state.tick + state.body.Length();
+    }
+    lastTick = state.tick;
+
+    if (resync || state.fruitPosition != fieldFruit || state.obstacles != fieldObstacles) {
+        fieldFruit = state.fruitPosition;
+        fieldObstacles = state.obstacles;
+        fruitDistance.Reset(fieldFruit);
+        fruitTick = state.tick;
+    }
+    uint64_t fruitAge = state.tick - fruitTick;
+
+    Cell head = state.body.Head();
+    Cell tail = state.body.Tail();
+    uint32_t length = state.body.Length();
+    bool tailMoves = !state.shouldGrow;
+    SimAction reverse = OppositeAction(CurrentDirection(state));
+    Cell cycleNext = cycleCells[cycleIndex[head] + 1 == cellCount ? 0 : cycleIndex[head] + 1];
+
+    // Cases voisines où le serpent survit au prochain pas
+    SimAction actions[4];
+    Cell cells[4];
+    int candidateCount = 0;
+    for (int move = 0; move < 4; move++) {
+        if (MOVES[move] == reverse) {
+            continue;
+        }
+        Cell cell = Neighbor(grid, head, MOVE_X[move], MOVE_Y[move]);
+        bool blocked = state.blockedCells.Test(cell) && !(cell == tail && tailMoves);
+        if (!blocked) {
+            actions[candidateCount] = MOVES[move];
+            cells[candidateCount] = cell;
+            candidateCount++;
+        }
+    }
+
+    // Plus de deux tours sans manger : l'ordre du cycle ne permet pas d'atteindre
+    // la nourriture (obstacle devant elle), on cherche un chemin sur la grille
+    int chosen = -1;
+    if (fruitAge > 2 * (uint64_t)cellCount && state.fruitPosition != NO_CELL) {
+        chosen = FindPathMove(state, cells, candidateCount);
+        if (chosen >= 0 && ReachableSpace(state, cells[chosen], length) < length) {
+            chosen = -1;
+        }
+        if (chosen >= 0) {
+            ordered = false;
+            recheckTick = state.tick + length;
+            pathMoves++;
+        }
+    }
+
+    // Serpent court devant la grille : le cycle imposerait de longs tours, on descend
+    // directement la distance à la nourriture en gardant l'accès à la queue
+    if (chosen < 0 && 2 * length < (uint32_t)max(grid.width, grid.height) && state.fruitPosition != NO_CELL) {
+        uint32_t distances[4];
+        for (int i = 0; i < candidateCount; i++) {
+            distances[i] = fruitDistance.Distance(cells[i], state.obstacleCells);
+        }
+        bool tried[4] = { false, false, false, false };
+        for (int attempt = 0; attempt < candidateCount && chosen < 0; attempt++) {
+            int best = -1;
+            for (int i = 0; i < candidateCount; i++) {
+                if (!tried[i] && (best < 0 || distances[i] < distances[best])) {
+                    best = i;
+                }
+            }
+            tried[best] = true;
+            if (distances[best] != DistanceField::UNREACHABLE && ReachableSpace(state, cells[best], length) >= length) {
+                chosen = best;
+            }
+        }
+        if (chosen >= 0) {
+            ordered = false;
+            recheckTick = state.tick + length;
+            pathMoves++;
+        }
+    }
+
+    if (chosen < 0 && ordered) {
+        // Cycle et raccourcis : la nouvelle tête doit rester devant la queue dans l'ordre du cycle
+        uint32_t gap = CycleDistance(head, tail);
+        uint32_t tailAdvance = tailMoves && length > 1 ? CycleDistance(tail, state.body.At(length - 2)) : 0;
+        uint32_t fruitAhead = state.fruitPosition != NO_CELL ? CycleDistance(head, state.fruitPosition) : cellCount;
+        bool cycleBlocked = state.obstacleCells.Test(cycleNext);
+        bool shortcutsAllowed = 2 * length < cellCount || cycleBlocked;
+        bool eligible[4] = { false, false, false, false };
+        uint32_t distances[4];
+        uint32_t advances[4];
+        for (int i = 0; i < candidateCount; i++) {
+            uint32_t advance = CycleDistance(head, cells[i]);
+            if (advance == 0 || (advance > 1 && !shortcutsAllowed)) {
+                continue;
+            }
+            // Garder la place de grandir devant la queue
+            uint32_t needed = (cells[i] == state.fruitPosition ? 2 : 1) + (advance > 1 ? SHORTCUT_MARGIN : 0);
+            if ((uint64_t)gap + tailAdvance < (uint64_t)advance + needed) {
+                continue;
+            }
+            // Dépasser la nourriture oblige à refaire un tour : seulement si rien d'autre ne reste dans l'ordre.
+            // Après un tour sans manger, le plus court chemin mène à une impasse :
+            // on avance alors au plus loin sur le cycle sans dépasser la nourriture
+            bool passesFruit = fruitAhead < gap && advance > fruitAhead;
+            uint32_t distance = DistanceField::UNREACHABLE;
+            if (!passesFruit) {
+                distance = fruitAge <= cellCount ? fruitDistance.Distance(cells[i], state.obstacleCells) : fruitAhead - advance;
+            }
+            eligible[i] = true;
+            distances[i] = distance;
+            advances[i] = advance;
+        }
+
+        // Un obstacle peut fermer le cycle devant la tête : avec des obstacles, le pas
+        // retenu doit aussi laisser assez de place pour rejoindre la queue
+        while (chosen < 0) {
+            int best = -1;
+            for (int i = 0; i < candidateCount; i++) {
+                if (eligible[i] && (best < 0 || distances[i] < distances[best] ||
+                    (distances[i] == distances[best] && advances[i] < advances[best]))) {
+                    best = i;
+                }
+            }
+            if (best < 0) {
+                break;
+            }
+            if (state.obstacles.empty() || ReachableSpace(state, cells[best], length) >= length) {
+                chosen = best;
+            }
+            eligible[best] = false;
+        }
+        if (chosen >= 0) {
+            cycleMoves++;
+        }
+        else {
+            ordered = false;
+            recheckTick = state.tick + length;
+        }
+    }
+
+    if (chosen < 0) {
+        // Détour : on garde l'accès à la queue, en revenant sur le cycle dès que possible
+        uint32_t bestSpace = 0;
+        uint32_t bestDistance = DistanceField::UNREACHABLE;
+        for (int i = 0; i < candidateCount; i++) {
+            uint32_t space = ReachableSpace(state, cells[i], length);
+            uint32_t distance = cells[i] == cycleNext ? 0 : fruitDistance.Distance(cells[i], state.obstacleCells);
+            if (chosen < 0 || space > bestSpace || (space == bestSpace && distance < bestDistance)) {
+                chosen = i;
+                bestSpace = space;
+                bestDistance = distance;
+            }
+        }
+        detourMoves++;
+    }
+
+    SimAction action = chosen >= 0 ? actions[chosen] : CurrentDirection(state);
+    decisionLatency.Add(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+    return action;
+}
@@ -0,0 +1,163 @@
+﻿// Pilote automatique (sans dépendance à SFML)
+//
+// Tant que le serpent est court devant la grille, il va droit à la nourriture.
+// Ensuite, il suit un cycle hamiltonien de la grille : tant que son corps
+// reste rangé dans l'ordre du cycle, il ne peut pas se mordre, ce qui
+// garantit de remplir la grille quand il n'y a pas d'obstacle. Il prend des
+// raccourcis vers la nourriture tant qu'ils laissent assez de place devant
+// la queue. Si un obstacle bloque le cycle, il s'en écarte en vérifiant à
+// chaque pas qu'il peut encore rejoindre sa queue, puis revient sur le cycle.
+//
+// La distance à la nourriture vient d'un parcours en largeur partant de la
+// nourriture (les obstacles sont des murs). Il n'est refait qu'à chaque
+// nouvelle nourriture, et seulement étendu jusqu'aux cases dont le pilote a
+// besoin : le coût d'une décision ne dépend pas de la taille de la grille.
+// Si un obstacle empêche d'atteindre la nourriture dans l'ordre du cycle,
+// un plus court chemin tenant compte du déplacement du corps prend le relais.
+//
+// Les cases du corps sont datées par le pas où la tête y est entrée : le temps
+// avant qu'une case se libère se lit en O(1), sans parcourir le corps à chaque pas.
+// Le contrôle de place (ReachableSpace) s'arrête dès qu'il rejoint une case du
+// corps libérée à temps, mais reste en O(place libre) dans le pire cas.
+//
+// Limite : avec des obstacles replacés à chaque nourriture (2 dans le jeu), rien ne
+// garantit de remplir la grille. Un obstacle peut tomber sur le cycle devant la tête
+// quand il ne reste presque plus de place, et les détours finissent souvent par
+// enfermer le serpent. Sur 25x25 avec 2 obstacles, les parties se terminent en
+// général entre le tiers et les neuf dixièmes de la grille.
+
+#pragma once
+
+#include "snakeSim.h"
+#include "snakeStats.h"
+
+#include <cstdint>
+#include <vector>
+
+/*
+  Parcours en largeur depuis une case, étendu à la demande.
+  Les marques de génération évitent d'effacer les tableaux entre deux parcours.
+*/
+class DistanceField {
+public:
+    static const uint32_t UNREACHABLE = 0xFFFFFFFF;
+
+    /*
+      Dimensionne les tableaux pour une grille
+    */
+    void Init(const GridShape& grid);
+
+    /*
+      Recommence le parcours depuis une nouvelle origine
+      parametre "origin" Case de départ (NO_CELL : aucune case n'est atteinte)
+    */
+    void Reset(Cell origin);
+
+    /*
+      Donne la distance d'une case à l'origine, en étendant le parcours si besoin
+      parametre "cell" La case voulue
+      parametre "walls" Cases infranchissables (les mêmes depuis Reset)
+      retourne La distance, ou UNREACHABLE
+    */
+    uint32_t Distance(Cell cell, const Bitboard& walls);
+
+private:
+    GridShape grid;
+    std::vector<uint32_t> distances;  // Valables si la marque de la case est à jour
+    std::vector<uint32_t> marks;      // Génération où la case a été atteinte
+    std::vector<Cell> queue;          // File du parcours (cases atteintes, dans l'ordre)
+    uint32_t queueHead = 0;           // Prochaine case à développer
+    uint32_t queueTail = 0;           // Fin de la file
+    uint32_t generation = 0;
+};
+
+/*
+  Décide d'une action par pas pour jouer seul
+*/
+class Autopilot {
+public:
+    /*
+      Choisit l'action du prochain pas
+      parametre "state" L'état de la partie (non modifié)
+      retourne L'action à passer à Step
+    */
+    SimAction Decide(const SimState& state);
+
+    LatencyStats decisionLatency;  // Durée de chaque décision, en microsecondes
+    uint64_t cycleMoves = 0;       // Pas choisis par la règle du cycle (raccourcis compris)
+    uint64_t pathMoves = 0;        // Pas vers la nourriture hors cycle (serpent court, nourriture bloquée)
+    uint64_t detourMoves = 0;      // Pas hors cycle pour garder l'accès à la queue
+
+private:
+    /*
+      Prépare le cycle hamiltonien et les tableaux pour une grille
+    */
+    void Init(const GridShape& shape);
+
+    /*
+      Vérifie que le corps est rangé dans l'ordre du cycle, de la queue à la tête
+    */
+    bool BodyFollowsCycle(const SimState& state) const;
+
+    /*
+      Note le pas où la tête est entrée dans sa case. Le corps entier n'est
+      reparcouru qu'après un saut (nouvelle partie, pas manqués).
+    */
+    void TrackBody(const SimState& state);
+
+    /*
+      retourne Le nombre de pas avant que la queue quitte une case du corps
+    */
+    uint32_t FreeTime(const SimState& state, Cell cell) const {
+        // Segment i (0 : tête), entré au pas "tick - i", se libère après Length() - i pas,
+        // un de plus si le serpent grandit
+        return enteredTick[cell] + state.body.Length() + (state.shouldGrow ? 1 : 0) - (uint32_t)state.tick;
+    }
+
+    /*
+      Compte les cases accessibles après un pas vers "next", en s'arrêtant à "limit".
+      Une case du corps compte si la queue l'a quittée quand la tête y arrive ; une fois
+      sur une telle case, la tête peut suivre le corps indéfiniment : "limit" est atteint.
+      retourne Le nombre de cases, au plus "limit"
+    */
+    uint32_t ReachableSpace(const SimState& state, Cell next, uint32_t limit);
+
+    /*
+      Plus court chemin de la tête à la nourriture, où une case du corps devient
+      franchissable une fois que la queue l'a quittée
+      parametre "cells" Cases voisines de la tête où le serpent survit
+      retourne L'indice dans "cells" du premier pas, ou -1 sans chemin
+    */
+    int FindPathMove(const SimState& state, const Cell* cells, int candidateCount);
+
+    /*
+      retourne La distance de "from" à "to" en suivant le cycle
+    */
+    uint32_t CycleDistance(Cell from, Cell to) const {
+        uint32_t a = cycleIndex[from];
+        uint32_t b = cycleIndex[to];
+        return b >= a ? b - a : b + cellCount - a;
+    }
+
+    GridShape grid{ 0, 0 };
+    uint32_t cellCount = 0;
+    std::vector<uint32_t> cycleIndex;     // Rang de chaque case dans le cycle
+    std::vector<Cell> cycleCells;         // Case de chaque rang
+
+    DistanceField fruitDistance;          // Distance à la nourriture
+    Cell fieldFruit = NO_CELL;            // Nourriture du parcours en cours
+    std::vector<Cell> fieldObstacles;     // Obstacles du parcours en cours
+    uint64_t fruitTick = 0;               // Pas où la nourriture est apparue
+
+    bool ordered = false;                 // Le corps suit l'ordre du cycle
+    uint64_t lastTick = 0;                // Pas de la dernière décision
+    uint64_t recheckTick = 0;             // Pas où vérifier à nouveau l'ordre du corps
+
+    std::vector<uint32_t> visitMarks;     // Parcours de ReachableSpace et FindPathMove
+    std::vector<Cell> visitQueue;
+    uint32_t visitGeneration = 0;
+    std::vector<uint32_t> enteredTick;    // Pas (32 bits de poids faible) où la tête est entrée dans chaque case du corps
+    Cell lastHead = NO_CELL;              // Tête à la dernière décision
+    std::vector<uint32_t> pathDepth;      // Distance à la tête de chaque case de la file
+    std::vector<uint8_t> pathFirstMove;   // Premier pas menant à chaque case de la file
+};
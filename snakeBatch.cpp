@@ -0,0 +1,71 @@
+﻿#include "snakeBatch.h"
+
+#include <thread>
+using namespace std;
+
+void SimBatch::Init(uint32_t envCount, uint64_t seed, uint32_t threadCount, const GridShape& grid) {
+    pool.Shutdown();
+
+    envs.resize(envCount);
+    for (uint32_t i = 0; i < envCount; i++) {
+        envs[i].grid = grid;
+        InitState(envs[i], StreamSeed(seed, i));
+    }
+    heads.assign(envCount, 0);
+    dirX.assign(envCount, 0);
+    dirY.assign(envCount, 0);
+    scores.assign(envCount, 0);
+    lengths.assign(envCount, 0);
+    dones.assign(envCount, 0);
+    rewards.assign(envCount, 0.0f);
+    episodeScores.assign(envCount, 0);
+    for (uint32_t i = 0; i < envCount; i++) {
+        WriteOutputs(i);
+    }
+
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    chunkCount = (envCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    pool.Init(min(threadCount, max(1u, chunkCount)));
+}
+
+void SimBatch::Step(const SimAction* stepActions) {
+    actions = stepActions;
+    auto task = [this](uint32_t chunk) {
+        uint32_t begin = chunk * CHUNK_SIZE;
+        StepRange(begin, min(begin + CHUNK_SIZE, Size()));
+    };
+    pool.Run(chunkCount, task);
+}
+
+void SimBatch::StepRange(uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        SimState& state = envs[i];
+        SimOutcome outcome = ::Step(state, actions[i]);
+
+        float reward = 0.0f;
+        if (outcome == SimOutcome::AteFruit || outcome == SimOutcome::BoardFull) {
+            reward = 1.0f;
+        }
+        else if (outcome == SimOutcome::HitSelf || outcome == SimOutcome::HitObstacle) {
+            reward = -1.0f;
+        }
+        rewards[i] = reward;
+        dones[i] = state.gameOver ? 1 : 0;
+        if (state.gameOver) {
+            episodeScores[i] = state.score;
+            ResetState(state);
+        }
+        WriteOutputs(i);
+    }
+}
+
+void SimBatch::WriteOutputs(uint32_t index) {
+    const SimState& state = envs[index];
+    heads[index] = state.body.Head();
+    dirX[index] = (int8_t)state.dirX;
+    dirY[index] = (int8_t)state.dirY;
+    scores[index] = state.score;
+    lengths[index] = state.body.Length();
+}
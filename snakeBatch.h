@@ -0,0 +1,75 @@
+﻿// Exécution groupée de nombreuses parties indépendantes (sans dépendance à SFML)
+//
+// Sert à l'entraînement et à l'évaluation d'agents : un appel à Step fait
+// avancer toutes les parties d'un pas, réparties entre les cœurs. Les
+// sorties (têtes, directions, scores, fins de partie, récompenses) sont
+// rangées en tableaux contigus, une case par partie.
+
+#pragma once
+
+#include "snakeSim.h"
+#include "snakeWorkers.h"
+
+#include <cstdint>
+#include <vector>
+
+/*
+  Ensemble de parties avancées ensemble par un groupe de fils d'exécution.
+  Chaque partie a son propre générateur, dérivé de la graine commune et de
+  son numéro : les résultats ne dépendent pas du nombre de fils.
+*/
+class SimBatch {
+public:
+    /*
+      Crée les parties et lance les fils
+      parametre "envCount" Nombre de parties
+      parametre "seed" Graine commune
+      parametre "threadCount" Nombre de fils (0 : un par cœur)
+      parametre "grid" Dimensions de la grille de chaque partie
+    */
+    void Init(uint32_t envCount, uint64_t seed, uint32_t threadCount = 0, const GridShape& grid = GridShape());
+
+    /*
+      Fait avancer toutes les parties d'un pas. Une partie terminée est
+      aussitôt recommencée : "dones" le signale et "episodeScores" garde son score final.
+      parametre "actions" Une action par partie
+    */
+    void Step(const SimAction* actions);
+
+    /*
+      retourne Le nombre de parties
+    */
+    uint32_t Size() const { return (uint32_t)envs.size(); }
+
+    /*
+      retourne Le nombre de fils utilisés (appelant compris)
+    */
+    uint32_t ThreadCount() const { return pool.ThreadCount(); }
+
+    /*
+      retourne L'état complet d'une partie
+    */
+    const SimState& Env(uint32_t index) const { return envs[index]; }
+
+    // Sorties du dernier pas, une case par partie
+    std::vector<Cell> heads;              // Tête du serpent
+    std::vector<int8_t> dirX;             // Direction du mouvement
+    std::vector<int8_t> dirY;
+    std::vector<int32_t> scores;          // Score de la partie en cours
+    std::vector<uint32_t> lengths;        // Longueur du serpent
+    std::vector<uint8_t> dones;           // 1 si la partie vient de se terminer (et a été recommencée)
+    std::vector<float> rewards;           // +1 nourriture, -1 collision, 0 sinon
+    std::vector<int32_t> episodeScores;   // Score final de la dernière partie terminée
+
+private:
+    // Nombre de parties traitées d'un bloc par un fil
+    static const uint32_t CHUNK_SIZE = 64;
+
+    void StepRange(uint32_t begin, uint32_t end);
+    void WriteOutputs(uint32_t index);
+
+    std::vector<SimState> envs;
+    const SimAction* actions = nullptr;   // Actions du pas en cours
+    uint32_t chunkCount = 0;
+    WorkerPool pool;                      // Un bloc de parties par tâche
+};
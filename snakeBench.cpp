@@ -0,0 +1,713 @@
+﻿// Suite de mesures de performance : pas de jeu, nourriture, collisions, apparition, arène, affichage
+// et enregistrement des images
+//
+// Chaque mesure est répétée pour plusieurs tailles de grille (avec ou sans version
+// spécialisée de Step) et plusieurs longueurs de serpent, de 3 à une grille
+// presque pleine. Les résultats sont écrits en JSON sur la sortie standard, pour
+// comparer deux versions.
+//
+// Compilation : g++ -std=c++17 -O2 -pthread -DSNAKE_COUNT_ALLOCATIONS snakeBench.cpp snakeAllocations.cpp
+//               snakeArena.cpp snakeAutopilot.cpp snakeBatch.cpp snakeFrameDump.cpp snakeInput.cpp snakeMappedFile.cpp
+//               snakeReplay.cpp snakeScores.cpp snakeSim.cpp snakeStats.cpp snakeThread.cpp snakeWorkers.cpp
+//               -o snakeBench
+//   coût des mesures du jeu : ajouter -DSNAKE_PROFILING snakeProfiler.cpp
+//   corps compact (2 bits par segment) : ajouter -DSNAKE_PACKED_BODY
+//   affichage hors écran : ajouter -DSNAKE_BENCH_RENDER snakeRender.cpp -lsfml-graphics -lsfml-window -lsfml-system
+// Utilisation : ./snakeBench [--min-ms N] [--envs N] [--snakes N] [--filter texte] [--grid N] > resultats.json
+//               ./snakeBench --alloc-check [--grid N]
+//                 vérifie qu'un pas (simulation, pilote, fil complet, affichage) n'alloue
+//                 rien après une phase de chauffe ; code de sortie 1 sinon (à lancer avant de livrer)
+
+#include "snakeAllocations.h"
+#include "snakeArena.h"
+#include "snakeAutopilot.h"
+#include "snakeBatch.h"
+#include "snakeFrameDump.h"
+#include "snakeProfiler.h"
+#include "snakeScores.h"
+#include "snakeSim.h"
+#include "snakeThread.h"
+
+#ifdef SNAKE_BENCH_RENDER
+#include "snakeRender.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Résultat d'une mesure
+struct BenchResult {
+    string name;             // Nom de la mesure
+    int gridSize = 0;        // Côté de la grille
+    bool fixedKernel = false;// Step spécialisé pour cette taille
+    uint32_t length = 0;     // Longueur du serpent (0 : variable)
+    uint32_t threads = 1;    // Fils utilisés
+    uint32_t envs = 1;       // Parties simultanées
+    uint64_t iterations = 0; // Nombre d'opérations mesurées
+    double nsPerOp = 0;      // Durée moyenne d'une opération
+};
+
+static double minSeconds = 0.2;           // Durée minimale d'une mesure
+static const char* filter = nullptr;      // Seules les mesures dont le nom contient ce texte
+static vector<BenchResult> results;
+static GridShape grid;                    // Grille des mesures en cours (carrée)
+static volatile uint64_t sink = 0;        // Empêche le compilateur de supprimer les calculs mesurés
+
+/*
+  Répète une opération, en doublant le nombre de répétitions jusqu'à dépasser la durée minimale
+  parametre "name" Nom de la mesure
+  parametre "length" Longueur du serpent
+  parametre "operation" Opération à mesurer, appelée avec le numéro de répétition
+  retourne Le résultat ajouté à la liste
+*/
+template <class Operation>
+static BenchResult* Measure(const char* name, uint32_t length, Operation&& operation) {
+    if (filter != nullptr && strstr(name, filter) == nullptr) {
+        return nullptr;
+    }
+    for (uint64_t iterations = 1; ; iterations *= 2) {
+        auto start = chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            operation(i);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds >= minSeconds) {
+            BenchResult result;
+            result.name = name;
+            result.gridSize = grid.width;
+            result.fixedKernel = HasFixedStep(grid);
+            result.length = length;
+            result.iterations = iterations;
+            result.nsPerOp = seconds * 1e9 / iterations;
+            results.push_back(result);
+            cerr << name << " grid=" << grid.width << " length=" << length << ": " << result.nsPerOp << " ns" << endl;
+            return &results.back();
+        }
+    }
+}
+
+/*
+  Case numéro "index" d'un cycle qui passe une fois par chaque case du tore :
+  chaque ligne est parcourue vers la droite, puis le serpent descend d'une case
+  retourne La case
+*/
+static Cell CycleCell(uint32_t index) {
+    uint32_t size = (uint32_t)grid.width;
+    uint32_t row = (index / size) % size;
+    uint32_t column = index % size;
+    return grid.MakeCell((int)((size - row + column) % size), (int)row);
+}
+
+/*
+  retourne L'action qui mène de la case "index" du cycle à la suivante
+*/
+static SimAction CycleAction(uint32_t index) {
+    return index % grid.width == (uint32_t)grid.width - 1 ? SimAction::Down : SimAction::Right;
+}
+
+/*
+  Prépare une partie avec un serpent de longueur donnée couché le long du cycle,
+  sans nourriture ni obstacle : il peut avancer indéfiniment sans rien toucher
+  parametre "state" L'état à préparer
+  parametre "length" Longueur du serpent
+*/
+static void BuildState(SimState& state, uint32_t length) {
+    state.grid = grid;
+    InitState(state, 42);
+    state.body.Clear();
+    state.blockedCells.Clear();
+    state.obstacleCells.Clear();
+    state.freeCells.Fill();
+    state.obstacles.clear();
+    state.obstacleCount = 0;
+    state.fruitPosition = NO_CELL;
+    for (uint32_t i = 0; i < length; i++) {
+        Cell cell = CycleCell(i);
+        state.body.PushHead(cell);
+        state.blockedCells.Set(cell);
+        state.freeCells.Remove(cell);
+    }
+    bool down = CycleAction(length - 1) == SimAction::Down;
+    state.dirX = down ? 0 : 1;
+    state.dirY = down ? 1 : 0;
+    state.started = true;
+}
+
+/*
+  Version d'origine de GenerateRandomPosition : tirage au hasard jusqu'à
+  trouver une case qui n'est pas dans le corps, parcouru en entier à chaque essai
+  retourne La case tirée
+*/
+static Cell LegacyRandomPosition(const SimState& state, uint64_t& rng) {
+    for (;;) {
+        Cell cell = state.grid.MakeCell(RandomBelow(rng, state.grid.width), RandomBelow(rng, state.grid.height));
+        bool inBody = false;
+        state.body.ForEach([&](Cell segment) { inBody |= segment == cell; });
+        if (!inBody) {
+            return cell;
+        }
+    }
+}
+
+/*
+  Mesures d'une opération de la simulation pour une longueur de serpent
+*/
+static void RunCoreBenchmarks(uint32_t length) {
+    SimState state;
+    uint64_t rng = 11;
+
+    // Cases tirées à l'avance pour les tests de collision
+    const uint32_t PROBES = 4096;
+    vector<Cell> probes(PROBES);
+    for (Cell& probe : probes) {
+        probe = RandomBelow(rng, grid.CellCount());
+    }
+
+    BuildState(state, length);
+    uint32_t cycleIndex = length - 1;
+    Measure("step", length, [&](uint64_t) {
+        Step(state, CycleAction(cycleIndex));
+        cycleIndex = (cycleIndex + 1) % grid.CellCount();
+    });
+    if (state.gameOver) {
+        cerr << "step: the snake left the cycle" << endl;
+    }
+
+    // Parcours du corps entier (captures d'image, enregistrement) : compare les deux
+    // représentations du corps (voir SNAKE_PACKED_BODY dans snakeSim.h)
+    Measure("body_iterate", length, [&](uint64_t) {
+        Cell sum = 0;
+        state.body.ForEach([&sum](Cell cell) { sum += cell; });
+        sink = sink + sum;
+    });
+
+    BuildState(state, length);
+    state.fruitPosition = state.freeCells.At(0);
+    Measure("food_collision", length, [&](uint64_t i) {
+        sink = sink + (probes[i % PROBES] == state.fruitPosition);
+    });
+    Measure("self_collision", length, [&](uint64_t i) {
+        sink = sink + state.blockedCells.Test(probes[i % PROBES]);
+    });
+    // Les versions d'origine parcourent le corps entier : trop lentes sur les grandes grilles
+    bool legacy = grid.CellCount() <= 4096;
+    if (legacy) {
+        Measure("self_collision_scan_legacy", length, [&](uint64_t i) {
+            Cell probe = probes[i % PROBES];
+            bool hit = false;
+            state.body.ForEach([&](Cell segment) { hit |= segment == probe && segment != state.body.Head(); });
+            sink = sink + hit;
+        });
+    }
+
+    BuildState(state, length);
+    Measure("spawn_free_index", length, [&](uint64_t) {
+        Cell cell = state.freeCells.At(RandomBelow(rng, state.freeCells.Count()));
+        state.freeCells.Remove(cell);
+        state.freeCells.Insert(cell);
+        sink = sink + cell;
+    });
+    if (legacy) {
+        Measure("spawn_rejection_legacy", length, [&](uint64_t) {
+            sink = sink + LegacyRandomPosition(state, rng);
+        });
+    }
+}
+
+/*
+  Débit d'une partie jouée au hasard (nourriture, obstacles et fins de partie compris)
+*/
+static void RunRandomPlay() {
+    SimState state;
+    state.grid = grid;
+    InitState(state, 42);
+    uint64_t inputRng = 7;
+    Measure("tick_random_play", 0, [&](uint64_t) {
+        Step(state, (SimAction)RandomBelow(inputRng, 5));
+        if (state.gameOver) {
+            ResetState(state);
+        }
+    });
+}
+
+/*
+  Durée d'un pas joué par le pilote automatique (décision comprise), parties enchaînées
+*/
+static void RunAutopilot() {
+    SimState state;
+    state.grid = grid;
+    InitState(state, 42);
+    Autopilot autopilot;
+    autopilot.Decide(state);  // Préparation du cycle hors mesure
+    Measure("autopilot_tick", 0, [&](uint64_t) {
+        Step(state, autopilot.Decide(state));
+        if (state.gameOver) {
+            ResetState(state);
+        }
+    });
+    if (autopilot.decisionLatency.Count() > 0) {
+        cerr << "autopilot decisions: " << autopilot.decisionLatency.Summary() << endl;
+    }
+}
+
+/*
+  Journal des scores : ajout d'une partie (index compris), lecture du classement
+  et réouverture d'un journal déjà rempli (fichiers temporaires effacés ensuite)
+*/
+static void RunScoreStore() {
+    const char* path = "snakeBench-scores";
+    remove("snakeBench-scores.log");
+    remove("snakeBench-scores.top");
+    ScoreStore store;
+    if (!store.Open(path)) {
+        cerr << "cannot create " << path << ".log" << endl;
+        return;
+    }
+    uint64_t rng = 42;
+    Measure("score_add", 0, [&](uint64_t) {
+        ScoreRecord record;
+        record.score = (int32_t)RandomBelow(rng, 100000);
+        store.Add(record);
+    });
+    Measure("score_top", 0, [&](uint64_t i) {
+        sink = sink + store.Top((uint32_t)(i % store.TopCount())).score;
+    });
+    if (BenchResult* result = Measure("score_open", 0, [&](uint64_t) {
+            store.Open(path);
+        })) {
+        result->length = (uint32_t)store.Count();
+    }
+    store.Close();
+    remove("snakeBench-scores.log");
+    remove("snakeBench-scores.top");
+}
+
+#ifdef SNAKE_PROFILING
+/*
+  Coût d'un bloc mesuré par PROFILE_SCOPE (sans trace en cours)
+*/
+static void RunProfilerOverhead() {
+    Measure("profile_scope", 0, [&](uint64_t i) {
+        PROFILE_SCOPE("bench");
+        sink = sink + i;
+    });
+}
+#endif
+
+/*
+  Encodage d'une image de la taille de la fenêtre (PNG, YUV 4:2:0), puis débit de
+  l'enregistrement complet avec un fil d'encodage par cœur (vidéo temporaire effacée ensuite)
+*/
+static void RunFrameEncoding() {
+    // Image proche de celles du jeu : fond uni et tuiles de 30 pixels dessinées par endroits
+    const uint32_t SIZE = 850;
+    vector<uint8_t> pixels((size_t)SIZE * SIZE * 4);
+    uint64_t rng = 3;
+    for (uint32_t y = 0; y < SIZE; y++) {
+        for (uint32_t x = 0; x < SIZE; x++) {
+            uint8_t* pixel = &pixels[((size_t)y * SIZE + x) * 4];
+            bool tile = (x / 30 * 7 + y / 30 * 13) % 5 == 0;
+            pixel[0] = tile ? (uint8_t)(x % 30 * 8) : 47;
+            pixel[1] = tile ? (uint8_t)(y % 30 * 8) : 79;
+            pixel[2] = tile ? (uint8_t)RandomBelow(rng, 4) : 79;
+            pixel[3] = 255;
+        }
+    }
+    vector<uint8_t> scratch;
+    vector<uint8_t> encoded;
+    if (BenchResult* result = Measure("encode_png", 0, [&](uint64_t) {
+            EncodePng(pixels.data(), SIZE, SIZE, scratch, encoded);
+        })) {
+        // Taille du fichier à la place de la longueur du serpent
+        result->length = (uint32_t)encoded.size();
+    }
+    Measure("encode_yuv420", 0, [&](uint64_t) {
+        ConvertToYuv420(pixels.data(), SIZE, SIZE, encoded);
+    });
+
+    const char* path = "snakeBench-frames.y4m";
+    FrameDumper dumper;
+    if (filter != nullptr && strstr("frame_dump", filter) == nullptr) {
+        return;
+    }
+    if (!dumper.Open(path, FrameFormat::Y4m, SIZE, SIZE, 20)) {
+        cerr << "cannot create " << path << endl;
+        return;
+    }
+    if (BenchResult* result = Measure("frame_dump", 0, [&](uint64_t) {
+            DumpFrame* frame = dumper.Acquire();
+            memcpy(frame->pixels.data(), pixels.data(), pixels.size());
+            dumper.Submit(frame);
+        })) {
+        result->threads = max(1u, thread::hardware_concurrency());
+    }
+    dumper.Close();
+    cerr << "frame_dump: " << dumper.Summary() << endl;
+    remove(path);
+}
+
+/*
+  Débit de parties groupées pour 1, 2, 4... fils jusqu'au nombre de cœurs
+  parametre "envCount" Nombre de parties
+*/
+static void RunBatchScaling(uint32_t envCount) {
+    // Actions tirées à l'avance : le tirage ne doit pas peser sur la mesure
+    const uint32_t ACTION_ROWS = 64;
+    vector<SimAction> actions((size_t)envCount * ACTION_ROWS);
+    uint64_t inputRng = 7;
+    for (SimAction& action : actions) {
+        action = (SimAction)RandomBelow(inputRng, 5);
+    }
+
+    uint32_t coreCount = max(1u, thread::hardware_concurrency());
+    for (uint32_t threads = 1; ; threads = min(threads * 2, coreCount)) {
+        SimBatch batch;
+        batch.Init(envCount, 42, threads, grid);
+        BenchResult* result = Measure("batch_step", 0, [&](uint64_t i) {
+            batch.Step(&actions[(i % ACTION_ROWS) * envCount]);
+        });
+        if (result != nullptr) {
+            // Durée ramenée à un pas d'une partie
+            result->threads = batch.ThreadCount();
+            result->envs = envCount;
+            result->nsPerOp /= envCount;
+        }
+        if (threads == coreCount) {
+            break;
+        }
+    }
+}
+
+/*
+  Durée d'un pas d'arène pour 1, 2, 4... fils jusqu'au nombre de cœurs, avec autant
+  de serpents par fil à chaque fois (la durée doit rester stable) puis avec tous
+  les serpents. Vérifie aussi que le résultat ne dépend pas du nombre de fils.
+  parametre "maxSnakes" Nombre de serpents avec tous les cœurs
+*/
+static void RunArenaScaling(uint32_t maxSnakes) {
+    if (filter != nullptr && strstr("arena_tick", filter) == nullptr) {
+        return;
+    }
+    uint32_t coreCount = max(1u, thread::hardware_concurrency());
+    uint32_t snakesPerThread = max(1u, maxSnakes / coreCount);
+    uint64_t expected = 0;
+    for (uint32_t threads = 1; ; threads = min(threads * 2, coreCount)) {
+        for (uint32_t snakes : { snakesPerThread * threads, maxSnakes }) {
+            // Une case sur 64 occupée par une tête : densité constante d'une mesure à l'autre
+            int side = min(max((int)sqrt((double)snakes * 64), MIN_GRID_SIZE), MAX_GRID_SIZE);
+            GridShape benchGrid = grid;
+            grid = GridShape{ side, side };
+            Arena arena;
+            arena.Init(grid, snakes, snakes / 2, snakes / 4, 42, threads);
+
+            if (snakes == maxSnakes) {
+                for (int i = 0; i < 200; i++) {
+                    arena.Step();
+                }
+                if (threads == 1) {
+                    expected = arena.Checksum();
+                }
+                else if (arena.Checksum() != expected) {
+                    cerr << "arena_tick: " << threads << " threads give a different result than 1 thread" << endl;
+                }
+            }
+
+            BenchResult* result = Measure("arena_tick", 0, [&](uint64_t) {
+                arena.Step();
+            });
+            grid = benchGrid;
+            if (result != nullptr) {
+                result->fixedKernel = false;
+                result->threads = arena.ThreadCount();
+                result->envs = snakes;
+            }
+            if (snakes == maxSnakes || snakesPerThread * threads == maxSnakes) {
+                break;
+            }
+        }
+        if (threads == coreCount) {
+            break;
+        }
+    }
+}
+
+#ifdef SNAKE_BENCH_RENDER
+/*
+  Durée d'une image de la grille dessinée hors écran (interpolation, dessin, affichage)
+*/
+static void RunRenderBenchmark(uint32_t length) {
+    static sf::RenderTexture target;
+    const unsigned int VIEW_CELLS = DEFAULT_GRID_SIZE;
+    if (target.getSize().x == 0 && !target.resize(sf::Vector2u(VIEW_CELLS * TILE_SIZE, VIEW_CELLS * TILE_SIZE))) {
+        cerr << "Error creating offscreen target" << endl;
+        return;
+    }
+    SimState state;
+    BuildState(state, length);
+    SimSnapshot snapshot;
+    CaptureSnapshot(state, snapshot);
+    snapshot.sequence = 1;
+    snapshot.generation = 1;
+    snapshot.previousHead = state.body.At(1);
+    snapshot.previousTail = snapshot.body.back();
+
+    BoardRenderer board;
+    board.Init(sf::Vector2f(0, 0), sf::Vector2u(VIEW_CELLS, VIEW_CELLS));
+    board.Apply(snapshot);
+    Measure("render_frame", length, [&](uint64_t i) {
+        board.Interpolate(snapshot, (i % 16) / 16.0f);
+        target.clear();
+        board.Draw(target);
+        target.display();
+    });
+}
+#endif
+
+#ifdef SNAKE_COUNT_ALLOCATIONS
+/*
+  Compte les allocations d'un chemin critique après une phase de chauffe
+  parametre "name" Nom du chemin vérifié
+  parametre "warmup" Pas joués avant le comptage
+  parametre "ticks" Pas comptés
+  parametre "tick" Un pas, appelé avec son numéro
+  retourne true si aucune allocation n'a été comptée
+*/
+template <class Tick>
+static bool CheckAllocations(const char* name, uint64_t warmup, uint64_t ticks, Tick&& tick) {
+    for (uint64_t i = 0; i < warmup; i++) {
+        tick(i);
+    }
+    uint64_t before = AllocationCount();
+    for (uint64_t i = 0; i < ticks; i++) {
+        tick(warmup + i);
+    }
+    uint64_t allocations = AllocationCount() - before;
+    cerr << "alloc_check " << name << " grid=" << grid.width << ": " << allocations << " allocations in "
+         << ticks << " ticks" << (allocations == 0 ? "" : "  FAILED") << endl;
+    return allocations == 0;
+}
+
+/*
+  Vérifie que les chemins critiques n'allouent rien en régime établi : pas de
+  simulation et instantané, décision du pilote, fil de simulation complet
+  (enregistrement compris) et, si compilé, préparation de l'affichage
+  retourne true si aucun chemin n'a alloué
+*/
+static bool RunAllocationChecks() {
+    bool passed = true;
+
+    // Partie au hasard : nourriture, obstacles et fins de partie compris
+    {
+        SimState state;
+        state.grid = grid;
+        state.trackChanges = true;
+        InitState(state, 42);
+        SimSnapshot snapshot;
+        ReserveSnapshot(state, snapshot);
+        uint64_t inputRng = 7;
+        passed &= CheckAllocations("sim_tick", 10000, 200000, [&](uint64_t) {
+            Step(state, (SimAction)RandomBelow(inputRng, 5));
+            CaptureSnapshot(state, snapshot);
+            if (state.gameOver) {
+                ResetState(state);
+            }
+        });
+    }
+
+    // Pilote automatique : le serpent s'allonge pendant le comptage
+    {
+        SimState state;
+        state.grid = grid;
+        state.trackChanges = true;
+        InitState(state, 42);
+        SimSnapshot snapshot;
+        ReserveSnapshot(state, snapshot);
+        Autopilot autopilot;
+        passed &= CheckAllocations("autopilot_tick", 10000, 100000, [&](uint64_t) {
+            Step(state, autopilot.Decide(state));
+            CaptureSnapshot(state, snapshot);
+            if (state.gameOver) {
+                ResetState(state);
+            }
+        });
+    }
+
+    // Fil de simulation à pleine vitesse, avec enregistrement ; l'appelant lit les instantanés
+    {
+        const char* replayPath = "snakeBench-alloc.snkr";
+        SimThread sim;
+        sim.SetAutopilot(true);
+        sim.Start(42, chrono::microseconds(20), replayPath, grid);
+        auto readFor = [&](chrono::milliseconds duration) {
+            uint64_t published = 0;
+            for (auto end = chrono::steady_clock::now() + duration; chrono::steady_clock::now() < end; ) {
+                if (sim.Acquire()) {
+                    published++;
+                    if (sim.Latest().gameOver) {
+                        sim.RequestRestart();
+                    }
+                }
+            }
+            return published;
+        };
+        readFor(chrono::milliseconds(300));
+        uint64_t before = AllocationCount();
+        uint64_t published = readFor(chrono::milliseconds(1000));
+        uint64_t allocations = AllocationCount() - before;
+        sim.Stop();
+        remove(replayPath);
+        cerr << "alloc_check sim_thread grid=" << grid.width << ": " << allocations << " allocations in "
+             << published << " snapshots" << (allocations == 0 ? "" : "  FAILED") << endl;
+        passed &= allocations == 0;
+    }
+
+#ifdef SNAKE_BENCH_RENDER
+    // Affichage : instantanés appliqués, interpolés et dessinés hors écran
+    {
+        sf::RenderTexture target;
+        if (target.resize(sf::Vector2u(DEFAULT_GRID_SIZE * TILE_SIZE, DEFAULT_GRID_SIZE * TILE_SIZE))) {
+            SimState state;
+            state.grid = grid;
+            state.trackChanges = true;
+            InitState(state, 42);
+            SimSnapshot snapshot;
+            ReserveSnapshot(state, snapshot);
+            BoardRenderer board;
+            board.Init(sf::Vector2f(0, 0), sf::Vector2u(DEFAULT_GRID_SIZE, DEFAULT_GRID_SIZE));
+            Autopilot autopilot;
+            passed &= CheckAllocations("render_frame", 1000, 10000, [&](uint64_t i) {
+                Step(state, autopilot.Decide(state));
+                CaptureSnapshot(state, snapshot);
+                snapshot.sequence = i + 1;
+                snapshot.generation = 1;
+                board.Apply(snapshot);
+                board.Interpolate(snapshot, 0.5f);
+                target.clear();
+                board.Draw(target);
+                target.display();
+                if (state.gameOver) {
+                    ResetState(state);
+                }
+            });
+        }
+    }
+#endif
+    return passed;
+}
+#endif
+
+/*
+  Écrit les résultats en JSON
+*/
+static void WriteJson() {
+    cout << "{\n";
+    cout << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        cout << "    {\"name\": \"" << result.name << "\", \"grid_size\": " << result.gridSize
+             << ", \"fixed_kernel\": " << (result.fixedKernel ? "true" : "false") << ", \"length\": " << result.length
+             << ", \"threads\": " << result.threads << ", \"envs\": " << result.envs
+             << ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.nsPerOp << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    cout << "  ]\n";
+    cout << "}" << endl;
+}
+
+/*
+  Fonction principale du benchmark
+  retourne Code de sortie
+*/
+int main(int argc, char** argv)
+{
+    uint32_t envCount = 1024;
+    uint32_t arenaSnakes = 4096;
+    // 24 n'a pas de version spécialisée : comparée à 25 et 32, elle mesure le coût du cas général
+    vector<int> gridSizes = { 16, 24, 25, 32, 64, 512 };
+    bool allocCheck = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--alloc-check") == 0) {
+            allocCheck = true;
+        }
+        else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            minSeconds = atof(argv[++i]) / 1000.0;
+        }
+        else if (strcmp(argv[i], "--envs") == 0 && i + 1 < argc) {
+            envCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--snakes") == 0 && i + 1 < argc) {
+            arenaSnakes = min(max((uint32_t)strtoul(argv[++i], nullptr, 10), 1u), ARENA_MAX_SNAKES);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            gridSizes.assign(1, min(max(atoi(argv[++i]), MIN_GRID_SIZE), MAX_GRID_SIZE));
+        }
+        else {
+            cerr << "usage: " << argv[0] << " [--min-ms N] [--envs N] [--snakes N] [--filter text] [--grid N]" << endl
+                 << "       " << argv[0] << " --alloc-check [--grid N]" << endl;
+            return 1;
+        }
+    }
+
+    if (allocCheck) {
+#ifdef SNAKE_COUNT_ALLOCATIONS
+        bool passed = true;
+        for (int size : gridSizes) {
+            grid.width = size;
+            grid.height = size;
+            passed &= RunAllocationChecks();
+        }
+        return passed ? 0 : 1;
+#else
+        cerr << "--alloc-check needs -DSNAKE_COUNT_ALLOCATIONS and snakeAllocations.cpp" << endl;
+        return 1;
+#endif
+    }
+
+    for (int size : gridSizes) {
+        grid.width = size;
+        grid.height = size;
+
+        // Longueurs de 3 à une grille presque pleine (quelques cases libres)
+        uint32_t cellCount = grid.CellCount();
+        const uint32_t lengths[] = { 3, cellCount / 4, cellCount / 2, cellCount * 3 / 4, cellCount - 4 };
+        for (uint32_t length : lengths) {
+            RunCoreBenchmarks(length);
+        }
+        RunRandomPlay();
+        RunAutopilot();
+        if (size == gridSizes.front()) {
+            RunScoreStore();
+            RunFrameEncoding();
+            RunArenaScaling(arenaSnakes);
+#ifdef SNAKE_PROFILING
+            RunProfilerOverhead();
+#endif
+        }
+
+        // Nombre de parties groupées limité à environ 4 millions de cases en tout
+        uint32_t batchEnvs = min(envCount, max(1u, (1u << 22) / cellCount));
+        if (envCount > 0) {
+            RunBatchScaling(batchEnvs);
+        }
+#ifdef SNAKE_BENCH_RENDER
+        for (uint32_t length : lengths) {
+            RunRenderBenchmark(length);
+        }
+#endif
+    }
+
+    WriteJson();
+    return 0;
+}
@@ -0,0 +1,360 @@
+﻿// Générateur de charge pour snakeServer : des robots clients, sans réseau extérieur
+//
+// Les robots se répartissent sur quelques fils, chacun avec sa boucle d'événements.
+// Chaque robot tient la copie de sa partie à jour (NetMirror), choisit sa direction
+// d'après elle (vers la nourriture, en évitant les cases occupées) et recommence
+// une partie perdue. Mesures, pour tous les robots :
+//   virage -> pas  délai entre l'envoi d'un virage et le premier message qui en
+//                  accuse réception (attente du pas suivant comprise)
+//   écart des pas  temps entre deux Delta reçus : la cadence vue par le client
+// Avec --verify N, chaque robot redemande une Keyframe tous les N pas : elle doit
+// être identique à sa copie (sinon "mismatches", erreur du protocole ; code de sortie 1).
+// Le nombre de sessions qu'un cœur tient est donné par le résumé du serveur.
+//
+// Compilation : g++ -std=c++17 -O2 -pthread snakeBots.cpp snakeNet.cpp snakeSim.cpp snakeStats.cpp -o snakeBots
+// Utilisation : ./snakeBots [udp:7777] [--bots N] [--threads N] [--seconds S] [--verify N] [--seed N]
+//                 adresse du serveur : udp:PORT, tcp:PORT ou unix:CHEMIN (udp:7777 par défaut)
+//                 --bots     robots, connectés au départ (100 par défaut)
+//                 --threads  fils des robots (1 par défaut)
+//                 --seconds  durée de la mesure (10 par défaut)
+
+#include "snakeNet.h"
+#include "snakeSim.h"
+#include "snakeStats.h"
+
+#include <poll.h>
+#include <signal.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Rien reçu depuis plus longtemps (et au moins 4 pas) : le Hello est renvoyé
+// (datagramme perdu ou session fermée par le serveur)
+static const chrono::milliseconds HELLO_RETRY(500);
+// Virage sans accusé de réception depuis plus longtemps : compté comme perdu
+static const chrono::seconds INPUT_TIMEOUT(1);
+// Mesures gardées par fil pour les percentiles
+static const uint32_t SAMPLES_PER_THREAD = 1 << 16;
+
+/*
+  Robot : un client du serveur
+*/
+struct Bot {
+    NetLink link;
+    NetMirror mirror;
+    uint64_t rng = 0;
+    uint32_t inputSequence = 0;              // Numéro du dernier virage envoyé
+    bool inputPending = false;               // Le dernier virage attend son accusé
+    InputClock::time_point inputSentAt;
+    InputClock::time_point helloSentAt;
+    InputClock::time_point lastReceived;     // Dernier message reçu
+    InputClock::time_point lastDelta;        // Réception du dernier Delta (écart des pas)
+    bool hasDelta = false;
+    uint32_t gameOverMessages = 0;           // Messages reçus depuis la fin de la partie
+    uint32_t verifyCountdown = 0;            // Pas avant la prochaine Keyframe demandée
+};
+
+/*
+  Mesures et compteurs d'un fil
+*/
+struct BotStats {
+    LatencyStats inputLatency{ SAMPLES_PER_THREAD };  // Virage -> pas (µs)
+    LatencyStats spacing{ SAMPLES_PER_THREAD };       // Écart entre deux Delta (µs)
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t games = 0;                                // Parties terminées
+    uint64_t inputsLost = 0;                           // Virages jamais accusés
+    uint64_t connected = 0;
+    uint64_t disconnected = 0;                         // Liens fermés par le serveur ou rompus
+    uint64_t keyframes = 0;
+    uint64_t deltas = 0;
+    uint64_t losses = 0;
+    uint64_t mismatches = 0;
+};
+
+/*
+  Envoie un message d'un octet (Hello ajoute la version)
+*/
+static void SendSimple(Bot& bot, NetWriter& writer, NetMessage type) {
+    writer.Start(type);
+    if (type == NetMessage::Hello) {
+        writer.Put8(NET_VERSION);
+        bot.helloSentAt = InputClock::now();
+    }
+    bot.link.Send(writer);
+}
+
+/*
+  retourne La distance entre deux cases sur la grille torique (en pas)
+*/
+static uint32_t TorusDistance(const GridShape& grid, Cell a, Cell b) {
+    int dx = abs(grid.CellX(a) - grid.CellX(b));
+    int dy = abs(grid.CellY(a) - grid.CellY(b));
+    return (uint32_t)(min(dx, grid.width - dx) + min(dy, grid.height - dy));
+}
+
+/*
+  Choisit la direction du robot : vers la nourriture par une case libre, parfois au hasard
+  parametre "mirror" Copie de la partie
+  parametre "rng" Générateur du robot
+  retourne La direction choisie (celle du serpent s'il n'a plus d'issue)
+*/
+static SimAction ChooseAction(const NetMirror& mirror, uint64_t& rng) {
+    const GridShape& grid = mirror.Grid();
+    const SnakeBody& body = mirror.Body();
+    Cell head = body.Head();
+    SimAction current = body.Length() > 1 ? NetDirection(grid, body.At(1), head) : SimAction::Right;
+    bool wander = RandomBelow(rng, 8) == 0;
+    SimAction best = current;
+    uint32_t bestDistance = 0xFFFFFFFF;
+    for (uint32_t a = (uint32_t)SimAction::Up; a <= (uint32_t)SimAction::Right; a++) {
+        SimAction action = (SimAction)a;
+        Cell next = NetNeighbor(grid, head, action);
+        if (action == OppositeAction(current) || (mirror.IsBlocked(next) && next != body.Tail())) {
+            continue;
+        }
+        uint32_t distance = wander ? RandomBelow(rng, 4) : mirror.Fruit() != NO_CELL ? TorusDistance(grid, next, mirror.Fruit()) : 0;
+        if (distance < bestDistance) {
+            best = action;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+/*
+  Traite un message du serveur : copie mise à jour, mesures, puis la réaction du robot
+*/
+static void OnMessage(Bot& bot, const uint8_t* data, uint32_t size, NetWriter& writer, BotStats& stats, uint32_t verify) {
+    stats.messages++;
+    stats.bytes += size;
+    bot.lastReceived = InputClock::now();
+    if (data[0] == (uint8_t)NetMessage::Bye) {
+        SendSimple(bot, writer, NetMessage::Hello);
+        return;
+    }
+    if (!bot.mirror.Apply(data, size)) {
+        if (bot.mirror.NeedsResync()) {
+            SendSimple(bot, writer, NetMessage::Resync);
+        }
+        return;
+    }
+    InputClock::time_point now = InputClock::now();
+    if (data[0] == (uint8_t)NetMessage::Delta) {
+        if (bot.hasDelta) {
+            stats.spacing.Add(chrono::duration<double, micro>(now - bot.lastDelta).count());
+        }
+        bot.lastDelta = now;
+        bot.hasDelta = true;
+    }
+    const NetMirror& mirror = bot.mirror;
+    if (bot.inputPending && (int32_t)(mirror.Ack() - bot.inputSequence) >= 0) {
+        stats.inputLatency.Add(chrono::duration<double, micro>(now - bot.inputSentAt).count());
+        bot.inputPending = false;
+    }
+
+    // Partie perdue : une nouvelle, redemandée de temps en temps si la demande s'est perdue
+    if (mirror.IsGameOver()) {
+        if (bot.gameOverMessages++ % NET_RESYNC_RETRY == 0) {
+            stats.games += bot.gameOverMessages == 1 ? 1 : 0;
+            SendSimple(bot, writer, NetMessage::Restart);
+        }
+        return;
+    }
+    bot.gameOverMessages = 0;
+
+    if (verify > 0 && data[0] == (uint8_t)NetMessage::Delta && --bot.verifyCountdown == 0) {
+        bot.verifyCountdown = verify;
+        SendSimple(bot, writer, NetMessage::Resync);
+    }
+    if (bot.inputPending) {
+        return;
+    }
+    const SnakeBody& body = mirror.Body();
+    SimAction current = body.Length() > 1 ? NetDirection(mirror.Grid(), body.At(1), body.Head()) : SimAction::None;
+    SimAction action = ChooseAction(mirror, bot.rng);
+    if (action != current || !mirror.IsStarted()) {
+        writer.Start(NetMessage::Input);
+        writer.Put32(++bot.inputSequence);
+        writer.Put8((uint8_t)action);
+        bot.link.Send(writer);
+        bot.inputPending = true;
+        bot.inputSentAt = now;
+    }
+}
+
+/*
+  Fait jouer des robots jusqu'à l'échéance, sur le fil appelant
+  parametre "endpoint" Adresse du serveur
+  parametre "count" Nombre de robots
+  parametre "seed" Graine des robots de ce fil
+  parametre "verify" Pas entre deux Keyframes demandées pour vérification (0 : aucune)
+  parametre "deadline" Fin de la mesure
+  parametre "stats" Reçoit les mesures
+*/
+static void RunBots(const NetEndpoint& endpoint, uint32_t count, uint64_t seed, uint32_t verify,
+                    InputClock::time_point deadline, BotStats& stats) {
+    vector<Bot> bots(count);
+    NetWriter writer;
+    for (uint32_t i = 0; i < count; i++) {
+        Bot& bot = bots[i];
+        bot.rng = StreamSeed(seed, i);
+        bot.verifyCountdown = verify;
+        int socket = NetConnect(endpoint);
+        if (socket < 0) {
+            continue;
+        }
+        bot.link.Attach(socket, endpoint.transport != NetTransport::Udp);
+        SendSimple(bot, writer, NetMessage::Hello);
+        stats.connected++;
+    }
+
+    vector<pollfd> pollSet;
+    vector<uint32_t> pollBots;
+    while (InputClock::now() < deadline) {
+        pollSet.clear();
+        pollBots.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            if (bots[i].link.IsOpen()) {
+                pollSet.push_back({ bots[i].link.Socket(), (short)(POLLIN | (bots[i].link.HasPendingOutput() ? POLLOUT : 0)), 0 });
+                pollBots.push_back(i);
+            }
+        }
+        if (pollSet.empty()) {
+            break;
+        }
+        if (poll(pollSet.data(), (nfds_t)pollSet.size(), 5) < 0) {
+            continue;
+        }
+        for (size_t k = 0; k < pollSet.size(); k++) {
+            Bot& bot = bots[pollBots[k]];
+            short events = pollSet[k].revents;
+            bool open = (events & POLLOUT) == 0 || bot.link.Flush();
+            if (open && (events & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                open = bot.link.Receive([&](const uint8_t* data, uint32_t size) { OnMessage(bot, data, size, writer, stats, verify); });
+            }
+            if (!open) {
+                bot.link.Close();
+                stats.disconnected++;
+            }
+        }
+
+        // Hello ou virage perdus (udp)
+        InputClock::time_point now = InputClock::now();
+        for (Bot& bot : bots) {
+            if (!bot.link.IsOpen()) {
+                continue;
+            }
+            InputClock::duration silence = max<InputClock::duration>(HELLO_RETRY, 4 * bot.mirror.TickInterval());
+            if (now - bot.lastReceived > silence && now - bot.helloSentAt > silence) {
+                SendSimple(bot, writer, NetMessage::Hello);
+            }
+            if (bot.inputPending && now - bot.inputSentAt > INPUT_TIMEOUT) {
+                bot.inputPending = false;
+                stats.inputsLost++;
+            }
+        }
+    }
+
+    for (Bot& bot : bots) {
+        if (bot.link.IsOpen()) {
+            SendSimple(bot, writer, NetMessage::Bye);
+            bot.link.Close();
+        }
+        stats.keyframes += bot.mirror.keyframes;
+        stats.deltas += bot.mirror.deltas;
+        stats.losses += bot.mirror.losses;
+        stats.mismatches += bot.mirror.mismatches;
+    }
+}
+
+/*
+  Écrit les percentiles d'une mesure en millisecondes
+*/
+static void PrintLatency(const char* name, const LatencyStats& stats) {
+    printf("%s: n=%llu mean=%.3f p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f ms\n", name,
+           (unsigned long long)stats.Count(), stats.Mean() / 1000, stats.Percentile(50) / 1000,
+           stats.Percentile(90) / 1000, stats.Percentile(99) / 1000, stats.Percentile(99.9) / 1000, stats.Max() / 1000);
+}
+
+int main(int argc, char** argv)
+{
+    NetEndpoint endpoint;
+    ParseEndpoint("udp:7777", endpoint);
+    uint32_t botCount = 100;
+    uint32_t threadCount = 1;
+    double seconds = 10;
+    uint32_t verify = 0;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc) {
+            botCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = max((uint32_t)strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--verify") == 0 && i + 1 < argc) {
+            verify = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!ParseEndpoint(argv[i], endpoint)) {
+            cerr << "usage: " << argv[0] << " [udp:7777|tcp:PORT|unix:PATH] [--bots N] [--threads N] [--seconds S]"
+                 << " [--verify N] [--seed N]" << endl;
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+    threadCount = min(threadCount, max(botCount, 1u));
+
+    // Fils indépendants : chacun a ses robots, ses sockets et ses mesures
+    vector<BotStats> stats(threadCount);
+    vector<thread> threads;
+    InputClock::time_point deadline = InputClock::now() + chrono::duration_cast<InputClock::duration>(chrono::duration<double>(seconds));
+    for (uint32_t t = 0; t < threadCount; t++) {
+        uint32_t count = botCount / threadCount + (t < botCount % threadCount ? 1 : 0);
+        threads.emplace_back(RunBots, cref(endpoint), count, StreamSeed(seed, t), verify, deadline, ref(stats[t]));
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    BotStats total;
+    LatencyStats inputLatency(SAMPLES_PER_THREAD * threadCount);
+    LatencyStats spacing(SAMPLES_PER_THREAD * threadCount);
+    for (const BotStats& part : stats) {
+        inputLatency.Merge(part.inputLatency);
+        spacing.Merge(part.spacing);
+        total.messages += part.messages;
+        total.bytes += part.bytes;
+        total.games += part.games;
+        total.inputsLost += part.inputsLost;
+        total.connected += part.connected;
+        total.disconnected += part.disconnected;
+        total.keyframes += part.keyframes;
+        total.deltas += part.deltas;
+        total.losses += part.losses;
+        total.mismatches += part.mismatches;
+    }
+    printf("bots: %llu/%u connected to %s on %u threads for %.1f s\n", (unsigned long long)total.connected, botCount,
+           FormatEndpoint(endpoint).c_str(), threadCount, seconds);
+    printf("messages: %.0f/s, %.1f B/msg | deltas %llu | keyframes %llu | games %llu\n", total.messages / seconds,
+           total.messages > 0 ? (double)total.bytes / total.messages : 0.0, (unsigned long long)total.deltas,
+           (unsigned long long)total.keyframes, (unsigned long long)total.games);
+    printf("lost sync %llu | mismatches %llu | inputs without ack %llu | disconnected %llu\n",
+           (unsigned long long)total.losses, (unsigned long long)total.mismatches, (unsigned long long)total.inputsLost,
+           (unsigned long long)total.disconnected);
+    PrintLatency("turn -> tick", inputLatency);
+    PrintLatency("tick spacing", spacing);
+    return total.mismatches == 0 && total.deltas > 0 ? 0 : 1;
+}
@@ -0,0 +1,302 @@
+﻿// SFML VERSION 3.0
+//
+// Client léger de snakeServer : la partie est jouée par le serveur, le client envoie
+// les touches et dessine la copie tenue à jour par les messages reçus (NetMirror)
+//
+// Compilation : g++ -std=c++17 -O2 -pthread snakeClient.cpp snakeNet.cpp snakeRender.cpp snakeAssets.cpp snakeResources.cpp
+//               snakeSim.cpp snakeStats.cpp snakeWorkers.cpp -lsfml-graphics -lsfml-window -lsfml-system -o snakeClient
+// Utilisation : ./snakeClient [udp:7777|tcp:PORT|unix:CHEMIN]
+//                 flèches ou WASD : virages ; Espace : nouvelle partie après la fin
+
+#include <SFML/Graphics.hpp>
+
+#include "snakeRender.h"
+#include "snakeAssets.h"
+#include "snakeNet.h"
+#include "snakeResources.h"
+#include "snakeSim.h"
+#include "snakeStats.h"
+#include "snakeThread.h"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <optional>
+using namespace std;
+
+// Mêmes dimensions que le jeu
+const int VIEW_CELLS = DEFAULT_GRID_SIZE;       // Cases affichées sur chaque axe (au-delà, la vue suit le serpent)
+const int WINDOW_SIZE = VIEW_CELLS * TILE_SIZE; // Dimension totale de la zone de jeu
+const int MARGIN = 50;                          // Marge autour de la zone de jeu
+const int SCREEN_SIZE = 2 * MARGIN + WINDOW_SIZE;  // Dimension de la fenêtre (en coordonnées du jeu)
+const sf::Color BACKGROUND_COLOR = sf::Color(47, 79, 79, 255);   // Gris ardoise foncé
+
+// Rien reçu depuis plus longtemps (et au moins 4 pas) : le Hello est renvoyé
+// (datagramme perdu, session fermée par le serveur ou serveur redémarré)
+const chrono::milliseconds HELLO_RETRY(500);
+
+/*
+  Client : lien avec le serveur, copie de la partie et son affichage
+*/
+class Client {
+public:
+    NetLink link;
+    NetMirror mirror;
+    BoardRenderer board;
+    SimSnapshot snapshot;                   // Dernière copie capturée pour l'affichage
+    LatencyStats inputLatency{ 4096 };      // Touche -> premier message qui l'a prise en compte (µs)
+
+    Client(ResourceCache& cache, AssetLoader& loader)
+        : assets(loader),
+          scoreText(cache.GetFont(FONT_PATH), 24, sf::Color::Black, { TILE_SIZE * 21, 5 }),
+          statusText(cache.GetFont(FONT_PATH), 24, sf::Color::White, { MARGIN, MARGIN + WINDOW_SIZE / 2 }) {
+        mirror.trackChanges = true;
+    }
+
+    /*
+      Ouvre la connexion et demande la partie
+      parametre "endpoint" Adresse du serveur
+      retourne false si le serveur est injoignable
+    */
+    bool Connect(const NetEndpoint& endpoint) {
+        int socket = NetConnect(endpoint);
+        if (socket < 0) {
+            return false;
+        }
+        link.Attach(socket, endpoint.transport != NetTransport::Udp);
+        Send(NetMessage::Hello);
+        return true;
+    }
+
+    /*
+      Envoie un message sans contenu (Hello ajoute la version)
+    */
+    void Send(NetMessage type) {
+        writer.Start(type);
+        if (type == NetMessage::Hello) {
+            writer.Put8(NET_VERSION);
+            helloSentAt = InputClock::now();
+        }
+        link.Send(writer);
+        lastSentAt = InputClock::now();
+    }
+
+    /*
+      Envoie un virage ; le serveur le prend au prochain pas
+      parametre "action" La direction demandée
+    */
+    void Turn(SimAction action) {
+        writer.Start(NetMessage::Input);
+        writer.Put32(++inputSequence);
+        writer.Put8((uint8_t)action);
+        link.Send(writer);
+        lastSentAt = InputClock::now();
+        if (!inputPending) {
+            inputPending = true;
+            inputSentAt = InputClock::now();
+        }
+    }
+
+    /*
+      Lit les messages arrivés et met la grille à jour
+      retourne false si le serveur a fermé la connexion
+    */
+    bool Update() {
+        if (!assets.IsComplete() && assets.Poll() && shownGrid.width > 0) {
+            SetTileImages();
+        }
+        bool fresh = false;
+        bool open = link.Receive([this, &fresh](const uint8_t* data, uint32_t size) {
+            lastReceivedAt = InputClock::now();
+            if (data[0] == (uint8_t)NetMessage::Bye) {
+                // Session inconnue du serveur (fermée pendant un silence) : une nouvelle est demandée
+                Send(NetMessage::Hello);
+                return;
+            }
+            if (!mirror.Apply(data, size)) {
+                if (mirror.NeedsResync()) {
+                    Send(NetMessage::Resync);
+                }
+                return;
+            }
+            if (inputPending && (int32_t)(mirror.Ack() - inputSequence) >= 0) {
+                inputLatency.Add(chrono::duration<double, micro>(InputClock::now() - inputSentAt).count());
+                inputPending = false;
+            }
+            fresh = true;
+        });
+        InputClock::time_point now = InputClock::now();
+        InputClock::duration silence = max<InputClock::duration>(HELLO_RETRY, 4 * mirror.TickInterval());
+        if (now - lastReceivedAt > silence && now - helloSentAt > silence) {
+            Send(NetMessage::Hello);
+        }
+        else if (now - lastSentAt > NET_KEEPALIVE) {
+            // Joueur qui va tout droit ou attend sur l'écran de fin : la session reste ouverte
+            Send(NetMessage::Ping);
+        }
+        if (fresh) {
+            mirror.Capture(snapshot);
+            if (snapshot.grid.width != shownGrid.width || snapshot.grid.height != shownGrid.height) {
+                Layout(snapshot.grid);
+            }
+            board.Apply(snapshot);
+        }
+        return open;
+    }
+
+    /*
+      Avancement entre le pas affiché et le suivant, pour l'interpolation
+      retourne Une valeur de 0 (pas affiché) à 1 (pas suivant attendu)
+    */
+    float Alpha() const {
+        if (!snapshot.started || snapshot.gameOver || mirror.TickInterval().count() == 0) {
+            return 1.0f;
+        }
+        chrono::duration<float> elapsed = InputClock::now() - snapshot.tickTime;
+        chrono::duration<float> interval = mirror.TickInterval();
+        return min(elapsed / interval, 1.0f);
+    }
+
+    /*
+      Dessine le terrain, la grille et le score
+      parametre "target" La cible où dessiner
+    */
+    void Draw(sf::RenderTarget& target) {
+        sf::RectangleShape background(boardSize);
+        background.setFillColor(BACKGROUND_COLOR);
+        background.setPosition(boardOrigin);
+        background.setOutlineThickness(5);
+        background.setOutlineColor(sf::Color(34, 34, 34, 255));
+        target.draw(background);
+        if (mirror.keyframes > 0) {
+            board.Interpolate(snapshot, Alpha());
+            board.Draw(target);
+            scoreText.SetNumber("Score : ", snapshot.score);
+            scoreText.Draw(target);
+        }
+        if (!mirror.IsSynced() || snapshot.gameOver) {
+            statusText.SetString(!mirror.IsSynced() ? "Waiting for server..." : "Game over - press Space");
+            statusText.Draw(target);
+        }
+    }
+
+private:
+    /*
+      Place la grille au centre de la zone de jeu (au-delà de VIEW_CELLS, la vue suit le serpent)
+      parametre "grid" Les dimensions de la grille du serveur
+    */
+    void Layout(const GridShape& grid) {
+        shownGrid = grid;
+        boardSize = sf::Vector2f((float)(min(grid.width, VIEW_CELLS) * TILE_SIZE), (float)(min(grid.height, VIEW_CELLS) * TILE_SIZE));
+        boardOrigin = sf::Vector2f(MARGIN + (WINDOW_SIZE - boardSize.x) / 2, MARGIN + (WINDOW_SIZE - boardSize.y) / 2);
+        board.Init(boardOrigin, sf::Vector2u(VIEW_CELLS, VIEW_CELLS));
+        SetTileImages();
+    }
+
+    /*
+      Donne à la grille les images des tuiles déjà chargées
+    */
+    void SetTileImages() {
+        const sf::Image* tileImages[(int)CellContent::Count] = {
+            nullptr,
+            assets.Image(AssetId::SnakeTile),
+            assets.Image(AssetId::FruitTile),
+            assets.Image(AssetId::ObstacleTile)
+        };
+        board.SetTileImages(tileImages);
+    }
+
+    AssetLoader& assets;
+    CachedText scoreText;
+    CachedText statusText;
+    NetWriter writer;
+    GridShape shownGrid{ 0, 0 };
+    sf::Vector2f boardSize{ (float)WINDOW_SIZE, (float)WINDOW_SIZE };
+    sf::Vector2f boardOrigin{ (float)MARGIN, (float)MARGIN };
+    uint32_t inputSequence = 0;             // Numéro du dernier virage envoyé
+    bool inputPending = false;              // Un virage attend d'être pris en compte
+    InputClock::time_point inputSentAt;
+    InputClock::time_point helloSentAt;
+    InputClock::time_point lastSentAt;      // Dernier message envoyé (voir NET_KEEPALIVE)
+    InputClock::time_point lastReceivedAt;  // Dernier message reçu
+};
+
+int main(int argc, char** argv)
+{
+    NetEndpoint endpoint;
+    if (!ParseEndpoint(argc > 1 ? argv[1] : "udp:7777", endpoint)) {
+        cout << "usage: " << argv[0] << " [udp:7777|tcp:PORT|unix:PATH]" << endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    AssetLoader assets;
+    assets.Start();
+    ResourceCache resources;
+
+    sf::RenderWindow window(sf::VideoMode(sf::Vector2u(SCREEN_SIZE, SCREEN_SIZE)), "Snake Client - " + FormatEndpoint(endpoint));
+    window.setVerticalSyncEnabled(true);
+    window.setKeyRepeatEnabled(false);  // Une touche maintenue ne compte que pour un virage
+
+    Client client(resources, assets);
+    if (!client.Connect(endpoint)) {
+        cout << "Cannot reach " << FormatEndpoint(endpoint) << endl;
+        return 1;
+    }
+
+    // Boucle principale : les messages sont lus à chaque image, sans attendre
+    while (window.isOpen())
+    {
+        while (const optional event = window.pollEvent())
+        {
+            if (event->is<sf::Event::Closed>()) {
+                window.close();
+            }
+            else if (const sf::Event::KeyPressed* key = event->getIf<sf::Event::KeyPressed>()) {
+                switch (key->code) {
+                case sf::Keyboard::Key::Left:
+                case sf::Keyboard::Key::A:
+                    client.Turn(SimAction::Left);
+                    break;
+                case sf::Keyboard::Key::Right:
+                case sf::Keyboard::Key::D:
+                    client.Turn(SimAction::Right);
+                    break;
+                case sf::Keyboard::Key::Up:
+                case sf::Keyboard::Key::W:
+                    client.Turn(SimAction::Up);
+                    break;
+                case sf::Keyboard::Key::Down:
+                case sf::Keyboard::Key::S:
+                    client.Turn(SimAction::Down);
+                    break;
+                case sf::Keyboard::Key::Space:
+                    if (client.mirror.IsGameOver()) {
+                        client.Send(NetMessage::Restart);
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        if (!client.Update()) {
+            cout << "Connection closed by server" << endl;
+            break;
+        }
+
+        window.clear(BACKGROUND_COLOR);
+        client.Draw(window);
+        window.display();
+    }
+
+    if (client.link.IsOpen()) {
+        client.Send(NetMessage::Bye);
+        client.link.Flush();
+    }
+    cout << "Input latency: " << client.inputLatency.Summary() << endl;
+    cout << "Keyframes " << client.mirror.keyframes << ", deltas " << client.mirror.deltas
+         << ", lost sync " << client.mirror.losses << endl;
+    return 0;
+}
@@ -0,0 +1,498 @@
+﻿#include "snakeFrameDump.h"
+#include "snakeScores.h"
+
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+// Longueurs et distances de deflate : base de chaque code et nombre de bits supplémentaires
+static const uint16_t LENGTH_BASES[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DISTANCE_BASES[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint32_t MAX_MATCH = 258;
+static const uint32_t MAX_DISTANCE = 32768;
+
+/*
+  Écriture bit à bit, bits de poids faible d'abord (ordre de deflate)
+*/
+struct BitWriter {
+    vector<uint8_t>& out;
+    uint64_t bits = 0;
+    uint32_t count = 0;
+
+    explicit BitWriter(vector<uint8_t>& buffer) : out(buffer) {}
+
+    void Put(uint32_t value, uint32_t bitCount) {
+        bits |= (uint64_t)value << count;
+        count += bitCount;
+        while (count >= 8) {
+            out.push_back((uint8_t)bits);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void Flush() {
+        if (count > 0) {
+            out.push_back((uint8_t)bits);
+        }
+        bits = 0;
+        count = 0;
+    }
+};
+
+/*
+  Codes fixes de deflate, déjà retournés : les codes de Huffman s'écrivent bit
+  de poids fort d'abord, le reste du flux bit de poids faible d'abord
+*/
+struct FixedCodes {
+    uint16_t symbols[288];
+    uint8_t symbolBits[288];
+    uint8_t distances[30];
+
+    FixedCodes() {
+        for (uint32_t symbol = 0; symbol < 288; symbol++) {
+            uint32_t code;
+            uint32_t bits;
+            if (symbol < 144) {
+                code = 0x30 + symbol;
+                bits = 8;
+            }
+            else if (symbol < 256) {
+                code = 0x190 + symbol - 144;
+                bits = 9;
+            }
+            else if (symbol < 280) {
+                code = symbol - 256;
+                bits = 7;
+            }
+            else {
+                code = 0xC0 + symbol - 280;
+                bits = 8;
+            }
+            symbols[symbol] = (uint16_t)Reverse(code, bits);
+            symbolBits[symbol] = (uint8_t)bits;
+        }
+        for (uint32_t code = 0; code < 30; code++) {
+            distances[code] = (uint8_t)Reverse(code, 5);
+        }
+    }
+
+    static uint32_t Reverse(uint32_t code, uint32_t bits) {
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < bits; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        return reversed;
+    }
+};
+static const FixedCodes FIXED_CODES;
+
+/*
+  Écrit un symbole (octet, fin de bloc ou code de longueur)
+*/
+static void PutSymbol(BitWriter& writer, uint32_t symbol) {
+    writer.Put(FIXED_CODES.symbols[symbol], FIXED_CODES.symbolBits[symbol]);
+}
+
+/*
+  Écrit une répétition : "length" octets copiés depuis "distance" octets en arrière
+*/
+static void PutMatch(BitWriter& writer, uint32_t length, uint32_t distance) {
+    int code = 28;
+    while (LENGTH_BASES[code] > length) {
+        code--;
+    }
+    PutSymbol(writer, 257 + code);
+    writer.Put(length - LENGTH_BASES[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASES[code] > distance) {
+        code--;
+    }
+    writer.Put(FIXED_CODES.distances[code], 5);
+    writer.Put(distance - DISTANCE_BASES[code], DISTANCE_EXTRA[code]);
+}
+
+/*
+  Compresse en un bloc deflate à codes fixes. Seules deux distances sont essayées :
+  le pixel précédent et le même pixel sur la ligne du dessus ("rowDistance").
+*/
+static void Deflate(const vector<uint8_t>& data, uint32_t rowDistance, vector<uint8_t>& out) {
+    BitWriter writer(out);
+    writer.Put(1, 1);  // Dernier bloc
+    writer.Put(1, 2);  // Codes fixes
+    const uint32_t distances[2] = { 4, rowDistance <= MAX_DISTANCE ? rowDistance : 4 };
+    size_t size = data.size();
+    size_t position = 0;
+    while (position < size) {
+        uint32_t limit = (uint32_t)min((size_t)MAX_MATCH, size - position);
+        uint32_t bestLength = 0;
+        uint32_t bestDistance = 0;
+        for (uint32_t distance : distances) {
+            if (distance > position) {
+                continue;
+            }
+            const uint8_t* current = &data[position];
+            const uint8_t* source = current - distance;
+            // Comparaison par mots de 8 octets, puis octet par octet pour la fin
+            uint32_t length = 0;
+            while (length + 8 <= limit) {
+                uint64_t a;
+                uint64_t b;
+                memcpy(&a, current + length, 8);
+                memcpy(&b, source + length, 8);
+                if (a != b) {
+                    break;
+                }
+                length += 8;
+            }
+            while (length < limit && current[length] == source[length]) {
+                length++;
+            }
+            if (length > bestLength) {
+                bestLength = length;
+                bestDistance = distance;
+            }
+        }
+        if (bestLength >= 3) {
+            PutMatch(writer, bestLength, bestDistance);
+            position += bestLength;
+        }
+        else {
+            PutSymbol(writer, data[position]);
+            position++;
+        }
+    }
+    PutSymbol(writer, 256);
+    writer.Flush();
+}
+
+/*
+  Somme de contrôle Adler-32 du flux zlib
+*/
+static uint32_t Adler32(const vector<uint8_t>& data) {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    size_t position = 0;
+    while (position < data.size()) {
+        // 5552 octets au plus entre deux réductions : pas de dépassement sur 32 bits
+        size_t end = min(data.size(), position + 5552);
+        for (; position < end; position++) {
+            a += data[position];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void PutBigEndian(vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+/*
+  Termine un bloc PNG commencé à "start" (longueur et type déjà écrits) : longueur et CRC
+*/
+static void EndChunk(vector<uint8_t>& out, size_t start) {
+    uint32_t length = (uint32_t)(out.size() - start - 8);
+    out[start] = (uint8_t)(length >> 24);
+    out[start + 1] = (uint8_t)(length >> 16);
+    out[start + 2] = (uint8_t)(length >> 8);
+    out[start + 3] = (uint8_t)length;
+    PutBigEndian(out, Crc32(0, &out[start + 4], length + 4));
+}
+
+static size_t BeginChunk(vector<uint8_t>& out, const char* type) {
+    size_t start = out.size();
+    PutBigEndian(out, 0);
+    out.insert(out.end(), type, type + 4);
+    return start;
+}
+
+void EncodePng(const uint8_t* rgba, uint32_t width, uint32_t height, vector<uint8_t>& scratch, vector<uint8_t>& out) {
+    // Lignes précédées de leur filtre (0 : aucun, les répétitions suffisent)
+    uint32_t rowBytes = width * 4;
+    scratch.resize((size_t)(rowBytes + 1) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* row = &scratch[(size_t)y * (rowBytes + 1)];
+        row[0] = 0;
+        memcpy(row + 1, rgba + (size_t)y * rowBytes, rowBytes);
+    }
+
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.assign(SIGNATURE, SIGNATURE + 8);
+
+    size_t chunk = BeginChunk(out, "IHDR");
+    PutBigEndian(out, width);
+    PutBigEndian(out, height);
+    const uint8_t format[5] = { 8, 6, 0, 0, 0 };  // 8 bits par canal, RGBA, deflate, filtres standard, sans entrelacement
+    out.insert(out.end(), format, format + 5);
+    EndChunk(out, chunk);
+
+    chunk = BeginChunk(out, "IDAT");
+    out.push_back(0x78);  // En-tête zlib : deflate, fenêtre de 32 Ko
+    out.push_back(0x01);
+    Deflate(scratch, rowBytes + 1, out);
+    PutBigEndian(out, Adler32(scratch));
+    EndChunk(out, chunk);
+
+    chunk = BeginChunk(out, "IEND");
+    EndChunk(out, chunk);
+}
+
+void ConvertToYuv420(const uint8_t* rgba, uint32_t width, uint32_t height, vector<uint8_t>& out) {
+    size_t lumaSize = (size_t)width * height;
+    size_t chromaSize = lumaSize / 4;
+    out.resize(lumaSize + 2 * chromaSize);
+    uint8_t* luma = out.data();
+    uint8_t* blue = luma + lumaSize;
+    uint8_t* red = blue + chromaSize;
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* pixel = rgba + (size_t)y * width * 4;
+        for (uint32_t x = 0; x < width; x++, pixel += 4) {
+            luma[(size_t)y * width + x] = (uint8_t)(((66 * pixel[0] + 129 * pixel[1] + 25 * pixel[2] + 128) >> 8) + 16);
+        }
+    }
+    // Chrominance : moyenne de chaque carré de 2 x 2 pixels
+    for (uint32_t y = 0; y < height / 2; y++) {
+        const uint8_t* top = rgba + (size_t)(2 * y) * width * 4;
+        const uint8_t* bottom = top + (size_t)width * 4;
+        for (uint32_t x = 0; x < width / 2; x++, top += 8, bottom += 8) {
+            int r = (top[0] + top[4] + bottom[0] + bottom[4] + 2) / 4;
+            int g = (top[1] + top[5] + bottom[1] + bottom[5] + 2) / 4;
+            int b = (top[2] + top[6] + bottom[2] + bottom[6] + 2) / 4;
+            size_t index = (size_t)y * (width / 2) + x;
+            blue[index] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            red[index] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+bool FrameDumper::Open(const string& outputPath, FrameFormat frameFormat, uint32_t frameWidth, uint32_t frameHeight,
+                       uint32_t framesPerSecond, uint32_t threadCount, uint32_t capacity, uint32_t writeCapacity) {
+    Close();
+    path = outputPath;
+    format = frameFormat;
+    width = frameWidth;
+    height = frameHeight;
+    if (format == FrameFormat::Y4m) {
+        video = fopen(path.c_str(), "wb");
+        if (video == nullptr) {
+            return false;
+        }
+        fprintf(video, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", width, height, max(framesPerSecond, 1u));
+    }
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+
+    // Un tampon par image en attente et par fil : tout est alloué ici, rien pendant l'enregistrement
+    queueCapacity = max(capacity, 1u);
+    uint32_t frameCount = queueCapacity + threadCount;
+    frames.resize(frameCount);
+    freeFrames.clear();
+    for (DumpFrame& frame : frames) {
+        frame.pixels.assign((size_t)width * height * 4, 0);
+        freeFrames.push_back(&frame);
+    }
+    pending.assign(frameCount, nullptr);
+    pendingHead = 0;
+    pendingCount = 0;
+
+    // Un tampon encodé par fil d'encodage en plus de la file d'écriture. Les tampons encodés
+    // gardent leur capacité : seules les premières images les font grandir.
+    uint32_t encodedCount = max(writeCapacity, 1u) + threadCount;
+    encodedFrames.resize(encodedCount);
+    freeEncoded.clear();
+    for (EncodedFrame& encoded : encodedFrames) {
+        freeEncoded.push_back(&encoded);
+    }
+    encodedReady.clear();
+    encodedReady.reserve(encodedCount);
+    nextWrite = 0;
+    stopping = false;
+    encodersDone = false;
+    stats = FrameDumpStats();
+    stats.capacity = frameCount;
+    openedAt = chrono::steady_clock::now();
+    for (uint32_t t = 0; t < threadCount; t++) {
+        workers.emplace_back(&FrameDumper::WorkerLoop, this);
+    }
+    writer = thread(&FrameDumper::WriterLoop, this);
+    return true;
+}
+
+bool FrameDumper::Close() {
+    if (workers.empty()) {
+        return stats.errors == 0;
+    }
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    frameReady.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    {
+        lock_guard<mutex> lock(queueMutex);
+        encodersDone = true;
+    }
+    frameEncoded.notify_one();
+    writer.join();
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - openedAt).count();
+    if (video != nullptr) {
+        if (fclose(video) != 0) {
+            stats.errors++;
+        }
+        video = nullptr;
+    }
+    return stats.errors == 0;
+}
+
+DumpFrame* FrameDumper::Acquire() {
+    unique_lock<mutex> lock(queueMutex);
+    if (freeFrames.empty()) {
+        stats.waits++;
+        frameFree.wait(lock, [this] { return !freeFrames.empty(); });
+    }
+    DumpFrame* frame = freeFrames.back();
+    freeFrames.pop_back();
+    return frame;
+}
+
+void FrameDumper::Submit(DumpFrame* frame) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        frame->index = stats.submitted++;
+        pending[(pendingHead + pendingCount) % pending.size()] = frame;
+        pendingCount++;
+        stats.maxQueueDepth = max(stats.maxQueueDepth, pendingCount);
+    }
+    frameReady.notify_one();
+}
+
+void FrameDumper::WorkerLoop() {
+    // Tampon de travail propre au fil, gardé d'une image à l'autre
+    vector<uint8_t> scratch;
+    for (;;) {
+        DumpFrame* frame;
+        EncodedFrame* encoded;
+        {
+            // Image et tampon encodé pris ensemble, dans l'ordre des images : la prochaine image
+            // à écrire a toujours son tampon, le fil d'écriture ne peut pas rester bloqué
+            unique_lock<mutex> lock(queueMutex);
+            frameReady.wait(lock, [this] { return (stopping && pendingCount == 0) || (pendingCount > 0 && !freeEncoded.empty()); });
+            if (pendingCount == 0) {
+                return;
+            }
+            frame = pending[pendingHead];
+            pendingHead = (pendingHead + 1) % (uint32_t)pending.size();
+            pendingCount--;
+            encoded = freeEncoded.back();
+            freeEncoded.pop_back();
+        }
+        encoded->index = frame->index;
+        if (format == FrameFormat::Png) {
+            EncodePng(frame->pixels.data(), width, height, scratch, encoded->data);
+        }
+        else {
+            ConvertToYuv420(frame->pixels.data(), width, height, encoded->data);
+        }
+        {
+            lock_guard<mutex> lock(queueMutex);
+            freeFrames.push_back(frame);
+            encodedReady.push_back(encoded);
+            stats.maxWriteDepth = max(stats.maxWriteDepth, (uint32_t)encodedReady.size());
+        }
+        frameFree.notify_one();
+        frameEncoded.notify_one();
+    }
+}
+
+void FrameDumper::WriterLoop() {
+    for (;;) {
+        EncodedFrame* encoded = nullptr;
+        {
+            // Les images finissent d'encoder dans le désordre : elles sont écrites dans l'ordre
+            unique_lock<mutex> lock(queueMutex);
+            vector<EncodedFrame*>::iterator next;
+            frameEncoded.wait(lock, [this, &next] {
+                next = find_if(encodedReady.begin(), encodedReady.end(),
+                               [this](const EncodedFrame* frame) { return frame->index == nextWrite; });
+                return next != encodedReady.end() || (encodersDone && encodedReady.empty());
+            });
+            if (next == encodedReady.end()) {
+                return;
+            }
+            encoded = *next;
+            *next = encodedReady.back();
+            encodedReady.pop_back();
+        }
+        bool written = WriteFrame(*encoded);
+        nextWrite++;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            freeEncoded.push_back(encoded);
+            if (written) {
+                stats.written++;
+            }
+            else {
+                stats.errors++;
+            }
+        }
+        frameReady.notify_one();
+    }
+}
+
+bool FrameDumper::WriteFrame(const EncodedFrame& encoded) {
+    if (format == FrameFormat::Png) {
+        char number[32];
+        snprintf(number, sizeof(number), "%06llu.png", (unsigned long long)encoded.index);
+        FILE* file = fopen((path + number).c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool written = fwrite(encoded.data.data(), 1, encoded.data.size(), file) == encoded.data.size();
+        return fclose(file) == 0 && written;
+    }
+    return fputs("FRAME\n", video) >= 0 && fwrite(encoded.data.data(), 1, encoded.data.size(), video) == encoded.data.size();
+}
+
+FrameDumpStats FrameDumper::Stats() const {
+    lock_guard<mutex> lock(queueMutex);
+    FrameDumpStats current = stats;
+    current.queueDepth = pendingCount;
+    current.writeDepth = (uint32_t)encodedReady.size();
+    if (!workers.empty()) {
+        current.seconds = chrono::duration<double>(chrono::steady_clock::now() - openedAt).count();
+    }
+    return current;
+}
+
+string FrameDumper::Summary() const {
+    FrameDumpStats current = Stats();
+    char summary[256];
+    snprintf(summary, sizeof(summary), "%llu frames written (%.1f frames/s), queue depth %u (max %u, %u buffers), "
+             "disk queue %u (max %u), %llu waits, %llu errors",
+             (unsigned long long)current.written, current.FramesPerSecond(), current.queueDepth, current.maxQueueDepth,
+             current.capacity, current.writeDepth, current.maxWriteDepth, (unsigned long long)current.waits,
+             (unsigned long long)current.errors);
+    return summary;
+}
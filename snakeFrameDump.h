@@ -0,0 +1,168 @@
+﻿// Enregistrement des images affichées sur disque (sans dépendance à SFML)
+//
+// L'affichage copie chaque image (RGBA) dans un tampon pris dans une réserve
+// de taille fixe, puis le confie à un groupe de fils d'encodage. Chaque image
+// encodée passe dans une seconde file bornée, vidée dans l'ordre par un seul
+// fil d'écriture : l'encodage et le disque ne tournent jamais sur le fil qui
+// dessine, et un disque lent n'arrête pas l'encodage tant que cette file a de
+// la place. Si tous les tampons sont occupés, Acquire attend qu'un fil en
+// rende un : la cadence du rendu suit celle de l'encodage, et au-delà de la
+// file d'écriture celle du disque, sans que la mémoire utilisée grandisse.
+//
+// Formats :
+//   PNG  une image par fichier, "préfixe000000.png", "préfixe000001.png"...
+//        (compression deflate simple : répétitions du pixel précédent et de
+//        la ligne du dessus, suffisante pour les aplats du jeu)
+//   Y4M  une seule vidéo brute YUV 4:2:0, lisible par ffmpeg ; les images
+//        encodées en parallèle sont écrites dans l'ordre
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FrameFormat { Png, Y4m };
+
+/*
+  Une image à enregistrer
+*/
+struct DumpFrame {
+    std::vector<uint8_t> pixels;  // RGBA, ligne par ligne depuis le haut (largeur * hauteur * 4 octets)
+    uint64_t index = 0;           // Numéro de l'image dans la séquence (donné par Submit)
+};
+
+/*
+  Une image encodée (PNG ou YUV), en attente du fil d'écriture
+*/
+struct EncodedFrame {
+    std::vector<uint8_t> data;    // Contenu à écrire (garde sa capacité d'une image à l'autre)
+    uint64_t index = 0;           // Numéro de l'image encodée
+};
+
+/*
+  Compteurs de l'enregistrement
+*/
+struct FrameDumpStats {
+    uint64_t submitted = 0;       // Images confiées aux fils
+    uint64_t written = 0;         // Images écrites sur disque
+    uint64_t waits = 0;           // Images qui ont attendu un tampon libre
+    uint64_t errors = 0;          // Écritures échouées
+    uint32_t queueDepth = 0;      // Images en attente d'un fil
+    uint32_t maxQueueDepth = 0;   // Attente la plus longue observée
+    uint32_t capacity = 0;        // Tampons de la réserve
+    uint32_t writeDepth = 0;      // Images encodées en attente du disque
+    uint32_t maxWriteDepth = 0;   // Attente du disque la plus longue observée
+    double seconds = 0;           // Temps écoulé depuis l'ouverture
+
+    double FramesPerSecond() const { return seconds > 0 ? written / seconds : 0; }
+};
+
+/*
+  Encode une image RGBA en PNG
+  parametre "rgba" Pixels, ligne par ligne depuis le haut
+  parametre "width", "height" Dimensions de l'image
+  parametre "scratch" Tampon de travail (garde sa capacité d'un appel à l'autre)
+  parametre "out" Fichier PNG complet (remplacé)
+*/
+void EncodePng(const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<uint8_t>& scratch, std::vector<uint8_t>& out);
+
+/*
+  Convertit une image RGBA en YUV 4:2:0 (BT.601, plage réduite), plans Y, U puis V
+  parametre "rgba" Pixels, ligne par ligne depuis le haut
+  parametre "width", "height" Dimensions de l'image (paires)
+  parametre "out" Image YUV (largeur * hauteur * 3 / 2 octets, remplacée)
+*/
+void ConvertToYuv420(const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+
+/*
+  Réserve de tampons d'images, fils d'encodage et fil d'écriture
+*/
+class FrameDumper {
+public:
+    ~FrameDumper() { Close(); }
+
+    /*
+      Prépare la réserve de tampons, crée la vidéo (Y4M) et lance les fils
+      parametre "path" Préfixe des fichiers PNG, ou fichier Y4M
+      parametre "format" Format des images
+      parametre "width", "height" Dimensions des images (paires en Y4M)
+      parametre "framesPerSecond" Cadence inscrite dans la vidéo Y4M
+      parametre "threadCount" Nombre de fils d'encodage (0 : un par cœur)
+      parametre "queueCapacity" Images en attente au plus, en plus de celles en cours d'encodage
+      parametre "writeCapacity" Images encodées en attente du disque au plus
+      retourne false si la vidéo ne peut pas être créée
+    */
+    bool Open(const std::string& path, FrameFormat format, uint32_t width, uint32_t height, uint32_t framesPerSecond,
+              uint32_t threadCount = 0, uint32_t queueCapacity = 8, uint32_t writeCapacity = 8);
+
+    /*
+      Encode et écrit les images en attente, puis arrête les fils
+      retourne false si une écriture a échoué
+    */
+    bool Close();
+
+    bool IsOpen() const { return !workers.empty(); }
+    uint32_t Width() const { return width; }
+    uint32_t Height() const { return height; }
+
+    /*
+      Prend un tampon libre, en attendant qu'un fil en rende un si besoin
+      retourne Le tampon à remplir puis à passer à Submit
+    */
+    DumpFrame* Acquire();
+
+    /*
+      Confie un tampon rempli aux fils d'encodage (ne bloque pas)
+    */
+    void Submit(DumpFrame* frame);
+
+    /*
+      retourne Les compteurs à cet instant
+    */
+    FrameDumpStats Stats() const;
+
+    /*
+      retourne Les compteurs sur une ligne (images par seconde, attente)
+    */
+    std::string Summary() const;
+
+private:
+    void WorkerLoop();
+    void WriterLoop();
+    bool WriteFrame(const EncodedFrame& encoded);
+
+    std::string path;
+    FrameFormat format = FrameFormat::Png;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    FILE* video = nullptr;                    // Vidéo Y4M (écrite par le seul fil d'écriture)
+
+    std::vector<DumpFrame> frames;            // Réserve de tampons
+    std::vector<DumpFrame*> freeFrames;       // Tampons libres (protégé par queueMutex)
+    std::vector<DumpFrame*> pending;          // File circulaire des images à encoder
+    uint32_t pendingHead = 0;
+    uint32_t pendingCount = 0;
+    uint32_t queueCapacity = 0;
+    std::vector<EncodedFrame> encodedFrames;  // Réserve de tampons encodés
+    std::vector<EncodedFrame*> freeEncoded;   // Tampons encodés libres (protégé par queueMutex)
+    std::vector<EncodedFrame*> encodedReady;  // Images encodées en attente du disque, dans le désordre
+    uint64_t nextWrite = 0;                   // Numéro de la prochaine image à écrire (fil d'écriture)
+    bool stopping = false;
+    bool encodersDone = false;                // Les fils d'encodage sont arrêtés : le fil d'écriture vide la file
+    FrameDumpStats stats;                     // Compteurs (protégés par queueMutex, sauf "seconds")
+    std::chrono::steady_clock::time_point openedAt;
+
+    mutable std::mutex queueMutex;
+    std::condition_variable frameReady;       // Une image attend un fil, un tampon encodé s'est libéré, ou arrêt demandé
+    std::condition_variable frameFree;        // Un tampon est revenu dans la réserve
+    std::condition_variable frameEncoded;     // Une image encodée attend le fil d'écriture, ou encodage terminé
+
+    std::vector<std::thread> workers;
+    std::thread writer;
+};
@@ -0,0 +1,570 @@
+﻿// Recherche d'erreurs de la simulation par parties aléatoires, sans affichage
+//
+// Compilation : g++ -std=c++17 -O2 -pthread snakeFuzz.cpp snakeAutopilot.cpp snakeSim.cpp snakeStats.cpp -o snakeFuzz
+// Utilisation : ./snakeFuzz [--games N] [--first N] [--seed S] [--threads N] [--timeout secondes] [--fail-length N]
+//                   joue N parties (un million par défaut, à partir de la partie --first)
+//                   sur tous les cœurs et vérifie
+//                   les invariants après chaque pas ; une partie en échec est réduite
+//                   à une courte suite d'actions qui reproduit l'erreur
+//               ./snakeFuzz --replay graine LxH obstacles actions [--fail-length N]
+//                   rejoue une suite d'actions ("U", "D", "L", "R", "." pour aucune, "-" : vide)
+//
+// Chaque partie est tirée de la graine commune et de son numéro : grille de
+// 8x8 à 25x25, obstacles, et style de jeu (touches au hasard, touches hostiles
+// qui visent les demi-tours et les obstacles, ou pilote automatique dérangé
+// de temps en temps, qui remplit les petites grilles jusqu'à la dernière case).
+// Un pas qui ne rend pas la main (tirage d'une case libre sans fin, par
+// exemple) est signalé par le chien de garde au bout de --timeout secondes.
+// --fail-length traite une longueur atteinte comme une erreur : de quoi
+// vérifier la réduction sans erreur réelle dans la simulation.
+
+#include "snakeAutopilot.h"
+#include "snakeSim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/*
+  Invariant enfreint par un pas
+*/
+enum class Violation {
+    None,
+    Length,        // Longueur différente de 3 + score (moins la croissance en attente)
+    Duplicate,     // Deux segments du corps sur la même case
+    Detached,      // Deux segments consécutifs non voisins
+    Occupancy,     // Plateau des cases occupées en désaccord avec le corps ou les obstacles
+    Fruit,         // Nourriture absente en cours de partie, ou sur le serpent ou un obstacle
+    FreeCount,     // Nombre de cases libres faux
+    LengthLimit    // Longueur de --fail-length atteinte
+};
+
+static const char* VIOLATION_NAMES[] = {
+    "none", "length is not 3 + score", "duplicate body cell", "detached body",
+    "occupancy out of sync", "misplaced fruit", "wrong free cell count", "length limit reached"
+};
+
+/*
+  Style de jeu d'une partie
+*/
+enum class InputStyle { Random, Hostile, Autopilot, Count };
+
+// Parties par défaut
+static const uint64_t DEFAULT_GAMES = 1000000;
+// Pas au plus par partie, en nombre de cases de la grille (le pilote peut tourner longtemps)
+static const uint64_t TICKS_PER_CELL = 64;
+// Chance sur 1000 que le pilote automatique soit dérangé à un pas
+static const uint32_t AUTOPILOT_NOISE = 20;
+
+/*
+  Une partie à jouer : tout ce qu'il faut pour la rejouer à l'identique
+*/
+struct FuzzCase {
+    uint64_t index = 0;           // Numéro de la partie
+    uint64_t seed = 0;            // Graine de la simulation
+    GridShape grid;
+    int obstacleCount = 0;
+    InputStyle style = InputStyle::Random;
+    std::vector<SimAction> actions;  // Actions jouées, une par appel à Step
+};
+
+/*
+  Résultat d'une partie rejouée
+*/
+struct FuzzResult {
+    Violation violation = Violation::None;
+    uint64_t step = 0;            // Appel à Step (0 = premier) après lequel l'invariant a été enfreint
+    SimOutcome outcome = SimOutcome::Waiting;
+};
+
+/*
+  retourne true si deux cases sont voisines sur la grille torique
+*/
+static bool Adjacent(const GridShape& grid, Cell a, Cell b) {
+    int dx = abs(grid.CellX(a) - grid.CellX(b));
+    int dy = abs(grid.CellY(a) - grid.CellY(b));
+    dx = min(dx, grid.width - dx);
+    dy = min(dy, grid.height - dy);
+    return dx + dy == 1;
+}
+
+/*
+  Vérifie les invariants de la partie après un pas
+  parametre "state" L'état de la partie
+  parametre "outcome" Le résultat du pas
+  parametre "seen" Plateau de travail, vide à l'entrée comme à la sortie
+  parametre "failLength" Longueur traitée comme une erreur (0 : aucune)
+  retourne L'invariant enfreint, ou Violation::None
+*/
+static Violation CheckInvariants(const SimState& state, SimOutcome outcome, Bitboard& seen, uint32_t failLength) {
+    uint32_t length = state.body.Length();
+    if (length != 3 + (uint32_t)state.score - (state.shouldGrow ? 1 : 0)) {
+        return Violation::Length;
+    }
+    if (failLength != 0 && length >= failLength) {
+        return Violation::LengthLimit;
+    }
+
+    // Corps : segments distincts et voisins. Une tête entrée dans le corps termine la partie
+    // en partageant sa case avec un segment : elle est vérifiée à part.
+    Violation violation = Violation::None;
+    uint32_t first = outcome == SimOutcome::HitSelf ? 1 : 0;
+    uint32_t index = 0;
+    Cell previous = NO_CELL;
+    state.body.ForEach([&](Cell cell) {
+        if (index++ < first || violation != Violation::None) {
+            previous = cell;
+            return;
+        }
+        if (seen.Test(cell)) {
+            violation = Violation::Duplicate;
+        }
+        else if (previous != NO_CELL && !Adjacent(state.grid, previous, cell)) {
+            violation = Violation::Detached;
+        }
+        else if (!state.blockedCells.Test(cell)) {
+            violation = Violation::Occupancy;
+        }
+        seen.Set(cell);
+        previous = cell;
+    });
+    index = 0;
+    state.body.ForEach([&](Cell cell) {
+        if (index++ >= first) {
+            seen.Reset(cell);
+        }
+    });
+    if (violation != Violation::None) {
+        return violation;
+    }
+    if (first == 1 && !state.blockedCells.Test(state.body.Head())) {
+        return Violation::Detached;
+    }
+
+    for (Cell obstacle : state.obstacles) {
+        if (!state.obstacleCells.Test(obstacle) || !state.blockedCells.Test(obstacle)) {
+            return Violation::Occupancy;
+        }
+    }
+
+    // Nourriture : toujours placée tant que la partie continue, jamais sur une case occupée
+    if (state.fruitPosition == NO_CELL) {
+        return outcome == SimOutcome::BoardFull ? Violation::None : Violation::Fruit;
+    }
+    if (state.blockedCells.Test(state.fruitPosition) || state.freeCells.Contains(state.fruitPosition)) {
+        return Violation::Fruit;
+    }
+    if (!state.gameOver) {
+        uint32_t occupied = length + (uint32_t)state.obstacles.size() + 1;
+        if (state.freeCells.Count() + occupied != state.grid.CellCount()) {
+            return Violation::FreeCount;
+        }
+    }
+    return Violation::None;
+}
+
+/*
+  Tire les réglages d'une partie d'après son numéro (ses actions ne sont pas touchées)
+  parametre "inputRng" Reçoit le générateur des actions de la partie
+*/
+static void MakeCase(uint64_t seed, uint64_t index, FuzzCase& fuzzCase, uint64_t& inputRng) {
+    fuzzCase.index = index;
+    inputRng = StreamSeed(seed, (uint32_t)index) ^ (index >> 32);
+    fuzzCase.style = (InputStyle)RandomBelow(inputRng, (uint32_t)InputStyle::Count);
+    // Petites grilles surtout : elles se remplissent (nourriture sans place, fin de partie gagnée)
+    int width = MIN_GRID_SIZE + (int)RandomBelow(inputRng, 9);
+    int height = RandomBelow(inputRng, 4) == 0 ? MIN_GRID_SIZE + (int)RandomBelow(inputRng, 9) : width;
+    if (RandomBelow(inputRng, 16) == 0) {
+        width = height = DEFAULT_GRID_SIZE;
+    }
+    fuzzCase.grid = GridShape{ width, height };
+    fuzzCase.obstacleCount = RandomBelow(inputRng, 4) == 0 ? 0 : (int)RandomBelow(inputRng, 9);
+    fuzzCase.seed = NextRandom(inputRng);
+}
+
+/*
+  Choisit une action hostile : demi-tour, virage vers une case occupée, rafales de virages
+*/
+static SimAction HostileAction(const SimState& state, uint64_t& rng) {
+    SimAction current = CurrentDirection(state);
+    switch (RandomBelow(rng, 4)) {
+    case 0:
+        return OppositeAction(current);
+    case 1: {
+        // Une direction qui mène sur le corps ou un obstacle, s'il y en a une
+        static const SimAction MOVES[4] = { SimAction::Up, SimAction::Down, SimAction::Left, SimAction::Right };
+        static const int MOVE_X[4] = { 0, 0, -1, 1 };
+        static const int MOVE_Y[4] = { -1, 1, 0, 0 };
+        Cell head = state.body.Head();
+        for (int move = 0; move < 4; move++) {
+            int x = (state.grid.CellX(head) + MOVE_X[move] + state.grid.width) % state.grid.width;
+            int y = (state.grid.CellY(head) + MOVE_Y[move] + state.grid.height) % state.grid.height;
+            if (state.blockedCells.Test(state.grid.MakeCell(x, y))) {
+                return MOVES[move];
+            }
+        }
+        return SimAction::None;
+    }
+    case 2:
+        return SimAction::None;
+    default:
+        return (SimAction)(1 + RandomBelow(rng, 4));
+    }
+}
+
+/*
+  Joue une partie en tirant ses actions, et vérifie les invariants après chaque pas
+  parametre "fuzzCase" La partie (ses actions sont enregistrées au fur et à mesure)
+  parametre "inputRng" Générateur des actions (suite de MakeCase)
+  parametre "heartbeat" Compteur de pas lu par le chien de garde
+  retourne Le premier invariant enfreint
+*/
+static FuzzResult PlayCase(FuzzCase& fuzzCase, uint64_t& inputRng, SimState& state, Autopilot& autopilot, Bitboard& seen,
+                           uint32_t failLength, atomic<uint64_t>& heartbeat) {
+    FuzzResult result;
+    state.grid = fuzzCase.grid;
+    state.obstacleCount = fuzzCase.obstacleCount;
+    InitState(state, fuzzCase.seed);
+    seen.Init(state.grid.CellCount());
+    fuzzCase.actions.clear();
+    uint64_t maxSteps = TICKS_PER_CELL * state.grid.CellCount();
+    for (uint64_t step = 0; step < maxSteps && !state.gameOver; step++) {
+        SimAction action = SimAction::None;
+        switch (fuzzCase.style) {
+        case InputStyle::Random:
+            action = (SimAction)RandomBelow(inputRng, 5);
+            break;
+        case InputStyle::Hostile:
+            action = HostileAction(state, inputRng);
+            break;
+        default:
+            action = RandomBelow(inputRng, 1000) < AUTOPILOT_NOISE ? (SimAction)RandomBelow(inputRng, 5) : autopilot.Decide(state);
+            break;
+        }
+        fuzzCase.actions.push_back(action);
+        result.outcome = Step(state, action);
+        heartbeat.fetch_add(1, memory_order_relaxed);
+        result.violation = CheckInvariants(state, result.outcome, seen, failLength);
+        if (result.violation != Violation::None) {
+            result.step = step;
+            return result;
+        }
+    }
+    return result;
+}
+
+/*
+  Rejoue une suite d'actions enregistrée
+  parametre "fuzzCase" La partie
+  parametre "actions" Les actions, une par pas (la partie s'arrête à la fin de la suite)
+  retourne Le premier invariant enfreint
+*/
+static FuzzResult Replay(const FuzzCase& fuzzCase, const vector<SimAction>& actions, uint32_t failLength) {
+    FuzzResult result;
+    SimState state;
+    state.grid = fuzzCase.grid;
+    state.obstacleCount = fuzzCase.obstacleCount;
+    InitState(state, fuzzCase.seed);
+    Bitboard seen;
+    seen.Init(state.grid.CellCount());
+    for (uint64_t step = 0; step < actions.size() && !state.gameOver; step++) {
+        result.outcome = Step(state, actions[step]);
+        result.violation = CheckInvariants(state, result.outcome, seen, failLength);
+        if (result.violation != Violation::None) {
+            result.step = step;
+            return result;
+        }
+    }
+    return result;
+}
+
+/*
+  Réduit une suite d'actions qui enfreint un invariant (delta debugging) :
+  retire des tranches de plus en plus fines tant que l'erreur reste la même,
+  puis remplace chaque virage restant par "aucune action" si l'erreur demeure
+  parametre "fuzzCase" La partie
+  parametre "violation" L'invariant à reproduire
+  retourne La suite réduite
+*/
+static vector<SimAction> Minimize(const FuzzCase& fuzzCase, Violation violation, uint32_t failLength) {
+    auto fails = [&](const vector<SimAction>& actions) {
+        return Replay(fuzzCase, actions, failLength).violation == violation;
+    };
+    FuzzResult first = Replay(fuzzCase, fuzzCase.actions, failLength);
+    vector<SimAction> actions(fuzzCase.actions.begin(), fuzzCase.actions.begin() + (size_t)first.step + 1);
+
+    size_t parts = 2;
+    vector<SimAction> candidate;
+    while (actions.size() >= 2) {
+        size_t chunk = (actions.size() + parts - 1) / parts;
+        bool reduced = false;
+        for (size_t start = 0; start < actions.size(); start += chunk) {
+            candidate.assign(actions.begin(), actions.begin() + start);
+            candidate.insert(candidate.end(), actions.begin() + min(start + chunk, actions.size()), actions.end());
+            if (fails(candidate)) {
+                actions.swap(candidate);
+                parts = max<size_t>(parts - 1, 2);
+                reduced = true;
+                break;
+            }
+        }
+        if (!reduced) {
+            if (parts >= actions.size()) {
+                break;
+            }
+            parts = min(parts * 2, actions.size());
+        }
+    }
+
+    for (size_t i = 0; i < actions.size(); i++) {
+        if (actions[i] == SimAction::None) {
+            continue;
+        }
+        SimAction kept = actions[i];
+        actions[i] = SimAction::None;
+        if (!fails(actions)) {
+            actions[i] = kept;
+        }
+    }
+    // Les actions après l'erreur ne servent plus
+    actions.resize((size_t)Replay(fuzzCase, actions, failLength).step + 1);
+    return actions;
+}
+
+static const char ACTION_LETTERS[] = { '.', 'U', 'D', 'L', 'R' };
+
+/*
+  retourne La suite d'actions en lettres ("-" si elle est vide)
+*/
+static string FormatActions(const vector<SimAction>& actions) {
+    string text;
+    for (SimAction action : actions) {
+        text += ACTION_LETTERS[(int)action];
+    }
+    return text.empty() ? "-" : text;
+}
+
+/*
+  Lit une suite d'actions écrite par FormatActions
+  retourne false si une lettre est inconnue
+*/
+static bool ParseActions(const char* text, vector<SimAction>& actions) {
+    actions.clear();
+    if (strcmp(text, "-") == 0) {
+        return true;
+    }
+    for (const char* letter = text; *letter != '\0'; letter++) {
+        const char* found = (const char*)memchr(ACTION_LETTERS, *letter, sizeof(ACTION_LETTERS));
+        if (found == nullptr) {
+            return false;
+        }
+        actions.push_back((SimAction)(found - ACTION_LETTERS));
+    }
+    return true;
+}
+
+/*
+  Joue les parties sur plusieurs fils, sous la surveillance d'un chien de garde
+  retourne Code de sortie (0 : aucun invariant enfreint)
+*/
+static int Fuzz(uint64_t firstGame, uint64_t gameCount, uint64_t seed, uint32_t threadCount, uint32_t timeoutSeconds, uint32_t failLength) {
+    static const char* OUTCOME_NAMES[] = { "waiting", "moved", "ate", "hit self", "hit obstacle", "board full", "game over" };
+    const uint32_t OUTCOMES = sizeof(OUTCOME_NAMES) / sizeof(OUTCOME_NAMES[0]);
+    const uint64_t endGame = firstGame + gameCount;
+    atomic<uint64_t> nextGame{ firstGame };
+    atomic<bool> stop{ false };
+    atomic<uint64_t> outcomes[OUTCOMES] = {};
+    vector<atomic<uint64_t>> heartbeats(threadCount);
+    vector<atomic<uint64_t>> currentGames(threadCount);
+    mutex failureMutex;
+    FuzzCase failure;
+    FuzzResult failureResult;
+
+    auto worker = [&](uint32_t slot) {
+        SimState state;
+        Autopilot autopilot;
+        Bitboard seen;
+        FuzzCase fuzzCase;
+        fuzzCase.actions.reserve(4096);
+        for (uint64_t game = nextGame++; game < endGame && !stop.load(memory_order_relaxed); game = nextGame++) {
+            currentGames[slot].store(game, memory_order_relaxed);
+            uint64_t inputRng = 0;
+            MakeCase(seed, game, fuzzCase, inputRng);
+            FuzzResult result = PlayCase(fuzzCase, inputRng, state, autopilot, seen, failLength, heartbeats[slot]);
+            outcomes[(int)result.outcome].fetch_add(1, memory_order_relaxed);
+            if (result.violation != Violation::None) {
+                // La partie en échec de plus petit numéro : le même rapport quel que soit le nombre de fils
+                lock_guard<mutex> lock(failureMutex);
+                if (failureResult.violation == Violation::None || game < failure.index) {
+                    failure = fuzzCase;
+                    failureResult = result;
+                }
+                stop = true;
+            }
+        }
+        currentGames[slot].store(UINT64_MAX, memory_order_relaxed);
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        currentGames[t] = 0;
+        threads.emplace_back(worker, t);
+    }
+
+    // Chien de garde : un fil dont le compteur de pas ne bouge plus est bloqué dans un pas
+    const chrono::milliseconds poll(100);
+    vector<uint64_t> lastBeats(threadCount, 0);
+    vector<chrono::milliseconds> idle(threadCount, chrono::milliseconds(0));
+    for (;;) {
+        this_thread::sleep_for(poll);
+        bool running = false;
+        for (uint32_t t = 0; t < threadCount; t++) {
+            uint64_t game = currentGames[t].load(memory_order_relaxed);
+            if (game == UINT64_MAX) {
+                continue;
+            }
+            running = true;
+            uint64_t beat = heartbeats[t].load(memory_order_relaxed);
+            idle[t] = beat == lastBeats[t] ? idle[t] + poll : chrono::milliseconds(0);
+            lastBeats[t] = beat;
+            if (idle[t] >= chrono::seconds(timeoutSeconds)) {
+                uint64_t inputRng = 0;
+                FuzzCase stuck;
+                MakeCase(seed, game, stuck, inputRng);
+                cout << "game " << game << " (seed " << stuck.seed << ", grid " << stuck.grid.width << "x" << stuck.grid.height
+                     << ", " << stuck.obstacleCount << " obstacles): a step has not returned for " << timeoutSeconds
+                     << " s (reproduce: --seed " << seed << " --first " << game << " --games 1)" << endl;
+                quick_exit(2);
+            }
+        }
+        if (!running) {
+            break;
+        }
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    uint64_t played = min<uint64_t>(nextGame.load(), endGame) - firstGame;
+    uint64_t ticks = 0;
+    for (atomic<uint64_t>& beat : heartbeats) {
+        ticks += beat.load();
+    }
+    string summary;
+    for (uint32_t i = 0; i < OUTCOMES; i++) {
+        if (outcomes[i] != 0) {
+            summary += (summary.empty() ? "" : ", ") + string(OUTCOME_NAMES[i]) + " " + to_string(outcomes[i].load());
+        }
+    }
+    cout << "games: " << played << " on " << threadCount << " threads (last step: " << summary << ")" << endl;
+    cout << "ticks: " << ticks << " (" << (uint64_t)(ticks / seconds) << " ticks/sec)" << endl;
+    if (failureResult.violation == Violation::None) {
+        cout << "no invariant violated" << endl;
+        return 0;
+    }
+
+    vector<SimAction> minimized = Minimize(failure, failureResult.violation, failLength);
+    cout << "game " << failure.index << ": " << VIOLATION_NAMES[(int)failureResult.violation] << " after "
+         << failureResult.step + 1 << " actions" << endl;
+    cout << "minimized to " << minimized.size() << " actions: " << FormatActions(minimized) << endl;
+    cout << "reproduce: --replay " << failure.seed << " " << failure.grid.width << "x" << failure.grid.height << " "
+         << failure.obstacleCount << " " << FormatActions(minimized);
+    if (failLength != 0) {
+        cout << " --fail-length " << failLength;
+    }
+    cout << endl;
+    return 1;
+}
+
+/*
+  Rejoue une suite d'actions et affiche chaque pas
+  retourne Code de sortie (0 : aucun invariant enfreint)
+*/
+static int ReplayCommand(const FuzzCase& fuzzCase, uint32_t failLength) {
+    SimState state;
+    state.grid = fuzzCase.grid;
+    state.obstacleCount = fuzzCase.obstacleCount;
+    InitState(state, fuzzCase.seed);
+    Bitboard seen;
+    seen.Init(state.grid.CellCount());
+    for (size_t step = 0; step < fuzzCase.actions.size() && !state.gameOver; step++) {
+        SimOutcome outcome = Step(state, fuzzCase.actions[step]);
+        Violation violation = CheckInvariants(state, outcome, seen, failLength);
+        Cell head = state.body.Head();
+        cout << step + 1 << ": " << ACTION_LETTERS[(int)fuzzCase.actions[step]] << " head (" << state.grid.CellX(head) << ", "
+             << state.grid.CellY(head) << "), length " << state.body.Length() << ", score " << state.score << endl;
+        if (violation != Violation::None) {
+            cout << VIOLATION_NAMES[(int)violation] << endl;
+            return 1;
+        }
+    }
+    cout << "no invariant violated" << endl;
+    return 0;
+}
+
+/*
+  Fonction principale de l'outil
+  retourne Code de sortie
+*/
+int main(int argc, char** argv)
+{
+    uint64_t gameCount = DEFAULT_GAMES;
+    uint64_t firstGame = 0;
+    uint64_t seed = 1;
+    uint32_t threadCount = max(1u, thread::hardware_concurrency());
+    uint32_t timeoutSeconds = 10;
+    uint32_t failLength = 0;
+    FuzzCase replayCase;
+    bool replay = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            gameCount = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--first") == 0 && i + 1 < argc) {
+            firstGame = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = max(1u, (uint32_t)strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeoutSeconds = max(1u, (uint32_t)strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--fail-length") == 0 && i + 1 < argc) {
+            failLength = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 4 < argc) {
+            replay = true;
+            replayCase.seed = strtoull(argv[++i], nullptr, 10);
+            if (!ParseGridShape(argv[++i], replayCase.grid)) {
+                cerr << "bad grid size: " << argv[i] << endl;
+                return 1;
+            }
+            replayCase.obstacleCount = atoi(argv[++i]);
+            if (!ParseActions(argv[++i], replayCase.actions)) {
+                cerr << "bad action list: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else {
+            cerr << "usage: " << argv[0] << " [--games N] [--first N] [--seed S] [--threads N] [--timeout s] [--fail-length N]" << endl
+                 << "       " << argv[0] << " --replay seed WxH obstacles actions [--fail-length N]" << endl;
+            return 1;
+        }
+    }
+    if (replay) {
+        return ReplayCommand(replayCase, failLength);
+    }
+    return Fuzz(firstGame, gameCount, seed, threadCount, timeoutSeconds, failLength);
+}
@@ -1,576 +1,735 @@
 ﻿// SFML VERSION 3.0
+//
+// Compilation : g++ -std=c++17 -O2 -pthread snakeGame.cpp snakeAllocations.cpp snakeArena.cpp snakeAssets.cpp
+//               snakeAutopilot.cpp snakeFrameDump.cpp snakeInput.cpp snakeLevel.cpp snakeMappedFile.cpp
+//               snakeProfiler.cpp snakeRender.cpp snakeReplay.cpp snakeResources.cpp snakeScores.cpp snakeSim.cpp
+//               snakeStats.cpp snakeThread.cpp snakeWorkers.cpp -lsfml-graphics -lsfml-window -lsfml-system -o snakeGame
+//   mesures (--profile, --trace, touche F3) : ajouter -DSNAKE_PROFILING
+//   corps du serpent compacté (2 bits par segment) : ajouter -DSNAKE_PACKED_BODY
+//   ou, pour le jeu et tous les outils : make (voir Makefile)
+// Utilisation : ./snakeGame [--grid LxH] [--autopilot] [--level fichier.snkl] [--arena N] [...] [relecture.snkr]
+//                 les options sont décrites avec main ; Font/ et Sprites/ doivent être dans le dossier courant
 
 #include <SFML/Graphics.hpp>
 
+#include "snakeRender.h"
+#include "snakeAssets.h"
+#include "snakeFrameDump.h"
+#include "snakeInput.h"
+#include "snakeLevel.h"
+#include "snakeProfiler.h"
+#include "snakeResources.h"
+#include "snakeScores.h"
+#include "snakeSim.h"
+#include "snakeThread.h"
+
 #include <iostream>
 #include <time.h>
 #include <optional>
 #include <cstdlib>
 #include <stdlib.h>
 #include <vector>
-#include <list>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <cstring>
 using namespace std;
 
 // Constantes pour définir les dimensions du jeu
-const int TILE_SIZE = 30;                       // Taille d'une tuile en pixels
-const int GRID_SIZE = 25;                       // Nombre de tuiles dans la grille (25x25)
-const int WINDOW_SIZE = GRID_SIZE * TILE_SIZE;  // Dimension totale de la zone de jeu
+const int VIEW_CELLS = DEFAULT_GRID_SIZE;       // Cases affichées sur chaque axe (au-delà, la vue suit le serpent)
+const int WINDOW_SIZE = VIEW_CELLS * TILE_SIZE; // Dimension totale de la zone de jeu
 const int MARGIN = 50;                          // Marge autour de la zone de jeu
+const int SCREEN_SIZE = 2 * MARGIN + WINDOW_SIZE;  // Dimension de la fenêtre (en coordonnées du jeu)
 
 // Couleurs utilisées dans le jeu
-const sf::Color FOOD_COLOR = sf::Color(255, 99, 71, 255);        // Tomate pour la nourriture
-const sf::Color SNAKE_COLOR = sf::Color(50, 205, 50, 255);       // Vert lime pour le serpent
 const sf::Color BACKGROUND_COLOR = sf::Color(47, 79, 79, 255);   // Gris ardoise foncé
-const sf::Color OBSTACLES_COLOR = sf::Color(105, 105, 105, 255); // Gris foncé pour les obstacles
-
-
-// Variables globales pour le score et l'état du jeu
-int currentScore = 0;          // Score actuel du joueur
-vector<int> highScores;        // Liste des meilleurs scores
 
-bool gameStarted = false;      // Indique si le jeu a commencé
-bool isGameOver = false;       // Indique si le jeu est terminé
-
-/*
-  Vérifie si un élément est présent dans une liste
-  parametre "element" L'élément à rechercher
-  parametre "targetList" La liste dans laquelle chercher
-  retourne true si l'élément est dans la liste, false sinon
-*/
-bool isElementInList(vector<int>& element, list<vector<int>>& targetList) {
-    list<vector<int>>::iterator it;
-    for (it = targetList.begin(); it != targetList.end(); ++it)
-    {
-        if (element[0] == (*it)[0] && element[1] == (*it)[1])
-        {
-            return true;
-        }
-    }
-    return false;
-}
+// Fonds disponibles (la touche T passe au suivant)
+const AssetId BACKGROUND_THEMES[] = {
+    AssetId::BackgroundGrass,
+    AssetId::BackgroundGreen,
+    AssetId::BackgroundBlue,
+    AssetId::BackgroundBrown,
+    AssetId::BackgroundGray,
+    AssetId::BackgroundPink,
+    AssetId::BackgroundPurple,
+    AssetId::BackgroundYellow
+};
+const int THEME_COUNT = sizeof(BACKGROUND_THEMES) / sizeof(BACKGROUND_THEMES[0]);
 
-/*
-  Fonction de comparaison utilisée pour trier les scores par ordre décroissant
-  parametre "a" Premier score
-  parametre "b" Deuxième score
-  retourne true si a > b
-*/
-bool compareDescending(int a, int b) {
-    return a > b;
-}
+// Journal des parties et meilleurs scores (SCORES_PATH.log et SCORES_PATH.top)
+const char* SCORES_PATH = "snake-scores";
 
 /*
-  Classe représentant le serpent
+  Classe principale du jeu : client graphique de la simulation
 */
-class Snake {
+class Game {
 public:
-    list<vector<int>> body = { {6,10},{5,10},{4,10} };  // Corps du serpent (liste de coordonnées [x,y])
-    vector<int> moveDirection = { 1,0 };                // Direction du mouvement (initialement vers la droite)
-    bool shouldGrow = false;                            // Indique si le serpent doit grandir au prochain mouvement
-    sf::Texture snakeTexture;                           // Texture pour l'affichage du serpent
-    bool snakeTextureLoaded = false;                    // Indique si la texture a été chargée
+    SimThread sim;                      // Simulation à cadence fixe, sur son propre fil
+    BoardRenderer board;                // Affichage groupé du serpent, de la nourriture et des obstacles
+    AssetLoader& assets;                // Images, disponibles au fur et à mesure de leur chargement
+    ScoreStore scores;                  // Parties terminées et meilleurs scores, sur disque
+    string playerName;                  // Nom enregistré avec chaque partie
+    sf::RenderTexture staticLayer;      // Fond, bordure et titre, dessinés une fois
+    bool staticLayerValid = false;      // Le calque doit être recomposé (taille ou thème changé)
+    int theme = 0;                      // Fond choisi dans BACKGROUND_THEMES
+    bool autopilot = false;             // Le pilote automatique joue
+    bool forceRedraw = true;            // Redessiner même si rien n'a bougé (fenêtre réaffichée...)
+    bool freshSnapshot = false;         // Un instantané reçu a modifié la grille
+    uint64_t shownGeneration = 0;       // Partie de l'instantané affiché
+    uint64_t scoredGeneration = 0;      // Dernière partie dont le score a été enregistré
+    sf::Vector2f boardOrigin;           // Coin de la grille affichée (centrée si plus petite que la vue)
+    sf::Vector2f boardSize;             // Taille en pixels de la grille affichée
+    CachedText titleText;               // Titre du jeu
+    CachedText scoreText;               // Score actuel
+    CachedText gameOverText;            // Textes de l'écran de fin de partie
+    CachedText restartText;
+    CachedText highScoreTitle;
+    vector<CachedText> highScoreTexts;  // Un texte par meilleur score affiché
+#ifdef SNAKE_PROFILING
+    bool showProfile = false;           // Résumé des mesures affiché (touche F3)
+    CachedText profileText;             // Résumé des mesures de la dernière image
+    sf::Clock profileRefresh;           // Temps depuis la dernière mise à jour du résumé
+#endif
+
     /*
-      Constructeur du serpent
+      Constructeur du jeu (après la création de la fenêtre, s'il y en a une)
+      parametre "seed" Graine du générateur pseudo-aléatoire
+      parametre "moveInterval" Durée d'un pas de simulation
+      parametre "replayPath" Enregistrement à relire (vide : partie jouée et enregistrée)
+      parametre "grid" Dimensions de la grille d'une partie jouée (une relecture garde les siennes)
+      parametre "level" Niveau d'une partie jouée ou d'une arène (nullptr : grille vide)
+      parametre "player" Nom du joueur pour le journal des scores
+      parametre "arenaSnakes" Nombre de serpents d'une arène (0 : partie seule)
+      parametre "headless" Rendu hors écran : les pas sont joués par sim.Advance, sans fil ni horloge
+      parametre "cache" Cache des polices
+      parametre "loader" Chargement des images (lancé avant la création du jeu)
     */
-    Snake() {
-        if (!snakeTexture.loadFromFile("./Sprites/snake/corps.png")) {
-            snakeTextureLoaded = false;
+    Game(uint64_t seed, chrono::nanoseconds moveInterval, const string& replayPath, const GridShape& grid,
+         const Level* level, const string& player, uint32_t arenaSnakes, bool headless, ResourceCache& cache, AssetLoader& loader)
+        : assets(loader),
+          playerName(player),
+          titleText(cache.GetFont(FONT_PATH), 24, sf::Color::Black, { 5, 5 }),
+          scoreText(cache.GetFont(FONT_PATH), 24, sf::Color::Black, { TILE_SIZE * 21, 5 }),
+          gameOverText(cache.GetFont(FONT_PATH), 48, sf::Color::White, { WINDOW_SIZE / 2 + MARGIN, WINDOW_SIZE / 2 + MARGIN }),
+          restartText(cache.GetFont(FONT_PATH), 24, sf::Color::White, { WINDOW_SIZE / 2 + MARGIN, WINDOW_SIZE / 2 + MARGIN + 100 }),
+          highScoreTitle(cache.GetFont(FONT_PATH), 24, sf::Color::White, { WINDOW_SIZE / 2 + MARGIN - 100, MARGIN + 50 })
+#ifdef SNAKE_PROFILING
+          , profileText(cache.GetFont(FONT_PATH), 12, sf::Color::White, { MARGIN + 10, MARGIN + 10 })
+#endif
+    {
+        titleText.SetString("Snake Game");
+        gameOverText.SetString("Game Over");
+        restartText.SetString("Press SPACE to restart");
+        highScoreTitle.SetString("Top Scores:");
+        highScoreTexts.reserve(5);
+        for (int i = 0; i < 5; i++) {
+            highScoreTexts.emplace_back(cache.GetFont(FONT_PATH), 24, sf::Color::White, sf::Vector2f(WINDOW_SIZE / 2 + MARGIN - 50, MARGIN + 100 + i * 30));
         }
-        else {
-            snakeTextureLoaded = true;
+        if (!scores.Open(SCORES_PATH)) {
+            std::cout << "Error opening score log " << SCORES_PATH << ".log" << std::endl;
         }
-    }
-
-    /*
-      Dessine le serpent sur la fenêtre
-      parametre "window" La fenêtre où dessiner
-    */
-    void Draw(sf::RenderWindow& window) {
-        list<vector<int>>::iterator it;
-        for (it = body.begin(); it != body.end(); ++it)
-        {
-            int x = (*it)[0];
-            int y = (*it)[1];
-            sf::RectangleShape segment(sf::Vector2f(TILE_SIZE, TILE_SIZE));
-            if (snakeTextureLoaded) {
-                segment.setTexture(&snakeTexture);
-            } 
-            else {
-                segment.setFillColor(SNAKE_COLOR);
+        sim.SetManualStepping(headless);
+        sim.SetLevel(level);
+        if (arenaSnakes > 0) {
+            sim.StartArena(seed, moveInterval, arenaSnakes, grid);
+        }
+        else if (replayPath.empty() || !sim.StartPlayback(replayPath, moveInterval)) {
+            if (!replayPath.empty()) {
+                std::cout << "Error loading replay " << replayPath << std::endl;
             }
-            segment.setPosition(sf::Vector2f(MARGIN + x * TILE_SIZE, MARGIN + y * TILE_SIZE));
-            window.draw(segment);
+            sim.Start(seed, moveInterval, "snake-" + to_string(seed) + ".snkr", grid);
         }
+
+        GridShape shape = sim.Grid();
+        boardSize = sf::Vector2f((float)(min(shape.width, VIEW_CELLS) * TILE_SIZE), (float)(min(shape.height, VIEW_CELLS) * TILE_SIZE));
+        boardOrigin = sf::Vector2f(MARGIN + (WINDOW_SIZE - boardSize.x) / 2, MARGIN + (WINDOW_SIZE - boardSize.y) / 2);
+        board.Init(boardOrigin, sf::Vector2u(VIEW_CELLS, VIEW_CELLS));
+        board.SetLevel(sim.IsPlayback() ? nullptr : level);
+        LoadAssets();
     }
 
     /*
-      Ajuste la position pour permettre au serpent de traverser les bords de l'écran
-      parametre "position" La position à ajuster
+      Prend les images chargées depuis le dernier appel : l'atlas des tuiles est
+      refait et le calque statique recomposé (le fond du thème a pu arriver)
     */
-    void WrapPosition(vector<int>& position) {
-        if (position[0] < 0) { position[0] = GRID_SIZE - 1; }
-        else if (position[0] >= GRID_SIZE) { position[0] = 0; }
-
-        if (position[1] < 0) { position[1] = GRID_SIZE - 1; }
-        else if (position[1] >= GRID_SIZE) { position[1] = 0; }
+    void LoadAssets() {
+        bool wasComplete = assets.IsComplete();
+        if (assets.Poll()) {
+            const sf::Image* tileImages[(int)CellContent::Count] = {
+                nullptr,
+                assets.Image(AssetId::SnakeTile),
+                assets.Image(AssetId::FruitTile),
+                assets.Image(AssetId::ObstacleTile)
+            };
+            board.SetTileImages(tileImages);
+            InvalidateStaticLayer();
+            forceRedraw = true;
+        }
+        if (!wasComplete && assets.IsComplete()) {
+            std::cout << assets.Report();
+        }
     }
 
     /*
-      Affiche le score actuel sur l'écran
-      parametre "window" La fenêtre où afficher le score
+      Compose le calque statique : fond, bordure du terrain et titre.
+      Il n'est refait qu'après un redimensionnement ou un changement de thème.
+      parametre "pixelSize" Taille réelle de la cible en pixels
     */
-    void DisplayScore(sf::RenderWindow& window) {
-        sf::Font font;
-        if (!font.openFromFile("./Font/Heavitas.ttf")) {
-            std::cout << "Error loading font!" << std::endl;
+    void RebuildStaticLayer(sf::Vector2u pixelSize) {
+        if (!staticLayer.resize(pixelSize)) {
+            std::cout << "Error creating static layer!" << std::endl;
         }
+        staticLayer.setView(sf::View(sf::FloatRect(sf::Vector2f(0, 0), sf::Vector2f(SCREEN_SIZE, SCREEN_SIZE))));
+        staticLayer.clear(BACKGROUND_COLOR);
+
+        // Fond du terrain avec la texture du thème
+        sf::Texture* backgroundTexture = assets.Texture(BACKGROUND_THEMES[theme]);
+        sf::RectangleShape background(boardSize);
+        if (backgroundTexture != nullptr) {
+            backgroundTexture->setRepeated(true);
+            background.setTexture(backgroundTexture);
+            background.setTextureRect(sf::IntRect(sf::Vector2i(0, 0), sf::Vector2i(boardSize)));
+        }
+        else {
+            background.setFillColor(BACKGROUND_COLOR);
+        }
+        background.setPosition(boardOrigin);
+        staticLayer.draw(background);
 
-        sf::Text scoreText(font);
-
-        scoreText.setString("Score : " + to_string(currentScore));
-        scoreText.setCharacterSize(24);
-        scoreText.setFillColor(sf::Color::Black);
-        scoreText.setPosition({ TILE_SIZE * 21, 5 });
+        // Bordure du terrain de jeu
+        sf::RectangleShape borderOutline(boardSize);
+        borderOutline.setFillColor(sf::Color::Transparent);
+        borderOutline.setPosition(boardOrigin);
+        borderOutline.setOutlineThickness(5);
+        borderOutline.setOutlineColor(sf::Color(34, 34, 34, 255));
+        staticLayer.draw(borderOutline);
 
-        window.draw(scoreText);
+        titleText.Draw(staticLayer);
+        staticLayer.display();
+        staticLayerValid = true;
     }
 
     /*
-      Déplace le serpent dans la direction actuelle
+      Demande la recomposition du calque statique au prochain affichage
     */
-    void Move() {
-        if (gameStarted)
-        {
-            vector<int> headPosition = { body.front()[0] + moveDirection[0], body.front()[1] + moveDirection[1] };
-
-            WrapPosition(headPosition);
-
-            body.push_front(headPosition);
-
-            if (shouldGrow == true)
-            {
-                shouldGrow = false;
-            }
-            else {
-                body.pop_back();
-            }
-        }
+    void InvalidateStaticLayer() {
+        staticLayerValid = false;
     }
 
     /*
-      Réinitialise le serpent à sa position et taille initiales
+      Passe au fond suivant
     */
-    void Reset() {
-        body = { {6,10},{5,10},{4,10} };
-        moveDirection = { 1,0 };
+    void NextTheme() {
+        theme = (theme + 1) % THEME_COUNT;
+        InvalidateStaticLayer();
     }
-};
-
-/*
-  Classe représentant la nourriture pour le serpent
-*/
-
-class Fruit {
-public:
-    vector<int> position;      // Position de la nourriture [x,y]
-    sf::Texture fruitTexture;  // Texture pour l'affichage de la nourriture
-    bool fruitTextureLoaded = false;  // Indique si la texture a été chargée
 
     /*
-      Constructeur de la nourriture
-      parametre "snakeBody" Corps du serpent pour éviter de placer la nourriture sur le serpent
+      Active ou coupe le pilote automatique (touche P)
     */
-    Fruit(list<vector<int>>& snakeBody) {
-        if (!fruitTexture.loadFromFile("./sprites/fruites/Strawberry.png")) {
-            fruitTextureLoaded = false;
-        }
-        else {
-            fruitTextureLoaded = true;
-        }
-        position = GenerateRandomPosition(snakeBody);
+    void ToggleAutopilot() {
+        autopilot = !autopilot;
+        sim.SetAutopilot(autopilot);
     }
 
     /*
-      Dessine la nourriture sur la fenêtre
-      parametre "window" La fenêtre où dessiner
+      Récupère le dernier instantané de la simulation et met la grille à jour.
+      Le score d'une partie terminée est enregistré une seule fois.
     */
-    void Draw(sf::RenderWindow& window) {
-        sf::RectangleShape fruitShape{ sf::Vector2f(TILE_SIZE, TILE_SIZE) };
-        if (fruitTextureLoaded) {
-            fruitShape.setTexture(&fruitTexture);
+    void Update() {
+        if (!assets.IsComplete()) {
+            LoadAssets();
         }
-        else {
-            fruitShape.setFillColor(FOOD_COLOR);
+        if (!sim.Acquire()) {
+            return;
         }
-        fruitShape.setPosition(sf::Vector2f(MARGIN + position[0] * TILE_SIZE, MARGIN + position[1] * TILE_SIZE));
-        window.draw(fruitShape);
-    }
-
-    /*
-      Génère une position aléatoire sur la grille
-      retourne Coordonnées [x,y] d'une position aléatoire
-    */
-    vector<int> GetRandomTile() {
-        int x = rand() % GRID_SIZE;
-        int y = rand() % GRID_SIZE;
-        return { x, y };
-    }
-
-    /*
-      Génère une position aléatoire qui n'est pas sur le corps du serpent
-      parametre "snakeBody" Corps du serpent à éviter
-      retourne Position aléatoire valide [x,y]
-    */
-    vector<int> GenerateRandomPosition(list<vector<int>>& snakeBody) {
-        vector<int> newPosition = GetRandomTile();
-        while (isElementInList(newPosition, snakeBody))
-        {
-            newPosition = GetRandomTile();
+        const SimSnapshot& snapshot = sim.Latest();
+        if (!snapshot.changes.empty() || snapshot.generation != shownGeneration) {
+            freshSnapshot = true;
+            shownGeneration = snapshot.generation;
+        }
+        board.Apply(snapshot);
+        if (snapshot.gameOver && snapshot.generation != scoredGeneration && !sim.IsPlayback()) {
+            RecordScore(snapshot);
+            scoredGeneration = snapshot.generation;
         }
-        return newPosition;
     }
-};
-
-/*
-  Classe représentant les obstacles dans le jeu
-*/
-class Obstacles {
-public:
-    vector<int> position1;                 // Position du premier obstacle [x,y]
-    vector<int> position2;                 // Position du deuxième obstacle [x,y]
-    sf::Texture obstacleTexture;           // Texture pour l'affichage des obstacles
-    bool obstacleTextureLoaded = false;   // Indique si la texture a été chargée
 
     /*
-      Constructeur des obstacles
-      parametre "snakeBody" Corps du serpent pour éviter de placer des obstacles sur le serpent
-      parametre "fruitPosition" Position de la nourriture pour éviter de placer des obstacles sur la nourriture
+      Avancement entre le pas affiché et le suivant, pour l'interpolation
+      retourne Une valeur de 0 (pas affiché) à 1 (pas suivant attendu)
     */
-    Obstacles(list<vector<int>>& snakeBody, vector<int> fruitPosition) {
-        if (!obstacleTexture.loadFromFile("./sprites/obstacle/obstacle.png")) {
-            obstacleTextureLoaded = false;
-        }
-        else {
-            obstacleTextureLoaded = true;
+    float Alpha() const {
+        const SimSnapshot& snapshot = sim.Latest();
+        if (!snapshot.started || snapshot.gameOver) {
+            return 1.0f;
         }
-        position1 = GenerateRandomPosition(snakeBody, fruitPosition);
-        position2 = GenerateRandomPosition(snakeBody, fruitPosition);
+        chrono::duration<float> elapsed = InputClock::now() - snapshot.tickTime;
+        chrono::duration<float> interval = sim.TickInterval();
+        return min(elapsed / interval, 1.0f);
     }
 
     /*
-      Dessine les obstacles sur la fenêtre
-      parametre "window" La fenêtre où dessiner
+      retourne Le temps restant avant le prochain pas attendu (au moins 1 ms)
     */
-    void Draw(sf::RenderWindow& window) {
-        sf::RectangleShape obstacleShape{ sf::Vector2f(TILE_SIZE, TILE_SIZE) };
-        if (obstacleTextureLoaded) {
-            obstacleShape.setTexture(&obstacleTexture);
-        }
-        else {
-            obstacleShape.setFillColor(OBSTACLES_COLOR);
-        }
-        obstacleShape.setPosition(sf::Vector2f(MARGIN + position1[0] * TILE_SIZE, MARGIN + position1[1] * TILE_SIZE));
-        window.draw(obstacleShape);
-
-        obstacleShape.setTexture(&obstacleTexture);
-        obstacleShape.setPosition(sf::Vector2f(MARGIN + position2[0] * TILE_SIZE, MARGIN + position2[1] * TILE_SIZE));
-        window.draw(obstacleShape);
+    sf::Time TimeUntilNextTick() const {
+        InputClock::duration remaining = sim.Latest().tickTime + sim.TickInterval() - InputClock::now();
+        // (un délai nul signifierait une attente sans fin pour SFML)
+        return max(sf::microseconds(chrono::duration_cast<chrono::microseconds>(remaining).count()), sf::milliseconds(1));
     }
 
     /*
-      Génère une position aléatoire sur la grille
-      retourne Coordonnées [x,y] d'une position aléatoire
+      Indique si l'image affichée est périmée : un instantané a modifié des cases,
+      la tête et la queue sont en cours d'interpolation, le calque statique doit être
+      refait ou des images sont encore en chargement (elles sont prises à chaque image)
     */
-    vector<int> GetRandomTile() {
-        int x = rand() % GRID_SIZE;
-        int y = rand() % GRID_SIZE;
-        return { x, y };
+    bool NeedsRedraw() const {
+        return forceRedraw || !staticLayerValid || freshSnapshot || Alpha() < 1.0f || !assets.IsComplete();
     }
 
     /*
-      Génère une position aléatoire qui n'est pas sur le corps du serpent ni sur la nourriture
-      parametre "snakeBody" Corps du serpent à éviter
-      parametre "fruitPosition" Position de la nourriture à éviter
-      retourne Position aléatoire valide [x,y]
+      Dessine le calque statique en un seul appel
+      parametre "target" La cible où dessiner (fenêtre ou image hors écran)
     */
-    vector<int> GenerateRandomPosition(list<vector<int>> snakeBody, vector<int> fruitPosition) {
-        vector<int> newPosition = GetRandomTile();
-        while (isElementInList(newPosition, snakeBody) || (newPosition[0] == fruitPosition[0] && newPosition[1] == fruitPosition[1]))
-        {
-            newPosition = GetRandomTile();
+    void DrawStaticLayer(sf::RenderTarget& target) {
+        if (!staticLayerValid) {
+            RebuildStaticLayer(target.getSize());
         }
-        return newPosition;
+        PROFILE_SCOPE("static_layer");
+        sf::Sprite layer(staticLayer.getTexture());
+        layer.setScale(sf::Vector2f((float)SCREEN_SIZE / staticLayer.getSize().x, (float)SCREEN_SIZE / staticLayer.getSize().y));
+        target.draw(layer);
+        PROFILE_DRAW_CALL();
     }
-};
-
-/*
-  Classe principale du jeu qui gère toutes les interactions
-*/
-class Game {
-public:
-    Snake snake = Snake();                           // Instance du serpent
-    Fruit fruit = Fruit(snake.body);                 // Instance de la nourriture
-    Obstacles obstacles = Obstacles(snake.body, fruit.position);  // Instance des obstacles
 
     /*
-      Dessine tous les éléments du jeu
-      parametre "window" La fenêtre où dessiner
+      Dessine tous les éléments du jeu en un seul appel
+      parametre "target" La cible où dessiner (fenêtre ou image hors écran)
+      parametre "alpha" Avancement vers le pas suivant (voir Alpha)
     */
-    void Draw(sf::RenderWindow& window) {
-        fruit.Draw(window);
-        obstacles.Draw(window);
-        snake.Draw(window);
+    void Draw(sf::RenderTarget& target, float alpha) {
+        PROFILE_SCOPE("board");
+        board.Interpolate(sim.Latest(), alpha);
+        board.Draw(target);
+        forceRedraw = false;
+        freshSnapshot = false;
     }
 
     /*
-      Vérifie si le serpent a mangé la nourriture
+      Affiche le score actuel sur l'écran
+      parametre "target" La cible où afficher le score
     */
-    void CheckFoodCollision() {
-        if (snake.body.front()[0] == fruit.position[0] && snake.body.front()[1] == fruit.position[1])
-        {
-            fruit.position = fruit.GenerateRandomPosition(snake.body);
-            obstacles.position1 = obstacles.GenerateRandomPosition(snake.body, fruit.position);
-            obstacles.position2 = obstacles.GenerateRandomPosition(snake.body, fruit.position);
-            snake.shouldGrow = true;
-            currentScore++;
-        }
+    void DisplayScore(sf::RenderTarget& target) {
+        scoreText.SetNumber("Score : ", sim.Latest().score);
+        scoreText.Draw(target);
     }
 
     /*
-      Met à jour la liste des meilleurs scores
-      parametre "scoreList" Liste des scores à mettre à jour
-      parametre "newScore" Nouveau score à ajouter
+      Ajoute une partie terminée au journal des scores (le classement est mis à jour avec)
+      parametre "snapshot" Le dernier instantané de la partie
     */
-    void UpdateHighScores(vector<int>& scoreList, int newScore) {
-        if (find(scoreList.begin(), scoreList.end(), newScore) == scoreList.end()) {
-            scoreList.push_back(newScore);
-
-            sort(scoreList.begin(), scoreList.end(), compareDescending);
-            if (scoreList.size() > 5) {
-                scoreList.pop_back();
-            }
+    void RecordScore(const SimSnapshot& snapshot) {
+        ScoreRecord record;
+        record.seed = snapshot.gameSeed;
+        record.time = (int64_t)time(NULL);
+        record.score = snapshot.score;
+        record.length = (uint32_t)snapshot.body.size();
+        record.ticks = (uint32_t)snapshot.tick;
+        record.durationMs = (uint32_t)(snapshot.tick * chrono::duration_cast<chrono::milliseconds>(sim.TickInterval()).count());
+        SetPlayerName(record, autopilot ? "autopilot" : playerName);
+        if (scores.IsOpen() && !scores.Add(record)) {
+            std::cout << "Error writing score log" << std::endl;
         }
     }
 
     /*
       Affiche les meilleurs scores sur l'écran de fin de partie
-      parametre "window" La fenêtre où afficher les scores
-      parametre "scoreList" Liste des meilleurs scores
+      parametre "target" La cible où afficher les scores
     */
-    void DisplayTopScores(sf::RenderWindow& window, vector<int>& scoreList) {
-        sf::Font font;
-        if (!font.openFromFile("./Font/Heavitas.ttf")) {
-            std::cout << "Error loading font!" << std::endl;
-        }
-        if (isGameOver) {
-            sf::RectangleShape gameOverScreen(sf::Vector2f(WINDOW_SIZE, WINDOW_SIZE));
+    void DisplayTopScores(sf::RenderTarget& target) {
+        if (sim.Latest().gameOver) {
+            sf::RectangleShape gameOverScreen(boardSize);
             gameOverScreen.setFillColor(sf::Color(0, 0, 0, 150));
-            gameOverScreen.setPosition(sf::Vector2f(MARGIN, MARGIN));
-            window.draw(gameOverScreen);
-
-            sf::Text gameOverText(font);
-            gameOverText.setString("Game Over");
-            gameOverText.setCharacterSize(48);
-            gameOverText.setFillColor(sf::Color::White);
-            gameOverText.setPosition({ WINDOW_SIZE / 2 + MARGIN, WINDOW_SIZE / 2 + MARGIN });
-            window.draw(gameOverText);
-
-            sf::Text restartText(font);
-            restartText.setString("Press SPACE to restart");
-            restartText.setCharacterSize(24);
-            restartText.setFillColor(sf::Color::White);
-            restartText.setPosition({ WINDOW_SIZE / 2 + MARGIN, WINDOW_SIZE / 2 + MARGIN + 100 });
-            window.draw(restartText);
-
-            sf::Text highScoreTitle(font);
-            highScoreTitle.setString("Top Scores:");
-            highScoreTitle.setCharacterSize(24);
-            highScoreTitle.setFillColor(sf::Color::White);
-            highScoreTitle.setPosition({ WINDOW_SIZE / 2 + MARGIN - 100, MARGIN + 50 });
-            window.draw(highScoreTitle);
-
-            for (int i = 0; i < scoreList.size() && i < 5; i++) {
-                sf::Text scoreText(font);
-                scoreText.setString(to_string(scoreList[i]));
-                scoreText.setCharacterSize(24);
-                scoreText.setFillColor(sf::Color::White);
-                scoreText.setPosition(sf::Vector2f(WINDOW_SIZE / 2 + MARGIN - 50, MARGIN + 100 + i * 30));
-                window.draw(scoreText);
+            gameOverScreen.setPosition(boardOrigin);
+            target.draw(gameOverScreen);
+            PROFILE_DRAW_CALL();
+
+            gameOverText.Draw(target);
+            restartText.Draw(target);
+            highScoreTitle.Draw(target);
+
+            for (uint32_t i = 0; i < scores.TopCount() && i < 5; i++) {
+                highScoreTexts[i].SetNumber("", scores.Top(i).score);
+                highScoreTexts[i].Draw(target);
             }
         }
     }
 
+#ifdef SNAKE_PROFILING
     /*
-      Marque le jeu comme terminé et enregistre le score
-      parametre "window" La fenêtre du jeu
+      Affiche ou masque le résumé des mesures (touche F3)
     */
-    void SetGameOver(sf::RenderWindow& window) {
-        if (!isGameOver) {
-            isGameOver = true;
-            UpdateHighScores(highScores, currentScore);
-        }
+    void ToggleProfile() {
+        showProfile = !showProfile;
+        forceRedraw = true;
     }
 
     /*
-      Redémarre le jeu lorsque la touche espace est pressée à la fin d'une partie
+      Affiche le résumé des mesures sur un fond sombre. Le texte n'est refait que
+      quatre fois par seconde : sa mise en page ne pèse pas sur chaque image.
+      parametre "target" La cible où afficher le résumé
     */
-    void RestartGame() {
-        if (isGameOver && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space))
-        {
-            snake.Reset();
-            fruit.position = fruit.GenerateRandomPosition(snake.body);
-            obstacles.position1 = obstacles.GenerateRandomPosition(snake.body, fruit.position);
-            obstacles.position2 = obstacles.GenerateRandomPosition(snake.body, fruit.position);
-            gameStarted = false;
-            currentScore = 0;
-            isGameOver = false;
+    void DisplayProfile(sf::RenderTarget& target) {
+        if (!showProfile) {
+            return;
+        }
+        if (profileRefresh.getElapsedTime() >= sf::milliseconds(250)) {
+            profileText.SetString(ProfileSummary());
+            profileRefresh.restart();
         }
+        sf::FloatRect bounds = profileText.Bounds();
+        sf::RectangleShape panel(bounds.size + sf::Vector2f(10, 10));
+        panel.setPosition(bounds.position - sf::Vector2f(5, 5));
+        panel.setFillColor(sf::Color(0, 0, 0, 180));
+        target.draw(panel);
+        PROFILE_DRAW_CALL();
+        profileText.Draw(target);
     }
+#endif
 
     /*
-      Vérifie si le serpent est entré en collision avec lui-même
-      parametre "window" La fenêtre du jeu
+      Redémarre le jeu si la partie est terminée (touche espace)
     */
-    void CheckSelfCollision(sf::RenderWindow& window) {
-        if (!isGameOver) {
-            list<vector<int>> bodyWithoutHead = snake.body;
-            bodyWithoutHead.pop_front();
-            if (isElementInList(snake.body.front(), bodyWithoutHead)) {
-                SetGameOver(window);
+    void RestartGame() {
+        sim.RequestRestart();
+    }
+};
+
+/*
+  Rendu sans fenêtre : chaque pas est dessiné dans une image hors écran, copiée
+  dans un tampon de l'enregistrement puis encodée et écrite par ses fils. La
+  simulation avance au rythme du rendu et non de l'horloge : les images sont
+  les mêmes quelle que soit la vitesse de la machine.
+  parametre "game" Le jeu, créé avec la simulation à la demande
+  parametre "dumper" Enregistrement ouvert, aux dimensions de l'image
+  parametre "framesPerTick" Images par pas (la tête et la queue sont interpolées entre deux pas)
+  parametre "frameLimit" Nombre d'images au plus (0 : jusqu'à la fin de la partie, jamais atteinte dans une arène)
+  retourne Code de sortie
+*/
+static int RenderHeadless(Game& game, FrameDumper& dumper, uint32_t framesPerTick, uint64_t frameLimit)
+{
+    sf::RenderTexture target;
+    if (!target.resize(sf::Vector2u(dumper.Width(), dumper.Height()))) {
+        std::cout << "Error creating offscreen target!" << std::endl;
+        return 1;
+    }
+    target.setView(sf::View(sf::FloatRect(sf::Vector2f(0, 0), sf::Vector2f(SCREEN_SIZE, SCREEN_SIZE))));
+
+    uint64_t frames = 0;
+    sf::Clock progress;
+    bool finished = false;
+    while (!finished) {
+        game.sim.Advance();
+        game.Update();
+        finished = game.sim.Latest().gameOver && !game.sim.IsArena();
+        for (uint32_t k = 1; k <= framesPerTick; k++) {
+            PROFILE_BEGIN_FRAME();
+            target.clear(BACKGROUND_COLOR);
+            game.DrawStaticLayer(target);
+            game.Draw(target, (float)k / framesPerTick);
+            game.DisplayScore(target);
+            game.DisplayTopScores(target);
+            target.display();
+            {
+                // Seule copie faite sur ce fil : l'encodage et l'écriture sont sur ceux de l'enregistrement
+                PROFILE_SCOPE("capture");
+                sf::Image image = target.getTexture().copyToImage();
+                DumpFrame* frame = dumper.Acquire();
+                memcpy(frame->pixels.data(), image.getPixelsPtr(), frame->pixels.size());
+                dumper.Submit(frame);
             }
+            PROFILE_END_FRAME();
+            if (++frames == frameLimit) {
+                finished = true;
+                break;
+            }
+        }
+        if (progress.getElapsedTime() >= sf::seconds(1)) {
+            cout << "Frames: " << dumper.Summary() << endl;
+            progress.restart();
         }
     }
-};
+
+    bool written = dumper.Close();
+    cout << "Frames: " << dumper.Summary() << endl;
+    return written ? 0 : 1;
+}
 
 /*
   Fonction principale du programme
+  parametre "argv" Facultatifs : "--grid LxH" (taille de la grille), "--autopilot" (le pilote
+                   automatique joue dès le départ), "--profile" (résumé des mesures affiché),
+                   "--trace fichier.json" (trace des mesures écrite en fin de session),
+                   "--player nom" (nom enregistré avec les scores), "--arena N" (arène de N serpents
+                   dont N - 1 robots, grille agrandie selon N sauf avec --grid), "--level fichier.snkl"
+                   (niveau : grille, murs, départs et nourriture ; les parties ne sont pas enregistrées),
+                   "--dump chemin" (rendu sans fenêtre enregistré en PNG, "chemin000000.png"...,
+                   ou en vidéo Y4M si le chemin finit par .y4m ; le pilote automatique joue
+                   sauf en relecture), "--frames N" (images enregistrées au plus), "--frames-per-tick N"
+                   (images par pas, 4 par défaut), "--encoders N" (fils d'encodage, un par cœur par défaut)
+                   et un enregistrement (.snkr) à relire. Les mesures demandent -DSNAKE_PROFILING.
   retourne Code de sortie
 */
-int main()
+int main(int argc, char** argv)
 {
-    srand(time(NULL));  // Initialisation du générateur de nombres aléatoires
-
     cout << "***** Game started *****" << endl;
+    PROFILE_THREAD("main");
+
+    // Images décodées en parallèle pendant la lecture des options et la création de la fenêtre
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    AssetLoader assets;
+    assets.Start();
+
+    chrono::milliseconds moveInterval(200);       // Intervalle entre les mouvements du serpent
+
+    // Création de l'instance du jeu (la graine remplace srand(time(NULL)))
+    string replayPath;
+    GridShape grid;
+    bool gridChosen = false;
+    Level level;
+    uint32_t arenaSnakes = 0;
+    bool autopilot = false;
+    bool showProfile = false;
+    string dumpPath;
+    uint64_t frameLimit = 0;
+    uint32_t framesPerTick = 4;
+    uint32_t encoders = 0;
+    const char* user = getenv("USER") != nullptr ? getenv("USER") : getenv("USERNAME");
+    string player = user != nullptr ? user : "player";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            gridChosen = ParseGridShape(argv[++i], grid);
+            if (!gridChosen) {
+                cout << "Invalid grid size " << argv[i] << ", using " << grid.width << "x" << grid.height << endl;
+            }
+        }
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            if (!level.Open(argv[++i])) {
+                cout << "Error loading level " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--arena") == 0 && i + 1 < argc) {
+            arenaSnakes = min((uint32_t)strtoul(argv[++i], nullptr, 10), ARENA_MAX_SNAKES);
+        }
+        else if (strcmp(argv[i], "--autopilot") == 0) {
+            autopilot = true;
+        }
+        else if (strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            player = argv[++i];
+        }
+        else if (strcmp(argv[i], "--profile") == 0) {
+            showProfile = true;
+        }
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frameLimit = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--frames-per-tick") == 0 && i + 1 < argc) {
+            framesPerTick = max((uint32_t)strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if (strcmp(argv[i], "--encoders") == 0 && i + 1 < argc) {
+            encoders = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+#ifdef SNAKE_PROFILING
+            ProfileStartTrace(argv[++i]);
+#else
+            i++;
+            cout << "Tracing unavailable (build with -DSNAKE_PROFILING)" << endl;
+#endif
+        }
+        else {
+            replayPath = argv[i];
+        }
+    }
+    const Level* playLevel = level.IsOpen() ? &level : nullptr;
+    // Arène : une tête pour 64 cases, comme snakeBench
+    if (arenaSnakes > 0 && !gridChosen) {
+        int side = min(max((int)sqrt((double)arenaSnakes * 64), MIN_GRID_SIZE), MAX_GRID_SIZE);
+        grid = GridShape{ side, side };
+    }
 
-    sf::Clock gameClock;                          // Horloge pour mesurer le temps
-    sf::Time moveInterval = sf::seconds(0.2f);    // Intervalle entre les mouvements du serpent
-    sf::Time timeSinceLastMove;                   // Temps écoulé depuis le dernier mouvement
+    // Polices : chargées une fois, aucune lecture de fichier pendant la boucle
+    ResourceCache resources;
 
-    // Création de la fenêtre du jeu
-    sf::RenderWindow window(sf::VideoMode(sf::Vector2u(2 * MARGIN + WINDOW_SIZE, 2 * MARGIN + WINDOW_SIZE)), "Snake Game");
-    window.setFramerateLimit(60);  // Limite la cadence à 60 FPS
-
-    // Chargement et configuration de la texture d'arrière-plan
-    sf::Texture backgroundTexture;
-    bool backgroundTextureLoaded = backgroundTexture.loadFromFile("./sprites/background/Grass.png");
-    if (backgroundTextureLoaded) {
-        backgroundTexture.setRepeated(true);
+    // Enregistrement d'images : rendu hors écran, sans fenêtre ni joueur
+    if (!dumpPath.empty()) {
+        if (arenaSnakes > 0 && frameLimit == 0) {
+            cout << "An arena never ends: --dump needs --frames" << endl;
+            return 1;
+        }
+        Game game((uint64_t)time(NULL), moveInterval, replayPath, grid, playLevel, player, arenaSnakes, true, resources, assets);
+        // Toutes les images avant la première : l'enregistrement ne dépend pas de la vitesse du disque
+        assets.Wait();
+        game.LoadAssets();
+        if (autopilot || !game.sim.IsPlayback()) {
+            game.ToggleAutopilot();
+        }
+        bool video = dumpPath.size() > 4 && dumpPath.compare(dumpPath.size() - 4, 4, ".y4m") == 0;
+        uint32_t framesPerSecond = (uint32_t)(framesPerTick * chrono::seconds(1) / moveInterval);
+        FrameDumper dumper;
+        if (!dumper.Open(dumpPath, video ? FrameFormat::Y4m : FrameFormat::Png, SCREEN_SIZE, SCREEN_SIZE,
+                         framesPerSecond, encoders)) {
+            cout << "Error creating " << dumpPath << endl;
+            return 1;
+        }
+        int status = RenderHeadless(game, dumper, framesPerTick, frameLimit);
+        game.sim.Stop();
+#ifdef SNAKE_PROFILING
+        if (ProfileWriteTrace()) {
+            cout << "Trace written" << endl;
+        }
+#endif
+        return status;
     }
 
-    // Création du fond avec la texture 
-    sf::RectangleShape background(sf::Vector2f(WINDOW_SIZE, WINDOW_SIZE));
-    if (backgroundTextureLoaded) {
-        background.setTexture(&backgroundTexture);
-        background.setTextureRect(sf::IntRect(sf::Vector2i(0, 0), sf::Vector2i(WINDOW_SIZE, WINDOW_SIZE)));
+    // Création de la fenêtre du jeu
+    sf::RenderWindow window(sf::VideoMode(sf::Vector2u(SCREEN_SIZE, SCREEN_SIZE)), "Snake Game");
+    window.setVerticalSyncEnabled(true);  // Une image par rafraîchissement de l'écran (60, 144 Hz...)
+    window.setKeyRepeatEnabled(false);  // Une touche maintenue ne compte que pour un virage
+
+    Game game((uint64_t)time(NULL), moveInterval, replayPath, grid, playLevel, player, arenaSnakes, false, resources, assets);
+    if (autopilot) {
+        game.ToggleAutopilot();
     }
-    else {
-        background.setFillColor(BACKGROUND_COLOR);
+#ifdef SNAKE_PROFILING
+    if (showProfile) {
+        game.ToggleProfile();
     }
-    background.setPosition(sf::Vector2f(MARGIN, MARGIN));
-
+#else
+    if (showProfile) {
+        cout << "Profiling unavailable (build with -DSNAKE_PROFILING)" << endl;
+    }
+#endif
 
-    // Création de l'instance du jeu
-    Game game = Game();
+    // Traitement d'un événement de la fenêtre
+    auto handleEvent = [&](const sf::Event& event) {
+        if (event.is<sf::Event::Closed>()) {
+            window.close();
+        }
+        else if (event.is<sf::Event::Resized>()) {
+            game.InvalidateStaticLayer();
+        }
+        else if (event.is<sf::Event::FocusGained>()) {
+            game.forceRedraw = true;
+        }
+        else if (const sf::Event::KeyPressed* key = event.getIf<sf::Event::KeyPressed>()) {
+            // Gestion des entrées clavier pour diriger le serpent
+            switch (key->code) {
+            case sf::Keyboard::Key::Left:
+            case sf::Keyboard::Key::A:
+                game.sim.PushTurn(SimAction::Left, InputClock::now());
+                break;
+            case sf::Keyboard::Key::Right:
+            case sf::Keyboard::Key::D:
+                game.sim.PushTurn(SimAction::Right, InputClock::now());
+                break;
+            case sf::Keyboard::Key::Up:
+            case sf::Keyboard::Key::W:
+                game.sim.PushTurn(SimAction::Up, InputClock::now());
+                break;
+            case sf::Keyboard::Key::Down:
+            case sf::Keyboard::Key::S:
+                game.sim.PushTurn(SimAction::Down, InputClock::now());
+                break;
+            case sf::Keyboard::Key::Space:
+                game.RestartGame();
+                break;
+            case sf::Keyboard::Key::T:
+                game.NextTheme();
+                break;
+            case sf::Keyboard::Key::P:
+                game.ToggleAutopilot();
+                break;
+#ifdef SNAKE_PROFILING
+            case sf::Keyboard::Key::F3:
+                game.ToggleProfile();
+                break;
+#endif
+            default:
+                break;
+            }
+        }
+    };
 
     // Boucle principale du jeu
+    bool firstFrameShown = false;
     while (window.isOpen())
     {
+        PROFILE_BEGIN_FRAME();
+
         // Gestion des événements
-        while (const optional event = window.pollEvent())
         {
-            if (event->is<sf::Event::Closed>())
-                window.close();
+            PROFILE_SCOPE("events");
+            while (const optional event = window.pollEvent())
+            {
+                handleEvent(*event);
+            }
         }
 
-        // Effacement de l'écran et dessin du fond
-        window.clear(sf::Color(BACKGROUND_COLOR));
-        window.draw(background);
-
-        // Dessin de la bordure du terrain de jeu
-        sf::RectangleShape borderOutline(sf::Vector2f(WINDOW_SIZE, WINDOW_SIZE));
-        borderOutline.setFillColor(sf::Color::Transparent);
-        borderOutline.setPosition(sf::Vector2f(MARGIN, MARGIN));
-        borderOutline.setOutlineThickness(5);
-        borderOutline.setOutlineColor(sf::Color(34, 34, 34, 255));
-        window.draw(borderOutline);
-
-        // Dessin des éléments du jeu
-        game.Draw(window);
-
-        // Chargement de la police et affichage du titre
-        sf::Font font;
-        if (!font.openFromFile("./Font/Heavitas.ttf")) {
-            std::cout << "Error loading font!" << std::endl;
+        // Dernier état publié par le fil de simulation
+        {
+            PROFILE_SCOPE("update");
+            game.Update();
         }
 
-        sf::Text titleText(font);
-        titleText.setString("Snake Game");
-        titleText.setCharacterSize(24);
-        titleText.setFillColor(sf::Color::Black);
-        titleText.setPosition({ 5, 5 });
-        window.draw(titleText);
-
-        // Affichage du score actuel
-        game.snake.DisplayScore(window);
-
-        // Affichage des meilleurs scores si le jeu est terminé
-        game.DisplayTopScores(window, highScores);
-
-        // Mise à jour de la position du serpent à intervalle régulier
-        timeSinceLastMove += gameClock.restart();
-        if (timeSinceLastMove >= moveInterval) {
-            if (!isGameOver) {
-                game.snake.Move();
-                game.CheckFoodCollision();
-                game.CheckSelfCollision(window);
+        // Rien n'a bougé : on attend le prochain pas ou un événement au lieu de redessiner
+        if (!game.NeedsRedraw()) {
+            if (const optional event = window.waitEvent(game.TimeUntilNextTick())) {
+                handleEvent(*event);
             }
-            timeSinceLastMove -= moveInterval;
+            continue;
         }
 
-        // Gestion du redémarrage du jeu
-        game.RestartGame();
+        // Calque statique (fond, bordure, titre) puis éléments du jeu
+        window.clear(sf::Color(BACKGROUND_COLOR));
+        game.DrawStaticLayer(window);
+        game.Draw(window, game.Alpha());
 
-        // Gestion des entrées clavier pour diriger le serpent
-        if (!isGameOver)
+        // Affichage du score actuel et des meilleurs scores si le jeu est terminé
         {
-            if ((sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) && game.snake.moveDirection[0] != 1) {
-                game.snake.moveDirection = { -1, 0 };
-                gameStarted = true;
-            }
-
-            if ((sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) && game.snake.moveDirection[0] != -1) {
-                game.snake.moveDirection = { 1, 0 };
-                gameStarted = true;
-            }
-            if ((sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) && game.snake.moveDirection[1] != 1) {
-                game.snake.moveDirection = { 0, -1 };
-                gameStarted = true;
-            }
-            if ((sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) && game.snake.moveDirection[1] != -1) {
-                game.snake.moveDirection = { 0, 1 };
-                gameStarted = true;
-            }
+            PROFILE_SCOPE("text");
+            game.DisplayScore(window);
+            game.DisplayTopScores(window);
         }
+#ifdef SNAKE_PROFILING
+        game.DisplayProfile(window);
+#endif
 
-        // Vérification de la collision avec les obstacles
-        if (!isGameOver &&
-            (game.snake.body.front() == game.obstacles.position1 ||
-                game.snake.body.front() == game.obstacles.position2)) {
-            game.SetGameOver(window);
+        // Affichage de tous les éléments dessinés
+        {
+            PROFILE_SCOPE("display");
+            window.display();
+        }
+        if (!firstFrameShown) {
+            firstFrameShown = true;
+            cout << "First frame after " << chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count()
+                 << " ms" << endl;
         }
+        PROFILE_END_FRAME();
+    }
 
-        // Affichage de tous les éléments dessinés
-        window.display();
+    game.sim.Stop();
+    cout << "Input latency: " << game.sim.inputLatency.Summary() << endl;
+#ifdef SNAKE_PROFILING
+    cout << "Frame time: " << ProfileFrameTimes().Summary() << endl;
+    if (ProfileWriteTrace()) {
+        cout << "Trace written" << endl;
     }
-}
\ No newline at end of file
+#endif
+}
@@ -0,0 +1,30 @@
+﻿#include "snakeInput.h"
+
+bool InputQueue::Push(SimAction action, SimAction currentDirection, InputClock::time_point pressedAt, uint32_t sequence) {
+    if (action == SimAction::None || count == CAPACITY) {
+        return false;
+    }
+
+    // Direction qu'aura le serpent quand ce virage sera appliqué
+    SimAction reference = count > 0 ? items[(first + count - 1) % CAPACITY].action : currentDirection;
+    if (reference != SimAction::None && (action == reference || action == OppositeAction(reference))) {
+        return false;
+    }
+
+    TurnRequest& request = items[(first + count) % CAPACITY];
+    request.action = action;
+    request.pressedAt = pressedAt;
+    request.sequence = sequence;
+    count++;
+    return true;
+}
+
+bool InputQueue::Pop(TurnRequest& request) {
+    if (count == 0) {
+        return false;
+    }
+    request = items[first];
+    first = (first + 1) % CAPACITY;
+    count--;
+    return true;
+}
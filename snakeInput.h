@@ -0,0 +1,56 @@
+﻿// File des virages demandés par le joueur (sans dépendance à SFML)
+//
+// Les touches sont lues depuis les événements clavier et rangées dans une
+// petite file bornée ; la simulation en consomme un virage par pas, ce qui
+// évite de perdre deux virages rapides faits dans le même intervalle.
+
+#pragma once
+
+#include "snakeSim.h"
+
+#include <chrono>
+
+typedef std::chrono::steady_clock InputClock;
+
+/*
+  Virage demandé et instant où la touche a été pressée
+*/
+struct TurnRequest {
+    SimAction action = SimAction::None;
+    InputClock::time_point pressedAt;
+    uint32_t sequence = 0;  // Numéro donné par un client du serveur (0 : touche locale)
+};
+
+/*
+  File bornée des virages en attente
+*/
+class InputQueue {
+public:
+    static const int CAPACITY = 4;  // Au-delà, les touches sont ignorées
+
+    /*
+      Ajoute un virage s'il a un sens après les virages déjà en attente :
+      une direction identique ou opposée à la précédente est ignorée.
+      parametre "action" Direction demandée
+      parametre "currentDirection" Direction actuelle du serpent (None : tout est accepté)
+      parametre "pressedAt" Instant de l'appui
+      parametre "sequence" Numéro du virage, rendu par Pop (serveur : accusé de réception)
+      retourne true si le virage a été ajouté
+    */
+    bool Push(SimAction action, SimAction currentDirection, InputClock::time_point pressedAt, uint32_t sequence = 0);
+
+    /*
+      Retire le plus ancien virage
+      parametre "request" Reçoit le virage retiré
+      retourne false si la file est vide
+    */
+    bool Pop(TurnRequest& request);
+
+    void Clear() { first = 0; count = 0; }
+    int Count() const { return count; }
+
+private:
+    TurnRequest items[CAPACITY];  // Tampon circulaire
+    int first = 0;                // Plus ancien virage
+    int count = 0;                // Nombre de virages en attente
+};
@@ -0,0 +1,279 @@
+﻿#include "snakeLevel.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+static const char LEVEL_MAGIC[4] = { 'S', 'N', 'K', 'L' };
+static const uint16_t LEVEL_VERSION = 1;
+
+// En-tête du niveau
+struct LevelHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t randomObstacles;    // Obstacles replacés au hasard à chaque nourriture
+    uint32_t spawnCount;
+    uint32_t fruitCount;
+    uint32_t reserved;
+    uint64_t chunkTableOffset;   // Table des blocs (un décalage par bloc)
+    uint64_t spawnsOffset;
+    uint64_t fruitsOffset;
+    uint64_t reserved2;
+};
+static_assert(sizeof(LevelHeader) == 64, "en-tête de 64 octets");
+static_assert(sizeof(LevelSpawn) == 8 && sizeof(LevelFruit) == 4, "tables sans remplissage");
+
+// Taille d'un bloc dans le fichier
+static const uint64_t CHUNK_BYTES = LEVEL_CHUNK_SIZE * sizeof(uint64_t);
+
+/*
+  retourne true si la zone [offset, offset + size) tient dans le fichier
+*/
+static bool InFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+/*
+  retourne true si la direction est un déplacement (Up, Down, Left, Right)
+*/
+static bool IsDirection(uint8_t direction) {
+    return direction >= (uint8_t)SimAction::Up && direction <= (uint8_t)SimAction::Right;
+}
+
+bool Level::Open(const string& path) {
+    Close();
+    if (!file.Open(path, false)) {
+        return false;
+    }
+    uint64_t size = file.Size();
+    const LevelHeader* candidate = (const LevelHeader*)file.Data();
+    if (size < sizeof(LevelHeader) || memcmp(candidate->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 ||
+        candidate->version != LEVEL_VERSION || candidate->headerSize != sizeof(LevelHeader) ||
+        candidate->width < (uint32_t)MIN_GRID_SIZE || candidate->width > (uint32_t)MAX_GRID_SIZE ||
+        candidate->height < (uint32_t)MIN_GRID_SIZE || candidate->height > (uint32_t)MAX_GRID_SIZE ||
+        candidate->spawnCount == 0) {
+        file.Close();
+        return false;
+    }
+    grid.width = (int)candidate->width;
+    grid.height = (int)candidate->height;
+    chunkColumns = (candidate->width + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+    chunkRows = (candidate->height + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+
+    // Tables : alignées sur leur type et entièrement dans le fichier
+    uint64_t chunkCount = ChunkCount();
+    if (candidate->chunkTableOffset % sizeof(uint64_t) != 0 || candidate->spawnsOffset % sizeof(uint32_t) != 0 ||
+        candidate->fruitsOffset % sizeof(uint16_t) != 0 ||
+        !InFile(candidate->chunkTableOffset, chunkCount * sizeof(uint64_t), size) ||
+        !InFile(candidate->spawnsOffset, (uint64_t)candidate->spawnCount * sizeof(LevelSpawn), size) ||
+        !InFile(candidate->fruitsOffset, (uint64_t)candidate->fruitCount * sizeof(LevelFruit), size)) {
+        file.Close();
+        return false;
+    }
+    chunkTable = (const uint64_t*)(file.Data() + candidate->chunkTableOffset);
+    spawns = (const LevelSpawn*)(file.Data() + candidate->spawnsOffset);
+    spawnCount = candidate->spawnCount;
+    fruits = (const LevelFruit*)(file.Data() + candidate->fruitsOffset);
+    fruitCount = candidate->fruitCount;
+
+    bool valid = true;
+    for (uint64_t chunk = 0; chunk < chunkCount && valid; chunk++) {
+        uint64_t offset = chunkTable[chunk];
+        valid = offset == 0 || (offset % sizeof(uint64_t) == 0 && offset >= sizeof(LevelHeader) && InFile(offset, CHUNK_BYTES, size));
+    }
+    for (uint32_t i = 0; i < spawnCount && valid; i++) {
+        valid = spawns[i].x < candidate->width && spawns[i].y < candidate->height && IsDirection(spawns[i].direction);
+    }
+    for (uint32_t i = 0; i < fruitCount && valid; i++) {
+        valid = fruits[i].x < candidate->width && fruits[i].y < candidate->height;
+    }
+    // Blocs du bord droit et du bas : aucun mur hors de la grille (ForEachWall ne filtre pas)
+    for (uint32_t chunk = 0; chunk < chunkCount && valid; chunk++) {
+        const uint64_t* rows = ChunkRowsOf(chunk);
+        int left = (int)(chunk % chunkColumns) * LEVEL_CHUNK_SIZE;
+        int top = (int)(chunk / chunkColumns) * LEVEL_CHUNK_SIZE;
+        if (rows == nullptr || (left + LEVEL_CHUNK_SIZE <= grid.width && top + LEVEL_CHUNK_SIZE <= grid.height)) {
+            continue;
+        }
+        int columns = min(LEVEL_CHUNK_SIZE, grid.width - left);
+        uint64_t outside = columns == LEVEL_CHUNK_SIZE ? 0 : ~(((uint64_t)1 << columns) - 1);
+        for (int row = 0; row < LEVEL_CHUNK_SIZE && valid; row++) {
+            valid = (rows[row] & (top + row < grid.height ? outside : ~(uint64_t)0)) == 0;
+        }
+    }
+    if (!valid) {
+        Close();
+        return false;
+    }
+    header = candidate;
+    randomObstacles = candidate->randomObstacles;
+    return true;
+}
+
+void Level::Close() {
+    file.Close();
+    header = nullptr;
+    chunkTable = nullptr;
+    spawns = nullptr;
+    fruits = nullptr;
+    spawnCount = 0;
+    fruitCount = 0;
+    randomObstacles = 0;
+    chunkColumns = 0;
+    chunkRows = 0;
+}
+
+uint64_t Level::CountWalls() const {
+    uint64_t count = 0;
+    for (uint32_t chunk = 0; chunk < ChunkCount(); chunk++) {
+        const uint64_t* rows = ChunkRowsOf(chunk);
+        for (int row = 0; rows != nullptr && row < LEVEL_CHUNK_SIZE; row++) {
+            for (uint64_t bits = rows[row]; bits != 0; bits &= bits - 1) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/*
+  Ajoute des octets à la fin d'un tampon
+*/
+static void Append(vector<uint8_t>& out, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+/*
+  Complète un tampon par des zéros jusqu'à un multiple de "alignment"
+*/
+static void Pad(vector<uint8_t>& out, size_t alignment) {
+    out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+bool WriteLevel(const string& path, const LevelDescription& description) {
+    const GridShape& grid = description.grid;
+    uint32_t chunkColumns = (uint32_t)(grid.width + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+    uint32_t chunkRows = (uint32_t)(grid.height + LEVEL_CHUNK_SIZE - 1) / LEVEL_CHUNK_SIZE;
+    uint32_t chunkCount = chunkColumns * chunkRows;
+
+    LevelHeader header = {};
+    memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.version = LEVEL_VERSION;
+    header.headerSize = sizeof(LevelHeader);
+    header.width = (uint32_t)grid.width;
+    header.height = (uint32_t)grid.height;
+    header.randomObstacles = description.randomObstacles;
+    header.spawnCount = (uint32_t)description.spawns.size();
+    header.fruitCount = (uint32_t)description.fruits.size();
+
+    // Tables d'abord (la table des blocs est remplie ensuite), blocs à la fin
+    vector<uint8_t> out(sizeof(LevelHeader), 0);
+    header.chunkTableOffset = out.size();
+    out.resize(out.size() + chunkCount * sizeof(uint64_t), 0);
+    header.spawnsOffset = out.size();
+    Append(out, description.spawns.data(), description.spawns.size() * sizeof(LevelSpawn));
+    header.fruitsOffset = out.size();
+    Append(out, description.fruits.data(), description.fruits.size() * sizeof(LevelFruit));
+    Pad(out, sizeof(uint64_t));
+    memcpy(out.data(), &header, sizeof(header));
+
+    uint64_t rows[LEVEL_CHUNK_SIZE];
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+        int left = (int)(chunk % chunkColumns) * LEVEL_CHUNK_SIZE;
+        int top = (int)(chunk / chunkColumns) * LEVEL_CHUNK_SIZE;
+        bool any = false;
+        for (int row = 0; row < LEVEL_CHUNK_SIZE; row++) {
+            rows[row] = 0;
+            for (int column = 0; column < LEVEL_CHUNK_SIZE && top + row < grid.height && left + column < grid.width; column++) {
+                if (description.walls.Test(grid.MakeCell(left + column, top + row))) {
+                    rows[row] |= (uint64_t)1 << column;
+                }
+            }
+            any |= rows[row] != 0;
+        }
+        if (any) {
+            uint64_t offset = out.size();
+            memcpy(out.data() + header.chunkTableOffset + chunk * sizeof(uint64_t), &offset, sizeof(offset));
+            Append(out, rows, sizeof(rows));
+        }
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    return fclose(file) == 0 && written;
+}
+
+bool ParseLevelText(const string& text, LevelDescription& description, string& error) {
+    // Lignes de la carte, sans les commentaires ni les réglages
+    vector<string> rows;
+    description.randomObstacles = 2;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == string::npos) {
+            end = text.size();
+        }
+        string line = text.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] == ';') {
+            continue;
+        }
+        if (line.compare(0, 10, "obstacles ") == 0) {
+            description.randomObstacles = (uint32_t)strtoul(line.c_str() + 10, nullptr, 10);
+            continue;
+        }
+        rows.push_back(line);
+    }
+    while (!rows.empty() && rows.back().empty()) {
+        rows.pop_back();
+    }
+
+    size_t width = 0;
+    for (const string& row : rows) {
+        width = max(width, row.size());
+    }
+    if (width < (size_t)MIN_GRID_SIZE || width > (size_t)MAX_GRID_SIZE ||
+        rows.size() < (size_t)MIN_GRID_SIZE || rows.size() > (size_t)MAX_GRID_SIZE) {
+        error = "map must be between " + to_string(MIN_GRID_SIZE) + " and " + to_string(MAX_GRID_SIZE) + " cells on each side";
+        return false;
+    }
+
+    description.grid.width = (int)width;
+    description.grid.height = (int)rows.size();
+    description.walls.Init(description.grid.CellCount());
+    description.spawns.clear();
+    description.fruits.clear();
+    for (size_t y = 0; y < rows.size(); y++) {
+        for (size_t x = 0; x < rows[y].size(); x++) {
+            SimAction direction = SimAction::None;
+            switch (rows[y][x]) {
+            case '#': description.walls.Set(description.grid.MakeCell((int)x, (int)y)); break;
+            case 'F': description.fruits.push_back({ (uint16_t)x, (uint16_t)y }); break;
+            case 'S': case '>': direction = SimAction::Right; break;
+            case '<': direction = SimAction::Left; break;
+            case '^': direction = SimAction::Up; break;
+            case 'v': direction = SimAction::Down; break;
+            default: break;
+            }
+            if (direction != SimAction::None) {
+                description.spawns.push_back({ (uint16_t)x, (uint16_t)y, (uint8_t)direction, { 0, 0, 0 } });
+            }
+        }
+    }
+    if (description.spawns.empty()) {
+        error = "map has no spawn point ('S', '>', '<', '^' or 'v')";
+        return false;
+    }
+    return true;
+}
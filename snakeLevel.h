@@ -0,0 +1,196 @@
+﻿// Niveaux : dimensions, murs, points de départ et table de nourriture (sans dépendance à SFML)
+//
+// La lecture d'un niveau ouvert est entièrement dans cet en-tête : la simulation
+// s'en sert sans dépendre de snakeLevel.cpp (seul Open en a besoin).
+//
+// Un niveau est un fichier .snkl lu directement dans sa projection en mémoire :
+// l'ouverture ne vérifie que l'en-tête et les tables, sans rien décoder, quelle
+// que soit la taille de la carte. Les murs sont rangés par blocs de 64x64 cases
+// (un mot de 64 bits par ligne du bloc) ; un bloc sans mur n'occupe rien dans le
+// fichier. La simulation pose les murs d'un bloc dans ses plateaux quand le
+// serpent en approche (voir SimState::level), l'arène les pose tous au départ.
+//
+// Format (ordre des octets de la machine, petit-boutiste sur les cibles du jeu) :
+//   en-tête (64 octets) : "SNKL", version, dimensions, obstacles tirés au hasard,
+//                         nombre de départs et de nourritures, position des tables
+//   table des blocs     : un décalage (64 bits) par bloc, ligne par ligne, 0 : aucun mur
+//   départs             : x, y (16 bits), direction (SimAction), 3 octets réservés
+//   nourritures         : x, y (16 bits), dans l'ordre où elles apparaissent
+//   blocs               : 64 mots de 64 bits, bit x du mot y = case (x, y) du bloc
+//
+// Carte texte (outil snakeLevelTool) : une ligne par rangée de la grille,
+//   '#' mur, 'F' nourriture (dans l'ordre de lecture), '>' '<' '^' 'v' départ
+//   et sa direction ('S' : vers la droite), tout autre caractère case vide.
+//   Les lignes qui commencent par ';' sont des commentaires ; une ligne
+//   "obstacles N" donne le nombre d'obstacles tirés au hasard (2 par défaut).
+
+#pragma once
+
+#include "snakeMappedFile.h"
+#include "snakeSim.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Côté d'un bloc de murs : une ligne de bloc tient dans un mot de 64 bits
+const int LEVEL_CHUNK_SIZE = 64;
+
+struct LevelHeader;
+
+/*
+  Point de départ du serpent
+*/
+struct LevelSpawn {
+    uint16_t x;
+    uint16_t y;
+    uint8_t direction;    // SimAction (Up, Down, Left, Right)
+    uint8_t reserved[3];
+};
+
+/*
+  Position d'une nourriture de la table
+*/
+struct LevelFruit {
+    uint16_t x;
+    uint16_t y;
+};
+
+/*
+  Niveau à écrire (outil de conversion, génération)
+*/
+struct LevelDescription {
+    GridShape grid;
+    Bitboard walls;                   // Une case par bit (dimensionné par grid.CellCount())
+    std::vector<LevelSpawn> spawns;
+    std::vector<LevelFruit> fruits;
+    uint32_t randomObstacles = 2;     // Obstacles replacés au hasard à chaque nourriture
+};
+
+/*
+  Lit une carte texte
+  parametre "text" Contenu de la carte
+  parametre "description" Reçoit le niveau
+  parametre "error" Reçoit la raison d'un échec
+  retourne false si la carte n'est pas valide (dimensions hors limites, aucun départ...)
+*/
+bool ParseLevelText(const std::string& text, LevelDescription& description, std::string& error);
+
+/*
+  Écrit un niveau au format .snkl
+  parametre "path" Fichier à créer (remplacé)
+  parametre "description" Le niveau
+  retourne false si le fichier ne peut pas être écrit
+*/
+bool WriteLevel(const std::string& path, const LevelDescription& description);
+
+/*
+  Niveau projeté en mémoire, lu sans étape de décodage
+*/
+class Level {
+public:
+    /*
+      Projette un niveau et vérifie son en-tête et ses tables
+      parametre "path" Fichier .snkl
+      retourne false si le fichier ne peut pas être lu ou n'est pas un niveau valide
+    */
+    bool Open(const std::string& path);
+
+    void Close();
+
+    bool IsOpen() const { return header != nullptr; }
+    const GridShape& Grid() const { return grid; }
+    uint32_t RandomObstacles() const { return randomObstacles; }
+
+    uint32_t ChunkColumns() const { return chunkColumns; }
+    uint32_t ChunkRows() const { return chunkRows; }
+    uint32_t ChunkCount() const { return chunkColumns * chunkRows; }
+
+    /*
+      retourne Le numéro du bloc qui contient une case
+    */
+    uint32_t ChunkOf(Cell cell) const {
+        return (uint32_t)(grid.CellY(cell) / LEVEL_CHUNK_SIZE) * chunkColumns + (uint32_t)(grid.CellX(cell) / LEVEL_CHUNK_SIZE);
+    }
+
+    /*
+      retourne Le numéro du bloc de coordonnées (colonne, rangée), la grille étant torique
+    */
+    uint32_t ChunkAt(int column, int row) const {
+        column = (column % (int)chunkColumns + (int)chunkColumns) % (int)chunkColumns;
+        row = (row % (int)chunkRows + (int)chunkRows) % (int)chunkRows;
+        return (uint32_t)row * chunkColumns + (uint32_t)column;
+    }
+
+    bool ChunkHasWalls(uint32_t chunk) const { return chunkTable[chunk] != 0; }
+
+    /*
+      retourne true si la case est un mur (lecture directe dans la projection)
+    */
+    bool IsWall(Cell cell) const {
+        const uint64_t* rows = ChunkRowsOf(ChunkOf(cell));
+        return rows != nullptr && (rows[grid.CellY(cell) % LEVEL_CHUNK_SIZE] >> (grid.CellX(cell) % LEVEL_CHUNK_SIZE) & 1) != 0;
+    }
+
+    /*
+      Appelle "visit" pour chaque mur d'un bloc, ligne par ligne
+      parametre "chunk" Numéro du bloc
+      parametre "visit" Fonction appelée avec la case du mur
+    */
+    template <class Visit>
+    void ForEachWall(uint32_t chunk, Visit&& visit) const {
+        const uint64_t* rows = ChunkRowsOf(chunk);
+        if (rows == nullptr) {
+            return;
+        }
+        int left = (int)(chunk % chunkColumns) * LEVEL_CHUNK_SIZE;
+        int top = (int)(chunk / chunkColumns) * LEVEL_CHUNK_SIZE;
+        for (int row = 0; row < LEVEL_CHUNK_SIZE; row++) {
+            for (uint64_t bits = rows[row]; bits != 0; bits &= bits - 1) {
+                visit(grid.MakeCell(left + CountTrailingZeros(bits), top + row));
+            }
+        }
+    }
+
+    uint32_t SpawnCount() const { return spawnCount; }
+    const LevelSpawn& Spawn(uint32_t index) const { return spawns[index]; }
+    uint32_t FruitCount() const { return fruitCount; }
+    Cell Fruit(uint32_t index) const { return grid.MakeCell(fruits[index].x, fruits[index].y); }
+
+    /*
+      retourne Le nombre de murs (parcourt tous les blocs)
+    */
+    uint64_t CountWalls() const;
+
+private:
+    /*
+      retourne Les 64 lignes d'un bloc, ou nullptr s'il n'a aucun mur
+    */
+    const uint64_t* ChunkRowsOf(uint32_t chunk) const {
+        return chunkTable[chunk] != 0 ? (const uint64_t*)(file.Data() + chunkTable[chunk]) : nullptr;
+    }
+
+    static int CountTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(bits);
+#else
+        int count = 0;
+        for (; (bits & 1) == 0; bits >>= 1) {
+            count++;
+        }
+        return count;
+#endif
+    }
+
+    MappedFile file;
+    const LevelHeader* header = nullptr;
+    GridShape grid;
+    uint32_t chunkColumns = 0;
+    uint32_t chunkRows = 0;
+    const uint64_t* chunkTable = nullptr;  // Décalage de chaque bloc dans le fichier
+    const LevelSpawn* spawns = nullptr;
+    uint32_t spawnCount = 0;
+    const LevelFruit* fruits = nullptr;
+    uint32_t fruitCount = 0;
+    uint32_t randomObstacles = 0;
+};
@@ -0,0 +1,216 @@
+﻿// Création et vérification des niveaux (.snkl), sans affichage
+//
+// Compilation : g++ -std=c++17 -O2 snakeLevelTool.cpp snakeAutopilot.cpp snakeLevel.cpp snakeMappedFile.cpp
+//               snakeSim.cpp snakeStats.cpp -o snakeLevelTool
+// Utilisation : ./snakeLevelTool carte.txt niveau.snkl               convertit une carte texte (voir snakeLevel.h)
+//               ./snakeLevelTool --maze LxH graine niveau.snkl       génère des salles de 32x32 cases reliées par des portes
+//               ./snakeLevelTool --info niveau.snkl                  ouvre le niveau et affiche son contenu
+//               ./snakeLevelTool --play niveau.snkl parties          fait jouer le pilote automatique et vérifie
+//                                                                    que rien n'apparaît sur un mur
+
+#include "snakeAutopilot.h"
+#include "snakeLevel.h"
+#include "snakeSim.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+// Côté des salles du labyrinthe, murs compris
+static const int ROOM_SIZE = 32;
+// Largeur des portes entre deux salles
+static const int DOOR_SIZE = 4;
+// Entrées de la table de nourriture d'un labyrinthe
+static const uint32_t MAZE_FRUITS = 1024;
+
+/*
+  Convertit une carte texte en niveau
+  parametre "textPath" Carte texte
+  parametre "path" Niveau à créer
+  retourne Code de sortie
+*/
+static int Convert(const char* textPath, const char* path) {
+    ifstream input(textPath, ios::binary);
+    if (!input) {
+        cerr << "cannot read " << textPath << endl;
+        return 1;
+    }
+    stringstream text;
+    text << input.rdbuf();
+    LevelDescription description;
+    string error;
+    if (!ParseLevelText(text.str(), description, error)) {
+        cerr << textPath << ": " << error << endl;
+        return 1;
+    }
+    if (!WriteLevel(path, description)) {
+        cerr << "cannot create " << path << endl;
+        return 1;
+    }
+    cout << path << ": " << description.grid.width << "x" << description.grid.height << ", "
+         << description.spawns.size() << " spawns, " << description.fruits.size() << " fruits" << endl;
+    return 0;
+}
+
+/*
+  Génère un labyrinthe de salles : murs sur les bords de chaque salle, une porte
+  tirée au hasard dans chaque côté, un départ au centre de chaque salle
+  parametre "grid" Dimensions de la grille
+  parametre "seed" Graine du générateur
+  parametre "path" Niveau à créer
+  retourne Code de sortie
+*/
+static int Maze(const GridShape& grid, uint64_t seed, const char* path) {
+    LevelDescription description;
+    description.grid = grid;
+    description.walls.Init(grid.CellCount());
+    uint64_t rng = seed;
+    for (int top = 0; top < grid.height; top += ROOM_SIZE) {
+        for (int left = 0; left < grid.width; left += ROOM_SIZE) {
+            int width = min(ROOM_SIZE, grid.width - left);
+            int height = min(ROOM_SIZE, grid.height - top);
+            if (width <= DOOR_SIZE + 2 || height <= DOOR_SIZE + 2) {
+                continue;
+            }
+            // Mur du haut et mur de gauche ; les salles voisines ferment les deux autres côtés
+            int door = 1 + (int)RandomBelow(rng, (uint32_t)(width - DOOR_SIZE - 1));
+            for (int x = 0; x < width; x++) {
+                if (x < door || x >= door + DOOR_SIZE) {
+                    description.walls.Set(grid.MakeCell(left + x, top));
+                }
+            }
+            door = 1 + (int)RandomBelow(rng, (uint32_t)(height - DOOR_SIZE - 1));
+            for (int y = 0; y < height; y++) {
+                if (y < door || y >= door + DOOR_SIZE) {
+                    description.walls.Set(grid.MakeCell(left, top + y));
+                }
+            }
+            description.spawns.push_back({ (uint16_t)(left + width / 2), (uint16_t)(top + height / 2), (uint8_t)SimAction::Right, { 0, 0, 0 } });
+        }
+    }
+    if (description.spawns.empty()) {
+        cerr << "grid too small for a room" << endl;
+        return 1;
+    }
+    while (description.fruits.size() < MAZE_FRUITS) {
+        Cell cell = RandomBelow(rng, grid.CellCount());
+        if (!description.walls.Test(cell)) {
+            description.fruits.push_back({ (uint16_t)grid.CellX(cell), (uint16_t)grid.CellY(cell) });
+        }
+    }
+    description.randomObstacles = 0;
+    if (!WriteLevel(path, description)) {
+        cerr << "cannot create " << path << endl;
+        return 1;
+    }
+    cout << path << ": " << grid.width << "x" << grid.height << ", " << description.spawns.size() << " rooms" << endl;
+    return 0;
+}
+
+/*
+  Ouvre un niveau et affiche son contenu
+  parametre "path" Niveau
+  retourne Code de sortie
+*/
+static int Info(const char* path) {
+    Level level;
+    auto start = chrono::steady_clock::now();
+    if (!level.Open(path)) {
+        cerr << path << ": not a valid level" << endl;
+        return 1;
+    }
+    double openMicroseconds = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    uint32_t wallChunks = 0;
+    for (uint32_t chunk = 0; chunk < level.ChunkCount(); chunk++) {
+        wallChunks += level.ChunkHasWalls(chunk) ? 1 : 0;
+    }
+    cout << path << ": " << level.Grid().width << "x" << level.Grid().height << ", opened in " << openMicroseconds << " us" << endl;
+    cout << "chunks: " << level.ChunkCount() << " (" << wallChunks << " with walls)" << endl;
+    cout << "walls: " << level.CountWalls() << endl;
+    cout << "spawns: " << level.SpawnCount() << ", fruits: " << level.FruitCount()
+         << ", random obstacles: " << level.RandomObstacles() << endl;
+    return 0;
+}
+
+/*
+  Fait jouer le pilote automatique sur un niveau ; la tête ne doit entrer dans
+  un mur que pour perdre, et ni la nourriture ni les obstacles ne doivent y apparaître
+  parametre "path" Niveau
+  parametre "gameCount" Nombre de parties
+  retourne Code de sortie
+*/
+static int Play(const char* path, uint32_t gameCount) {
+    Level level;
+    if (!level.Open(path)) {
+        cerr << path << ": not a valid level" << endl;
+        return 1;
+    }
+    SimState state;
+    state.level = &level;
+    InitState(state, 42);
+    Autopilot autopilot;
+    uint64_t stallTicks = 4 * (uint64_t)state.grid.CellCount();
+    uint64_t lastFruitTick = 0;
+    uint64_t totalTicks = 0;
+    uint64_t fruits = 0;
+    uint32_t errors = 0;
+    auto start = chrono::steady_clock::now();
+    for (uint32_t game = 0; game < gameCount; ) {
+        SimOutcome outcome = Step(state, autopilot.Decide(state));
+        if (outcome == SimOutcome::AteFruit) {
+            lastFruitTick = state.tick;
+            fruits++;
+        }
+        bool misplaced = (state.fruitPosition != NO_CELL && level.IsWall(state.fruitPosition)) ||
+                         (outcome != SimOutcome::HitObstacle && level.IsWall(state.body.Head()));
+        for (Cell obstacle : state.obstacles) {
+            misplaced |= level.IsWall(obstacle);
+        }
+        if (misplaced) {
+            cerr << "game " << game << ", tick " << state.tick << ": item on a wall" << endl;
+            errors++;
+        }
+        if (state.gameOver || state.tick - lastFruitTick > stallTicks || misplaced) {
+            totalTicks += state.tick;
+            game++;
+            ResetState(state);
+            lastFruitTick = 0;
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    uint32_t loaded = 0;
+    for (uint32_t chunk = 0; chunk < level.ChunkCount(); chunk++) {
+        loaded += state.loadedChunks.Test(chunk) ? 1 : 0;
+    }
+    cout << "games: " << gameCount << ", fruits: " << fruits << ", errors: " << errors << endl;
+    cout << "ticks: " << totalTicks << " (" << (uint64_t)(totalTicks / seconds) << " ticks/sec)" << endl;
+    cout << "chunks loaded in the last game: " << loaded << "/" << level.ChunkCount() << endl;
+    return errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 5 && strcmp(argv[1], "--maze") == 0) {
+        GridShape grid;
+        if (!ParseGridShape(argv[2], grid)) {
+            cerr << "bad grid size: " << argv[2] << endl;
+            return 1;
+        }
+        return Maze(grid, strtoull(argv[3], nullptr, 10), argv[4]);
+    }
+    if (argc == 3 && strcmp(argv[1], "--info") == 0) {
+        return Info(argv[2]);
+    }
+    if (argc == 4 && strcmp(argv[1], "--play") == 0) {
+        return Play(argv[2], (uint32_t)strtoul(argv[3], nullptr, 10));
+    }
+    if (argc != 3) {
+        cerr << "usage: " << argv[0] << " map.txt level.snkl" << endl;
+        return 1;
+    }
+    return Convert(argv[1], argv[2]);
+}
@@ -0,0 +1,168 @@
+﻿#include "snakeMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+using namespace std;
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const string& path, bool writable) {
+    Close();
+    handle = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+        FILE_SHARE_READ, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        handle = nullptr;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        handle = nullptr;
+        return false;
+    }
+    this->writable = writable;
+    size = (uint64_t)fileSize.QuadPart;
+    open = true;
+    if (!Map()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Map() {
+    if (size == 0) {
+        return true;
+    }
+    mapping = CreateFileMappingA(handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        return false;
+    }
+    data = (uint8_t*)MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    return data != nullptr;
+}
+
+void MappedFile::Unmap() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+}
+
+bool MappedFile::Resize(uint64_t newSize) {
+    if (!open || !writable) {
+        return false;
+    }
+    Unmap();
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)newSize;
+    if (SetFilePointerEx(handle, position, nullptr, FILE_BEGIN) && SetEndOfFile(handle)) {
+        size = newSize;
+    }
+    return Map() && size == newSize;
+}
+
+void MappedFile::Flush(uint64_t offset, uint64_t length) {
+    if (data != nullptr && offset < size) {
+        FlushViewOfFile(data + offset, (SIZE_T)min(length, size - offset));
+    }
+}
+
+void MappedFile::Close() {
+    Unmap();
+    if (handle != nullptr) {
+        CloseHandle(handle);
+        handle = nullptr;
+    }
+    open = false;
+    size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const string& path, bool writable) {
+    Close();
+    handle = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (handle < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(handle, &status) != 0) {
+        ::close(handle);
+        return false;
+    }
+    this->writable = writable;
+    size = (uint64_t)status.st_size;
+    open = true;
+    if (!Map()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Map() {
+    if (size == 0) {
+        return true;
+    }
+    void* memory = mmap(nullptr, (size_t)size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, handle, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    data = (uint8_t*)memory;
+    return true;
+}
+
+void MappedFile::Unmap() {
+    if (data != nullptr) {
+        munmap(data, (size_t)size);
+        data = nullptr;
+    }
+}
+
+bool MappedFile::Resize(uint64_t newSize) {
+    if (!open || !writable) {
+        return false;
+    }
+    Unmap();
+    if (ftruncate(handle, (off_t)newSize) == 0) {
+        size = newSize;
+    }
+    return Map() && size == newSize;
+}
+
+void MappedFile::Flush(uint64_t offset, uint64_t length) {
+    if (data == nullptr || offset >= size) {
+        return;
+    }
+    // msync demande une adresse alignée sur une page
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = offset / pageSize * pageSize;
+    uint64_t end = offset + length < size ? offset + length : size;
+    msync(data + start, (size_t)(end - start), MS_ASYNC);
+}
+
+void MappedFile::Close() {
+    Unmap();
+    if (open) {
+        ::close(handle);
+    }
+    open = false;
+    size = 0;
+}
+
+#endif
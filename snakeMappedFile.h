@@ -0,0 +1,81 @@
+﻿// Fichier projeté en mémoire (POSIX ou Windows), sans dépendance à SFML
+//
+// Les écritures dans la projection sont visibles dans le fichier dès qu'elles
+// sont faites : un arrêt brutal du processus ne perd rien. Flush demande en
+// plus l'écriture sur le disque, pour une coupure de courant.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+typedef void* MappedFileHandle;
+#else
+typedef int MappedFileHandle;
+#endif
+
+/*
+  Projette un fichier entier en mémoire, en lecture seule ou en lecture et écriture
+*/
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /*
+      Ouvre et projette un fichier
+      parametre "path" Chemin du fichier
+      parametre "writable" Lecture et écriture (le fichier est créé s'il n'existe pas)
+      retourne false si le fichier ne peut pas être ouvert ou projeté
+    */
+    bool Open(const std::string& path, bool writable);
+
+    /*
+      Change la taille du fichier et le projette à nouveau (les pointeurs
+      obtenus avant l'appel ne sont plus valables). Les octets ajoutés valent 0.
+      parametre "size" Nouvelle taille en octets
+      retourne false si le fichier est en lecture seule ou si le disque est plein
+    */
+    bool Resize(uint64_t size);
+
+    /*
+      Demande l'écriture sur le disque d'une partie du fichier, sans attendre
+      parametre "offset" Début de la zone
+      parametre "size" Taille de la zone
+    */
+    void Flush(uint64_t offset, uint64_t size);
+
+    /*
+      Retire la projection et ferme le fichier
+    */
+    void Close();
+
+    bool IsOpen() const { return open; }
+    uint8_t* Data() { return data; }
+    const uint8_t* Data() const { return data; }
+    uint64_t Size() const { return size; }
+
+private:
+    /*
+      Projette le fichier à sa taille actuelle (rien si elle est nulle)
+    */
+    bool Map();
+
+    /*
+      Retire la projection, sans fermer le fichier
+    */
+    void Unmap();
+
+    MappedFileHandle handle{};
+#ifdef _WIN32
+    MappedFileHandle mapping = nullptr;   // Objet de projection Windows
+#endif
+    bool open = false;
+    bool writable = false;
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+};
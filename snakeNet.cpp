@@ -0,0 +1,672 @@
+﻿#include "snakeNet.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;  // Pair parti : une erreur plutôt que SIGPIPE
+#else
+static const int SEND_FLAGS = 0;             // (SO_NOSIGPIPE, voir Configure)
+#endif
+
+// Files du système pour une socket udp (tous les clients passent par la même côté serveur)
+static const int DATAGRAM_BUFFER = 8 << 20;
+// Lecture d'un flux : place libre demandée avant chaque lecture
+static const uint32_t READ_CHUNK = 16 << 10;
+
+// Octets fixes d'une Keyframe (voir NetKeyframeSize)
+static const uint32_t KEYFRAME_HEADER_SIZE = 43;
+
+bool ParseEndpoint(const char* text, NetEndpoint& endpoint) {
+    if (strncmp(text, "unix:", 5) == 0) {
+        endpoint.transport = NetTransport::Unix;
+        endpoint.path = text + 5;
+        return !endpoint.path.empty() && endpoint.path.size() < sizeof(((sockaddr_un*)nullptr)->sun_path);
+    }
+    if (strncmp(text, "udp:", 4) == 0) {
+        endpoint.transport = NetTransport::Udp;
+    }
+    else if (strncmp(text, "tcp:", 4) == 0) {
+        endpoint.transport = NetTransport::Tcp;
+    }
+    else {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long port = strtoul(text + 4, &end, 10);
+    if (end == text + 4 || *end != 0 || port == 0 || port > 65535) {
+        return false;
+    }
+    endpoint.port = (uint16_t)port;
+    return true;
+}
+
+string FormatEndpoint(const NetEndpoint& endpoint) {
+    switch (endpoint.transport) {
+    case NetTransport::Udp: return "udp:" + to_string(endpoint.port);
+    case NetTransport::Tcp: return "tcp:" + to_string(endpoint.port);
+    default: return "unix:" + endpoint.path;
+    }
+}
+
+/*
+  Écrit la cause d'un échec sur la sortie d'erreur et ferme la socket
+  retourne -1
+*/
+static int Fail(const NetEndpoint& endpoint, const char* what, int socket) {
+    cerr << FormatEndpoint(endpoint) << ": " << what << ": " << strerror(errno) << endl;
+    NetCloseSocket(socket);
+    return -1;
+}
+
+/*
+  Rend une socket non bloquante ; un flux tcp envoie ses messages sans attendre (Nagle coupé)
+*/
+static void Configure(int socket, bool tcp) {
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+    int one = 1;
+    if (tcp) {
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+#ifdef SO_NOSIGPIPE
+    setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+/*
+  Adresse d'un serveur : 127.0.0.1 ou chemin de la socket unix
+  retourne La taille de l'adresse écrite dans "address"
+*/
+static socklen_t MakeAddress(const NetEndpoint& endpoint, sockaddr_storage& address) {
+    memset(&address, 0, sizeof(address));
+    if (endpoint.transport == NetTransport::Unix) {
+        sockaddr_un* local = (sockaddr_un*)&address;
+        local->sun_family = AF_UNIX;
+        strncpy(local->sun_path, endpoint.path.c_str(), sizeof(local->sun_path) - 1);
+        return (socklen_t)sizeof(sockaddr_un);
+    }
+    sockaddr_in* internet = (sockaddr_in*)&address;
+    internet->sin_family = AF_INET;
+    internet->sin_port = htons(endpoint.port);
+    internet->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return (socklen_t)sizeof(sockaddr_in);
+}
+
+/*
+  Crée la socket d'une adresse
+*/
+static int OpenSocket(const NetEndpoint& endpoint) {
+    int family = endpoint.transport == NetTransport::Unix ? AF_UNIX : AF_INET;
+    int type = endpoint.transport == NetTransport::Udp ? SOCK_DGRAM : SOCK_STREAM;
+    return socket(family, type, 0);
+}
+
+int NetListen(const NetEndpoint& endpoint) {
+    int listenSocket = OpenSocket(endpoint);
+    if (listenSocket < 0) {
+        return Fail(endpoint, "socket", listenSocket);
+    }
+    int one = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (endpoint.transport == NetTransport::Unix) {
+        // Socket laissée par un serveur précédent
+        unlink(endpoint.path.c_str());
+    }
+    sockaddr_storage address;
+    socklen_t length = MakeAddress(endpoint, address);
+    if (bind(listenSocket, (sockaddr*)&address, length) != 0) {
+        return Fail(endpoint, "bind", listenSocket);
+    }
+    if (endpoint.transport == NetTransport::Udp) {
+        setsockopt(listenSocket, SOL_SOCKET, SO_RCVBUF, &DATAGRAM_BUFFER, sizeof(DATAGRAM_BUFFER));
+        setsockopt(listenSocket, SOL_SOCKET, SO_SNDBUF, &DATAGRAM_BUFFER, sizeof(DATAGRAM_BUFFER));
+    }
+    else if (listen(listenSocket, SOMAXCONN) != 0) {
+        return Fail(endpoint, "listen", listenSocket);
+    }
+    Configure(listenSocket, false);
+    return listenSocket;
+}
+
+int NetConnect(const NetEndpoint& endpoint) {
+    int connectSocket = OpenSocket(endpoint);
+    if (connectSocket < 0) {
+        return Fail(endpoint, "socket", connectSocket);
+    }
+    sockaddr_storage address;
+    socklen_t length = MakeAddress(endpoint, address);
+    if (connect(connectSocket, (sockaddr*)&address, length) != 0) {
+        return Fail(endpoint, "connect", connectSocket);
+    }
+    Configure(connectSocket, endpoint.transport == NetTransport::Tcp);
+    return connectSocket;
+}
+
+int NetAccept(int listenSocket) {
+    sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    int connection = accept(listenSocket, (sockaddr*)&address, &length);
+    if (connection < 0) {
+        return -1;
+    }
+    Configure(connection, address.ss_family == AF_INET);
+    return connection;
+}
+
+void NetCloseSocket(int socket) {
+    if (socket >= 0) {
+        close(socket);
+    }
+}
+
+uint64_t NetPeerAddress::Key() const {
+    const sockaddr* address = (const sockaddr*)bytes;
+    if (address->sa_family == AF_INET) {
+        const sockaddr_in* internet = (const sockaddr_in*)bytes;
+        return (uint64_t)ntohl(internet->sin_addr.s_addr) << 16 | ntohs(internet->sin_port);
+    }
+    // Autre famille : empreinte FNV-1a de l'adresse
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+int NetReceiveFrom(int socket, uint8_t* buffer, uint32_t capacity, NetPeerAddress& from) {
+    for (;;) {
+        socklen_t length = sizeof(from.bytes);
+        ssize_t received = recvfrom(socket, buffer, capacity, 0, (sockaddr*)from.bytes, &length);
+        if (received >= 0) {
+            from.length = (uint32_t)length;
+            return (int)received;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+Cell NetNeighbor(const GridShape& grid, Cell cell, SimAction action) {
+    int x = grid.CellX(cell);
+    int y = grid.CellY(cell);
+    switch (action) {
+    case SimAction::Up: y = y == 0 ? grid.height - 1 : y - 1; break;
+    case SimAction::Down: y = y + 1 == grid.height ? 0 : y + 1; break;
+    case SimAction::Left: x = x == 0 ? grid.width - 1 : x - 1; break;
+    case SimAction::Right: x = x + 1 == grid.width ? 0 : x + 1; break;
+    default: break;
+    }
+    return grid.MakeCell(x, y);
+}
+
+SimAction NetDirection(const GridShape& grid, Cell from, Cell to) {
+    static const SimAction ACTIONS[4] = { SimAction::Up, SimAction::Down, SimAction::Left, SimAction::Right };
+    for (SimAction action : ACTIONS) {
+        if (NetNeighbor(grid, from, action) == to) {
+            return action;
+        }
+    }
+    return SimAction::None;
+}
+
+uint32_t NetKeyframeSize(uint32_t length, uint32_t obstacleCount) {
+    return KEYFRAME_HEADER_SIZE + 4 * obstacleCount + (length + 2) / 4;
+}
+
+/*
+  retourne L'état de la partie en bits NET_STARTED et NET_GAME_OVER
+*/
+static uint8_t StateFlags(const SimState& state) {
+    return (state.started ? NET_STARTED : 0) | (state.gameOver ? NET_GAME_OVER : 0);
+}
+
+void WriteKeyframe(NetWriter& writer, const SimState& state, NetSentState& sent, uint32_t tick, uint32_t ack,
+                   uint32_t generation, uint32_t tickMicroseconds) {
+    writer.Start(NetMessage::Keyframe);
+    writer.Put32(tick);
+    writer.Put32(ack);
+    writer.Put32(tickMicroseconds);
+    writer.Put16((uint16_t)state.grid.width);
+    writer.Put16((uint16_t)state.grid.height);
+    writer.Put32(generation);
+    writer.Put32((uint32_t)state.score);
+    writer.Put8(StateFlags(state));
+    writer.Put32(state.fruitPosition);
+    writer.Put8((uint8_t)state.obstacles.size());
+    for (Cell obstacle : state.obstacles) {
+        writer.Put32(obstacle);
+    }
+    writer.Put32(state.body.Length());
+    writer.Put32(state.body.Tail());
+
+    // Directions de la queue vers la tête, 4 par octet
+    uint8_t packed = 0;
+    uint32_t count = 0;
+    Cell previous = NO_CELL;
+    state.body.ForEachFromTail([&](Cell cell) {
+        if (previous != NO_CELL) {
+            uint32_t direction = (uint32_t)NetDirection(state.grid, previous, cell) - (uint32_t)SimAction::Up;
+            packed |= (uint8_t)(direction << (2 * (count & 3)));
+            if ((++count & 3) == 0) {
+                writer.Put8(packed);
+                packed = 0;
+            }
+        }
+        previous = cell;
+    });
+    if ((count & 3) != 0) {
+        writer.Put8(packed);
+    }
+
+    sent.head = state.body.Head();
+    sent.length = state.body.Length();
+    sent.fruit = state.fruitPosition;
+    sent.obstacles.assign(state.obstacles.begin(), state.obstacles.end());
+    sent.score = state.score;
+}
+
+bool WriteDelta(NetWriter& writer, const SimState& state, NetSentState& sent, uint32_t tick, uint32_t ack) {
+    Cell head = state.body.Head();
+    bool moved = head != sent.head;
+    int64_t popped = (int64_t)sent.length + (moved ? 1 : 0) - (int64_t)state.body.Length();
+    if (popped < 0 || popped > 1 || (moved && NetDirection(state.grid, sent.head, head) == SimAction::None)) {
+        return false;
+    }
+    bool obstaclesMoved = state.obstacles.size() != sent.obstacles.size() ||
+                          !equal(state.obstacles.begin(), state.obstacles.end(), sent.obstacles.begin());
+    uint8_t flags = StateFlags(state);
+    flags |= moved ? NET_HEAD : 0;
+    flags |= popped == 1 ? NET_TAIL : 0;
+    flags |= state.fruitPosition != sent.fruit ? NET_FRUIT : 0;
+    flags |= obstaclesMoved ? NET_OBSTACLES : 0;
+    flags |= state.score != sent.score ? NET_SCORE : 0;
+
+    writer.Start(NetMessage::Delta);
+    writer.Put32(tick);
+    writer.Put32(ack);
+    writer.Put8(flags);
+    if (flags & NET_HEAD) {
+        writer.Put32(head);
+    }
+    if (flags & NET_FRUIT) {
+        writer.Put32(state.fruitPosition);
+    }
+    if (flags & NET_OBSTACLES) {
+        writer.Put8((uint8_t)state.obstacles.size());
+        for (Cell obstacle : state.obstacles) {
+            writer.Put32(obstacle);
+        }
+        sent.obstacles.assign(state.obstacles.begin(), state.obstacles.end());
+    }
+    if (flags & NET_SCORE) {
+        writer.Put32((uint32_t)state.score);
+    }
+
+    sent.head = head;
+    sent.length = state.body.Length();
+    sent.fruit = state.fruitPosition;
+    sent.score = state.score;
+    return true;
+}
+
+void NetLink::Attach(int linkSocket, bool isStream) {
+    Close();
+    socket = linkSocket;
+    stream = isStream;
+    shared = false;
+    inputSize = 0;
+    outputStart = 0;
+    outputEnd = 0;
+    if (stream && input.empty()) {
+        input.resize(READ_CHUNK);
+    }
+}
+
+void NetLink::AttachPeer(int listenSocket, const NetPeerAddress& address) {
+    Close();
+    socket = listenSocket;
+    stream = false;
+    shared = true;
+    peer = address;
+}
+
+void NetLink::Close() {
+    if (!shared) {
+        NetCloseSocket(socket);
+    }
+    socket = -1;
+    shared = false;
+}
+
+bool NetLink::Send(const uint8_t* message, uint32_t size) {
+    if (socket < 0) {
+        return false;
+    }
+    if (!stream) {
+        ssize_t sent = shared ? sendto(socket, message, size, SEND_FLAGS, (const sockaddr*)peer.bytes, peer.length)
+                              : send(socket, message, size, SEND_FLAGS);
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS && errno != EINTR) {
+            return false;
+        }
+        dropped += sent < 0 ? 1 : 0;
+        return true;
+    }
+
+    // Message précédé de sa taille, à la suite de la file (ramenée au début si elle est vide)
+    if (outputStart == outputEnd) {
+        outputStart = 0;
+        outputEnd = 0;
+    }
+    if (outputEnd - outputStart + 2 + size > NET_OUTPUT_LIMIT) {
+        return false;
+    }
+    if (outputEnd + 2 + size > output.size()) {
+        copy(output.begin() + outputStart, output.begin() + outputEnd, output.begin());
+        outputEnd -= outputStart;
+        outputStart = 0;
+        if (outputEnd + 2 + size > output.size()) {
+            output.resize(max((size_t)(outputEnd + 2 + size), output.size() * 2));
+        }
+    }
+    output[outputEnd] = (uint8_t)size;
+    output[outputEnd + 1] = (uint8_t)(size >> 8);
+    memcpy(&output[outputEnd + 2], message, size);
+    outputEnd += 2 + size;
+    return Flush();
+}
+
+bool NetLink::Flush() {
+    while (outputStart < outputEnd) {
+        ssize_t sent = send(socket, &output[outputStart], outputEnd - outputStart, SEND_FLAGS);
+        if (sent > 0) {
+            outputStart += (uint32_t)sent;
+        }
+        else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        else if (sent < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int NetLink::ReadSome(const uint8_t*& datagram) {
+    // Un seul datagramme lu à la fois par fil : un tampon par fil suffit
+    static thread_local uint8_t datagramBuffer[NET_MAX_MESSAGE];
+    for (;;) {
+        ssize_t received;
+        if (stream) {
+            if (input.size() - inputSize < READ_CHUNK) {
+                input.resize(input.size() + READ_CHUNK);
+            }
+            received = recv(socket, &input[inputSize], input.size() - inputSize, 0);
+            if (received == 0) {
+                return -1;
+            }
+        }
+        else {
+            received = recv(socket, datagramBuffer, sizeof(datagramBuffer), 0);
+            datagram = datagramBuffer;
+        }
+        if (received > 0) {
+            inputSize += stream ? (uint32_t)received : 0;
+            return (int)received;
+        }
+        if (received == 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+bool NetMirror::Apply(const uint8_t* data, uint32_t size) {
+    NetReader reader(data, size);
+    NetMessage type = (NetMessage)reader.Read(1);
+    if (type == NetMessage::Keyframe) {
+        return ApplyKeyframe(reader);
+    }
+    if (type == NetMessage::Delta) {
+        return ApplyDelta(reader);
+    }
+    return false;
+}
+
+bool NetMirror::NeedsResync() {
+    bool wanted = resyncWanted;
+    resyncWanted = false;
+    return wanted;
+}
+
+void NetMirror::LoseSync() {
+    synced = false;
+    resyncWanted = true;
+    ignored = 0;
+    losses++;
+}
+
+void NetMirror::Change(Cell cell, CellContent content) {
+    if (trackChanges) {
+        changes.push_back({ cell, content });
+    }
+}
+
+void NetMirror::Resize(const GridShape& shape) {
+    if (shape == grid) {
+        return;
+    }
+    grid = shape;
+    body.Init(grid.CellCount(), grid);
+    incoming.Init(grid.CellCount(), grid);
+    bodyCells.Init(grid.CellCount());
+    obstacleCells.Init(grid.CellCount());
+}
+
+void NetMirror::ReadState(uint8_t flags) {
+    started = (flags & NET_STARTED) != 0;
+    gameOver = (flags & NET_GAME_OVER) != 0;
+}
+
+/*
+  Lit une liste d'obstacles dans "incomingObstacles"
+  retourne false si une case est hors de la grille
+*/
+bool NetMirror::ReadObstacles(NetReader& reader) {
+    incomingObstacles.resize(reader.Read(1));
+    bool valid = true;
+    for (Cell& obstacle : incomingObstacles) {
+        obstacle = reader.Read(4);
+        valid = valid && obstacle < grid.CellCount();
+    }
+    return valid;
+}
+
+void NetMirror::SetObstacles() {
+    for (Cell obstacle : obstacles) {
+        obstacleCells.Reset(obstacle);
+        Change(obstacle, CellContent::Empty);
+    }
+    obstacles.swap(incomingObstacles);
+}
+
+bool NetMirror::ApplyKeyframe(NetReader& reader) {
+    uint32_t frameTick = reader.Read(4);
+    uint32_t frameAck = reader.Read(4);
+    uint32_t frameInterval = reader.Read(4);
+    GridShape shape;
+    shape.width = (int)reader.Read(2);
+    shape.height = (int)reader.Read(2);
+    uint32_t frameGeneration = reader.Read(4);
+    int frameScore = (int)reader.Read(4);
+    uint8_t flags = (uint8_t)reader.Read(1);
+    Cell frameFruit = reader.Read(4);
+    if (!reader.ok || shape.width < MIN_GRID_SIZE || shape.height < MIN_GRID_SIZE ||
+        shape.width > MAX_GRID_SIZE || shape.height > MAX_GRID_SIZE) {
+        LoseSync();
+        return false;
+    }
+
+    // Au même pas que la copie, la Keyframe doit lui être identique (voir "mismatches")
+    bool compare = synced && shape == grid && frameTick == tick && frameGeneration == generation;
+    Resize(shape);
+    bool valid = ReadObstacles(reader) && (frameFruit == NO_CELL || frameFruit < grid.CellCount());
+    bool same = compare && frameFruit == fruit && frameScore == score && incomingObstacles == obstacles;
+
+    // Corps : la queue puis chaque segment d'après sa direction, lu dans "incoming"
+    uint32_t length = reader.Read(4);
+    Cell cell = reader.Read(4);
+    valid = valid && reader.ok && length >= 1 && length <= grid.CellCount() && cell < grid.CellCount();
+    same = same && length == body.Length();
+    incoming.Clear();
+    uint8_t packed = 0;
+    for (uint32_t i = 0; valid && i < length; i++) {
+        if (i > 0) {
+            if ((i - 1) % 4 == 0) {
+                packed = (uint8_t)reader.Read(1);
+            }
+            cell = NetNeighbor(grid, cell, (SimAction)((uint32_t)SimAction::Up + (packed >> (2 * ((i - 1) % 4)) & 3)));
+        }
+        same = same && bodyCells.Test(cell);
+        incoming.PushHead(cell);
+    }
+    if (!reader.ok || !valid) {
+        LoseSync();
+        return false;
+    }
+    same = same && incoming.Head() == body.Head();
+    mismatches += compare && !same ? 1 : 0;
+
+    swap(body, incoming);
+    bodyCells.Clear();
+    body.ForEach([this](Cell segment) { bodyCells.Set(segment); });
+    for (Cell obstacle : obstacles) {
+        obstacleCells.Reset(obstacle);
+    }
+    obstacles.swap(incomingObstacles);
+    for (Cell obstacle : obstacles) {
+        obstacleCells.Set(obstacle);
+    }
+    fruit = frameFruit;
+    score = frameScore;
+    ReadState(flags);
+    tick = frameTick;
+    ack = frameAck;
+    generation = frameGeneration;
+    tickInterval = chrono::microseconds(frameInterval);
+    previousHead = NO_CELL;
+    previousTail = NO_CELL;
+    changes.clear();
+    synced = true;
+    resyncWanted = false;
+    frames++;
+    keyframes++;
+    appliedAt = InputClock::now();
+    return true;
+}
+
+bool NetMirror::ApplyDelta(NetReader& reader) {
+    if (!synced) {
+        if (++ignored % NET_RESYNC_RETRY == 0) {
+            resyncWanted = true;
+        }
+        return false;
+    }
+    uint32_t frameTick = reader.Read(4);
+    if (reader.ok && (int32_t)(frameTick - tick) <= 0) {
+        // Datagramme en double ou en retard : déjà pris en compte
+        return false;
+    }
+    uint32_t frameAck = reader.Read(4);
+    uint8_t flags = (uint8_t)reader.Read(1);
+    Cell head = (flags & NET_HEAD) ? reader.Read(4) : NO_CELL;
+    Cell frameFruit = (flags & NET_FRUIT) ? reader.Read(4) : fruit;
+    bool valid = (flags & NET_OBSTACLES) == 0 || ReadObstacles(reader);
+    int frameScore = (flags & NET_SCORE) ? (int)reader.Read(4) : score;
+    valid = valid && reader.ok && frameTick == tick + 1 && (frameFruit == NO_CELL || frameFruit < grid.CellCount()) &&
+            ((flags & NET_HEAD) == 0 || NetDirection(grid, body.Head(), head) != SimAction::None) &&
+            ((flags & NET_TAIL) == 0 || body.Length() > 1);
+    if (!valid) {
+        LoseSync();
+        return false;
+    }
+
+    // Dans l'ordre du pas : la tête peut prendre la case de la queue, de la nourriture ou d'un obstacle
+    previousHead = body.Head();
+    previousTail = body.Tail();
+    if ((flags & NET_FRUIT) && fruit != NO_CELL) {
+        Change(fruit, CellContent::Empty);
+    }
+    if (flags & NET_OBSTACLES) {
+        SetObstacles();
+    }
+    if (flags & NET_TAIL) {
+        Cell tail = body.PopTail();
+        bodyCells.Reset(tail);
+        Change(tail, CellContent::Empty);
+    }
+    if (flags & NET_HEAD) {
+        body.PushHead(head);
+        bodyCells.Set(head);
+        Change(head, CellContent::Snake);
+    }
+    fruit = frameFruit;
+    if ((flags & NET_FRUIT) && fruit != NO_CELL) {
+        Change(fruit, CellContent::Fruit);
+    }
+    if (flags & NET_OBSTACLES) {
+        for (Cell obstacle : obstacles) {
+            obstacleCells.Set(obstacle);
+            Change(obstacle, CellContent::Obstacle);
+        }
+    }
+    score = frameScore;
+    ReadState(flags);
+    tick = frameTick;
+    ack = frameAck;
+    deltas++;
+    appliedAt = InputClock::now();
+    return true;
+}
+
+void NetMirror::Capture(SimSnapshot& snapshot) {
+    snapshot.grid = grid;
+    snapshot.body.resize(body.Length());
+    Cell* segment = snapshot.body.data();
+    body.ForEach([&segment](Cell cell) { *segment++ = cell; });
+    snapshot.previousHead = previousHead != NO_CELL ? previousHead : body.Head();
+    snapshot.previousTail = previousTail != NO_CELL ? previousTail : body.Tail();
+    snapshot.fruitPosition = fruit;
+    snapshot.obstacles.assign(obstacles.begin(), obstacles.end());
+    snapshot.changes.assign(changes.begin(), changes.end());
+    changes.clear();
+    snapshot.rivals.clear();
+    snapshot.fruits.clear();
+
+    SimAction direction = body.Length() > 1 ? NetDirection(grid, body.At(1), body.Head()) : SimAction::Right;
+    snapshot.dirX = direction == SimAction::Left ? -1 : direction == SimAction::Right ? 1 : 0;
+    snapshot.dirY = direction == SimAction::Up ? -1 : direction == SimAction::Down ? 1 : 0;
+    snapshot.score = score;
+    snapshot.tick = tick;
+    snapshot.gameSeed = 0;
+    snapshot.started = started;
+    snapshot.gameOver = gameOver;
+    snapshot.sequence = ++captures;
+    snapshot.generation = frames;
+    snapshot.tickTime = appliedAt;
+}
@@ -0,0 +1,467 @@
+﻿// Parties servies en local : protocole, liens et copie de l'état côté client (sans dépendance à SFML)
+//
+// Le serveur (snakeServer) fait avancer de nombreuses parties à cadence fixe sur
+// une seule boucle d'événements. Après chaque pas, il envoie à chaque client ce
+// qui a changé dans sa partie : tête ajoutée, queue retirée, nourriture ou
+// obstacles déplacés, score. Une image complète (Keyframe) n'est envoyée qu'au
+// début d'une partie, ou à un client qui a manqué un message.
+//
+// Transports, sur la machine locale seulement (sockets POSIX) :
+//   udp:PORT     un datagramme par message, sur 127.0.0.1
+//   tcp:PORT     flux sur 127.0.0.1, chaque message précédé de sa taille (16 bits)
+//   unix:CHEMIN  flux comme tcp, sur une socket du système de fichiers
+//
+// Messages (entiers petit-boutistes, cases sur 32 bits), le type en premier octet :
+//   client -> serveur
+//     Hello    : version                      ouvre la session (ou redemande une Keyframe)
+//     Input    : numéro (32 bits), SimAction  virage, accusé par les messages suivants
+//     Restart  :                              nouvelle partie si la partie est terminée
+//     Resync   :                              redemande une Keyframe
+//     Bye      :                              ferme la session
+//     Ping     :                              garde la session ouverte (voir NET_KEEPALIVE)
+//   serveur -> client
+//     Keyframe : pas, accusé, intervalle des pas (µs), largeur et hauteur (16 bits),
+//                partie, score, état (NET_STARTED, NET_GAME_OVER), nourriture,
+//                obstacles (nombre sur 8 bits, puis les cases), longueur, queue, puis
+//                la direction de chaque segment vers le suivant, de la queue vers la
+//                tête, sur 2 bits (4 par octet) : 1 Ko pour 4096 segments
+//     Delta    : pas, accusé, changements et état (NET_HEAD...), puis selon les
+//                changements : nouvelle tête, nourriture, obstacles, score
+//     Bye      :                              réponse udp à une adresse sans session :
+//                                             le client doit renvoyer Hello
+//   Les pas d'une session se suivent. Un client qui voit un trou (datagramme perdu)
+//   ignore les Delta et demande une Keyframe (Resync). Un client qui ne reçoit plus
+//   rien pendant quelques pas renvoie Hello : la session a pu être fermée.
+
+#pragma once
+
+#include "snakeSim.h"
+#include "snakeThread.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint8_t NET_VERSION = 1;
+
+// Taille maximale d'un message (un datagramme UDP, ou la taille sur 16 bits d'un flux)
+const uint32_t NET_MAX_MESSAGE = 65000;
+
+// Au-delà, un client de flux qui ne lit plus est déconnecté
+const uint32_t NET_OUTPUT_LIMIT = 1 << 20;
+
+// Messages ignorés (client désynchronisé) avant de redemander une Keyframe perdue
+const uint32_t NET_RESYNC_RETRY = 16;
+
+// Un client sans autre message à envoyer envoie un Ping au moins aussi souvent ;
+// le serveur ferme une session udp muette depuis plus de trois fois cette durée (--idle)
+const std::chrono::seconds NET_KEEPALIVE(3);
+
+/*
+  Type d'un message, premier octet
+*/
+enum class NetMessage : uint8_t {
+    Hello = 1,
+    Input,
+    Restart,
+    Resync,
+    Bye,
+    Keyframe,
+    Delta,
+    Ping
+};
+
+// Changements d'un Delta et état de la partie (Delta et Keyframe)
+const uint8_t NET_HEAD = 1;        // Nouvelle tête (case)
+const uint8_t NET_TAIL = 2;        // Queue retirée
+const uint8_t NET_FRUIT = 4;       // Nourriture déplacée (case, NO_CELL : aucune)
+const uint8_t NET_OBSTACLES = 8;   // Obstacles replacés (nombre, puis les cases)
+const uint8_t NET_SCORE = 16;      // Nouveau score
+const uint8_t NET_STARTED = 32;    // La partie a commencé
+const uint8_t NET_GAME_OVER = 64;  // La partie est terminée
+
+/*
+  Transport d'une adresse
+*/
+enum class NetTransport {
+    Udp,
+    Tcp,
+    Unix
+};
+
+/*
+  Adresse locale d'un serveur
+*/
+struct NetEndpoint {
+    NetTransport transport = NetTransport::Udp;
+    uint16_t port = 0;   // udp et tcp (sur 127.0.0.1)
+    std::string path;    // unix
+};
+
+/*
+  Lit une adresse "udp:PORT", "tcp:PORT" ou "unix:CHEMIN"
+  parametre "text" Le texte à lire
+  parametre "endpoint" Reçoit l'adresse
+  retourne false si le texte n'est pas valide
+*/
+bool ParseEndpoint(const char* text, NetEndpoint& endpoint);
+
+/*
+  retourne L'adresse écrite comme ParseEndpoint la lit
+*/
+std::string FormatEndpoint(const NetEndpoint& endpoint);
+
+/*
+  Ouvre la socket d'écoute d'un serveur, non bloquante
+  (udp : la socket qui reçoit les datagrammes de tous les clients)
+  retourne La socket, ou -1 (cause écrite sur la sortie d'erreur)
+*/
+int NetListen(const NetEndpoint& endpoint);
+
+/*
+  Se connecte à un serveur ; la socket rendue est non bloquante
+  (udp : socket connectée, qui ne reçoit que les datagrammes du serveur)
+  retourne La socket, ou -1 (cause écrite sur la sortie d'erreur)
+*/
+int NetConnect(const NetEndpoint& endpoint);
+
+/*
+  Accepte une connexion en attente sur une socket d'écoute de flux
+  retourne La socket de la connexion, non bloquante, ou -1 si aucune n'attend
+*/
+int NetAccept(int listenSocket);
+
+/*
+  Ferme une socket (sans effet pour -1)
+*/
+void NetCloseSocket(int socket);
+
+/*
+  Adresse d'un client udp, telle que le système la donne (struct sockaddr)
+*/
+struct NetPeerAddress {
+    uint8_t bytes[128];
+    uint32_t length = 0;
+
+    /*
+      retourne Une clé qui distingue les clients (adresse et port)
+    */
+    uint64_t Key() const;
+};
+
+/*
+  Lit un datagramme reçu par la socket d'écoute udp d'un serveur
+  parametre "socket" Socket d'écoute
+  parametre "buffer" Reçoit le datagramme
+  parametre "capacity" Taille de "buffer"
+  parametre "from" Reçoit l'adresse de l'expéditeur
+  retourne Le nombre d'octets lus, 0 si rien n'est arrivé, -1 en cas d'erreur
+*/
+int NetReceiveFrom(int socket, uint8_t* buffer, uint32_t capacity, NetPeerAddress& from);
+
+/*
+  Message en cours d'écriture, dans un tableau fixe : l'écriture n'alloue rien.
+  Une écriture au-delà de NET_MAX_MESSAGE est perdue et met "ok" à false.
+*/
+struct NetWriter {
+    uint8_t data[NET_MAX_MESSAGE];
+    uint32_t size = 0;
+    bool ok = true;
+
+    void Start(NetMessage type) {
+        size = 0;
+        ok = true;
+        Put8((uint8_t)type);
+    }
+
+    void Put8(uint8_t value) {
+        if (size == NET_MAX_MESSAGE) {
+            ok = false;
+            return;
+        }
+        data[size++] = value;
+    }
+
+    void Put16(uint16_t value) {
+        Put8((uint8_t)value);
+        Put8((uint8_t)(value >> 8));
+    }
+
+    void Put32(uint32_t value) {
+        Put16((uint16_t)value);
+        Put16((uint16_t)(value >> 16));
+    }
+};
+
+/*
+  Lecture d'entiers petit-boutistes dans un message, sans jamais déborder :
+  une lecture hors limites renvoie 0 et met "ok" à false
+*/
+struct NetReader {
+    const uint8_t* data;
+    uint32_t size;
+    uint32_t position = 0;
+    bool ok = true;
+
+    NetReader(const uint8_t* bytes, uint32_t byteCount) : data(bytes), size(byteCount) {}
+
+    uint32_t Read(int byteCount) {
+        if (position + byteCount > size) {
+            ok = false;
+            return 0;
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < byteCount; i++) {
+            value |= (uint32_t)data[position + i] << (8 * i);
+        }
+        position += byteCount;
+        return value;
+    }
+};
+
+/*
+  retourne La case voisine dans une direction (grille torique)
+*/
+Cell NetNeighbor(const GridShape& grid, Cell cell, SimAction action);
+
+/*
+  retourne La direction d'une case vers une case voisine (None si elles ne sont pas voisines)
+*/
+SimAction NetDirection(const GridShape& grid, Cell from, Cell to);
+
+/*
+  retourne La taille de la Keyframe d'une partie (à comparer à NET_MAX_MESSAGE)
+  parametre "length" Longueur du serpent
+  parametre "obstacleCount" Nombre d'obstacles
+*/
+uint32_t NetKeyframeSize(uint32_t length, uint32_t obstacleCount);
+
+/*
+  Ce que le client sait de sa partie : ce que le serveur lui a envoyé en dernier
+*/
+struct NetSentState {
+    Cell head = NO_CELL;
+    uint32_t length = 0;
+    Cell fruit = NO_CELL;
+    std::vector<Cell> obstacles;
+    int score = 0;
+};
+
+/*
+  Écrit la Keyframe d'une partie
+  parametre "writer" Reçoit le message
+  parametre "state" La partie
+  parametre "sent" Mis à jour : le client connaîtra toute la partie
+  parametre "tick" Numéro du pas
+  parametre "ack" Dernier virage pris en compte
+  parametre "generation" Numéro de la partie dans la session
+  parametre "tickMicroseconds" Intervalle des pas
+*/
+void WriteKeyframe(NetWriter& writer, const SimState& state, NetSentState& sent, uint32_t tick, uint32_t ack,
+                   uint32_t generation, uint32_t tickMicroseconds);
+
+/*
+  Écrit le Delta d'un pas : ce qui a changé depuis "sent"
+  parametre "writer" Reçoit le message
+  parametre "state" La partie, après le pas
+  parametre "sent" Mis à jour avec les changements envoyés
+  parametre "tick" Numéro du pas
+  parametre "ack" Dernier virage pris en compte
+  retourne false si le pas ne s'écrit pas en Delta (plus d'un segment retiré) : envoyer une Keyframe
+*/
+bool WriteDelta(NetWriter& writer, const SimState& state, NetSentState& sent, uint32_t tick, uint32_t ack);
+
+/*
+  Lien vers un pair. Flux (tcp, unix) : les messages sont découpés d'après leur
+  taille, ceux à envoyer attendent dans une file si le système n'en prend qu'une
+  partie. Datagrammes : un message par datagramme, perdu si le système n'a plus
+  de place (compté dans "dropped"). Côté serveur, les clients udp partagent la
+  socket d'écoute : le lien ne sert alors qu'à envoyer, à l'adresse du client.
+*/
+class NetLink {
+public:
+    ~NetLink() { Close(); }
+
+    /*
+      Prend une socket non bloquante, fermée par Close (les files sont vidées)
+      parametre "socket" Socket de flux ou de datagrammes connectée
+      parametre "stream" true pour un flux
+    */
+    void Attach(int socket, bool stream);
+
+    /*
+      Envoie des datagrammes par une socket partagée (non fermée par Close)
+      parametre "socket" Socket d'écoute udp du serveur
+      parametre "address" Adresse du client
+    */
+    void AttachPeer(int socket, const NetPeerAddress& address);
+
+    void Close();
+
+    bool IsOpen() const { return socket >= 0; }
+    int Socket() const { return socket; }
+
+    /*
+      Envoie un message entier
+      retourne false si le lien est rompu, ou si un flux a plus de NET_OUTPUT_LIMIT
+      octets en attente (le pair ne lit plus) : le fermer
+    */
+    bool Send(const uint8_t* message, uint32_t size);
+    bool Send(const NetWriter& writer) { return Send(writer.data, writer.size); }
+
+    /*
+      Écrit ce qui attend dans la file d'un flux
+      retourne false si le lien est rompu
+    */
+    bool Flush();
+
+    /*
+      retourne true si des octets attendent que la socket accepte de les prendre
+    */
+    bool HasPendingOutput() const { return outputEnd > outputStart; }
+
+    /*
+      Lit ce qui est arrivé et appelle visit(data, size) pour chaque message complet
+      retourne false si le pair a fermé le lien ou si le lien est rompu
+    */
+    template <class Visit>
+    bool Receive(Visit&& visit) {
+        for (;;) {
+            const uint8_t* datagram = nullptr;
+            int received = ReadSome(datagram);
+            if (received < 0) {
+                return false;
+            }
+            if (received == 0) {
+                return true;
+            }
+            if (!stream) {
+                visit(datagram, (uint32_t)received);
+                continue;
+            }
+            // Messages complets en tête du tampon, le reste est ramené au début
+            uint32_t start = 0;
+            while (inputSize - start >= 2) {
+                uint32_t size = input[start] | (uint32_t)input[start + 1] << 8;
+                if (inputSize - start - 2 < size) {
+                    break;
+                }
+                visit(&input[start + 2], size);
+                start += 2 + size;
+            }
+            inputSize -= start;
+            if (inputSize > 0 && start > 0) {
+                std::copy(input.begin() + start, input.begin() + start + inputSize, input.begin());
+            }
+        }
+    }
+
+    uint64_t dropped = 0;  // Datagrammes perdus faute de place dans la file du système
+
+private:
+    /*
+      Lit ce que la socket a reçu : un flux à la suite de "input", un datagramme
+      dans un tampon du fil appelant (valable jusqu'à la lecture suivante)
+      parametre "datagram" Reçoit le datagramme lu
+      retourne Le nombre d'octets lus, 0 si rien n'est arrivé, -1 si le lien est fermé ou rompu
+    */
+    int ReadSome(const uint8_t*& datagram);
+
+    int socket = -1;
+    bool stream = false;
+    bool shared = false;                      // Socket d'écoute du serveur, à ne pas fermer
+    NetPeerAddress peer;                      // Adresse du client (socket partagée)
+    std::vector<uint8_t> input;               // Flux : octets reçus, pas encore découpés en messages
+    uint32_t inputSize = 0;
+    std::vector<uint8_t> output;              // Flux : octets en attente d'écriture
+    uint32_t outputStart = 0;
+    uint32_t outputEnd = 0;
+};
+
+/*
+  Copie de la partie côté client, tenue à jour par les messages du serveur
+*/
+class NetMirror {
+public:
+    /*
+      Applique un message du serveur (Keyframe ou Delta, les autres sont ignorés)
+      retourne true si la copie a changé ; false si le message a été ignoré ou si la
+      copie n'est plus à jour (voir NeedsResync)
+    */
+    bool Apply(const uint8_t* data, uint32_t size);
+
+    /*
+      Indique s'il faut demander une Keyframe (Resync) : juste après la perte d'un
+      message, puis tous les NET_RESYNC_RETRY messages ignorés (la demande a pu se perdre).
+      La demande est consommée par l'appel.
+    */
+    bool NeedsResync();
+
+    /*
+      Copie la partie dans un instantané, pour l'affichage (voir BoardRenderer), et vide
+      le journal des cases modifiées. Chaque Keyframe commence une nouvelle génération :
+      toute la grille est alors redessinée.
+      parametre "snapshot" L'instantané à remplir
+    */
+    void Capture(SimSnapshot& snapshot);
+
+    bool IsSynced() const { return synced; }
+    const GridShape& Grid() const { return grid; }
+    const SnakeBody& Body() const { return body; }
+    Cell Fruit() const { return fruit; }
+    const std::vector<Cell>& Obstacles() const { return obstacles; }
+    int Score() const { return score; }
+    bool IsStarted() const { return started; }
+    bool IsGameOver() const { return gameOver; }
+    uint32_t Tick() const { return tick; }
+    uint32_t Ack() const { return ack; }
+    uint32_t Generation() const { return generation; }
+    std::chrono::microseconds TickInterval() const { return tickInterval; }
+
+    /*
+      retourne true si la case est occupée par le serpent ou un obstacle
+    */
+    bool IsBlocked(Cell cell) const { return bodyCells.Test(cell) || obstacleCells.Test(cell); }
+
+    uint64_t keyframes = 0;    // Keyframes reçues
+    uint64_t deltas = 0;       // Delta appliqués
+    uint64_t losses = 0;       // Pertes de synchronisation (message manqué ou illisible)
+    uint64_t mismatches = 0;   // Keyframes différentes de la copie au même pas (erreur du protocole)
+    bool trackChanges = false; // Tient le journal des cases modifiées (affichage seulement)
+
+private:
+    bool ApplyKeyframe(NetReader& reader);
+    bool ApplyDelta(NetReader& reader);
+    void ReadState(uint8_t flags);
+    void Resize(const GridShape& shape);
+    bool ReadObstacles(NetReader& reader);
+    void SetObstacles();
+    void LoseSync();
+    void Change(Cell cell, CellContent content);
+
+    GridShape grid{ 0, 0 };
+    SnakeBody body;                      // Tête en premier
+    SnakeBody incoming;                  // Corps d'une Keyframe en cours de lecture (échangé avec "body")
+    Bitboard bodyCells;                  // Cases du serpent
+    Bitboard obstacleCells;              // Cases des obstacles
+    Cell fruit = NO_CELL;
+    std::vector<Cell> obstacles;
+    std::vector<Cell> incomingObstacles; // Obstacles d'un message en cours de lecture
+    int score = 0;
+    bool started = false;
+    bool gameOver = false;
+    bool synced = false;                 // La copie suit les pas du serveur
+    bool resyncWanted = false;           // Une Keyframe est à demander
+    uint32_t ignored = 0;                // Messages ignorés depuis la perte de synchronisation
+    uint32_t tick = 0;                   // Dernier pas appliqué
+    uint32_t ack = 0;                    // Dernier virage pris en compte par le serveur
+    uint32_t generation = 0;             // Partie de la session (numéro du serveur)
+    uint64_t frames = 0;                 // Keyframes appliquées (génération des instantanés)
+    uint64_t captures = 0;               // Instantanés remplis
+    std::chrono::microseconds tickInterval{ 0 };
+    InputClock::time_point appliedAt;    // Réception du dernier message appliqué
+    Cell previousHead = NO_CELL;         // Tête et queue avant le dernier Delta (interpolation)
+    Cell previousTail = NO_CELL;
+    std::vector<CellChange> changes;     // Cases modifiées depuis la dernière capture, dans l'ordre
+};
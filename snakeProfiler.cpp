@@ -0,0 +1,210 @@
+﻿#include "snakeProfiler.h"
+
+#ifdef SNAKE_PROFILING
+
+#include "snakeAllocations.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+// Événement de la trace (temps en nanosecondes depuis le lancement)
+struct TraceEvent {
+    const char* name;
+    int64_t start;
+    int64_t duration;
+};
+
+// Compteurs d'une image pour la trace
+struct FrameCounters {
+    int64_t time;
+    uint32_t drawCalls;
+    uint32_t allocations;
+};
+
+// Durée cumulée d'un bloc pendant l'image
+struct ScopeTotal {
+    const char* name;
+    double microseconds;
+    uint32_t calls;
+};
+
+// Mesures d'un fil. Jamais libérées : la trace reste lisible après la fin du fil.
+struct ThreadProfile {
+    uint32_t id = 0;
+    const char* name = nullptr;
+    ScopeTotal totals[PROFILE_MAX_SCOPES];
+    uint32_t totalCount = 0;
+    vector<TraceEvent> events;
+    uint64_t droppedEvents = 0;
+};
+
+static atomic<uint32_t> drawCalls{ 0 };
+static atomic<bool> tracing{ false };
+static string tracePath;
+static const ProfileClock::time_point epoch = ProfileClock::now();
+
+static mutex threadsMutex;
+static vector<ThreadProfile*> threads;
+
+// Image en cours et dernière image terminée (fil de l'affichage)
+static ProfileClock::time_point frameStart;
+static uint64_t frameAllocations = 0;
+static LatencyStats frameTimes;
+static ScopeTotal lastScopes[PROFILE_MAX_SCOPES];
+static uint32_t lastScopeCount = 0;
+static uint32_t lastDrawCalls = 0;
+static uint32_t lastAllocations = 0;
+static vector<FrameCounters> frameCounters;
+
+/*
+  retourne Les mesures du fil appelant, créées au premier appel
+*/
+static ThreadProfile& CurrentThread() {
+    thread_local ThreadProfile* profile = nullptr;
+    if (profile == nullptr) {
+        profile = new ThreadProfile();
+        lock_guard<mutex> lock(threadsMutex);
+        profile->id = (uint32_t)threads.size() + 1;
+        threads.push_back(profile);
+    }
+    return *profile;
+}
+
+static int64_t Nanoseconds(ProfileClock::duration duration) {
+    return chrono::duration_cast<chrono::nanoseconds>(duration).count();
+}
+
+void ProfileRecord(const char* name, ProfileClock::time_point start, ProfileClock::time_point end) {
+    ThreadProfile& thread = CurrentThread();
+    uint32_t i = 0;
+    while (i < thread.totalCount && thread.totals[i].name != name && strcmp(thread.totals[i].name, name) != 0) {
+        i++;
+    }
+    if (i == thread.totalCount && i < PROFILE_MAX_SCOPES) {
+        thread.totals[i] = { name, 0, 0 };
+        thread.totalCount++;
+    }
+    if (i < thread.totalCount) {
+        thread.totals[i].microseconds += chrono::duration<double, micro>(end - start).count();
+        thread.totals[i].calls++;
+    }
+
+    if (tracing.load(memory_order_relaxed)) {
+        if (thread.events.size() < PROFILE_MAX_EVENTS) {
+            thread.events.push_back({ name, Nanoseconds(start - epoch), Nanoseconds(end - start) });
+        }
+        else {
+            thread.droppedEvents++;
+        }
+    }
+}
+
+void ProfileCountDrawCall() {
+    drawCalls.fetch_add(1, memory_order_relaxed);
+}
+
+void ProfileNameThread(const char* name) {
+    CurrentThread().name = name;
+}
+
+void ProfileBeginFrame() {
+    ThreadProfile& thread = CurrentThread();
+    for (uint32_t i = 0; i < thread.totalCount; i++) {
+        thread.totals[i].microseconds = 0;
+        thread.totals[i].calls = 0;
+    }
+    drawCalls.store(0, memory_order_relaxed);
+    frameAllocations = AllocationCount();
+    frameStart = ProfileClock::now();
+}
+
+void ProfileEndFrame() {
+    ProfileClock::time_point end = ProfileClock::now();
+    ProfileRecord("frame", frameStart, end);
+    frameTimes.Add(chrono::duration<double, micro>(end - frameStart).count());
+
+    ThreadProfile& thread = CurrentThread();
+    lastScopeCount = 0;
+    for (uint32_t i = 0; i < thread.totalCount; i++) {
+        if (thread.totals[i].calls > 0) {
+            lastScopes[lastScopeCount++] = thread.totals[i];
+        }
+    }
+    lastDrawCalls = drawCalls.load(memory_order_relaxed);
+    lastAllocations = (uint32_t)(AllocationCount() - frameAllocations);
+    if (tracing.load(memory_order_relaxed) && frameCounters.size() < PROFILE_MAX_EVENTS) {
+        frameCounters.push_back({ Nanoseconds(end - epoch), lastDrawCalls, lastAllocations });
+    }
+}
+
+const LatencyStats& ProfileFrameTimes() {
+    return frameTimes;
+}
+
+string ProfileSummary() {
+    char line[128];
+    string text;
+    snprintf(line, sizeof(line), "frame p50 %.2f ms  p99 %.2f ms  max %.2f ms\n",
+        frameTimes.Percentile(50) / 1000, frameTimes.Percentile(99) / 1000, frameTimes.Max() / 1000);
+    text += line;
+    snprintf(line, sizeof(line), "draw calls %u  allocations %u\n", lastDrawCalls, lastAllocations);
+    text += line;
+    for (uint32_t i = 0; i < lastScopeCount; i++) {
+        if (lastScopes[i].calls > 1) {
+            snprintf(line, sizeof(line), "%s %.3f ms (x%u)\n", lastScopes[i].name, lastScopes[i].microseconds / 1000, lastScopes[i].calls);
+        }
+        else {
+            snprintf(line, sizeof(line), "%s %.3f ms\n", lastScopes[i].name, lastScopes[i].microseconds / 1000);
+        }
+        text += line;
+    }
+    return text;
+}
+
+void ProfileStartTrace(const string& path) {
+    tracePath = path;
+    tracing = true;
+}
+
+bool ProfileWriteTrace() {
+    if (!tracing) {
+        return false;
+    }
+    tracing = false;
+    FILE* file = fopen(tracePath.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // Événements complets ("X") par fil, puis compteurs ("C") de chaque image
+    lock_guard<mutex> lock(threadsMutex);
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    const char* separator = "";
+    uint64_t dropped = 0;
+    for (const ThreadProfile* thread : threads) {
+        if (thread->name != nullptr) {
+            fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+                separator, thread->id, thread->name);
+            separator = ",\n";
+        }
+        for (const TraceEvent& event : thread->events) {
+            fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                separator, event.name, thread->id, event.start / 1000.0, event.duration / 1000.0);
+            separator = ",\n";
+        }
+        dropped += thread->droppedEvents;
+    }
+    for (const FrameCounters& counters : frameCounters) {
+        fprintf(file, "%s{\"name\": \"frame\", \"ph\": \"C\", \"pid\": 1, \"ts\": %.3f, \"args\": {\"draw_calls\": %u, \"allocations\": %u}}",
+            separator, counters.time / 1000.0, counters.drawCalls, counters.allocations);
+        separator = ",\n";
+    }
+    fprintf(file, "\n], \"otherData\": {\"dropped_events\": %llu}}\n", (unsigned long long)dropped);
+    return fclose(file) == 0;
+}
+
+#endif
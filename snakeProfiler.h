@@ -0,0 +1,112 @@
+﻿// Mesure du temps passé dans chaque partie d'une image et d'un pas (sans dépendance à SFML)
+//
+// PROFILE_SCOPE("nom") mesure la durée du bloc qui l'entoure. Les mesures
+// alimentent le résumé affiché par le jeu (percentiles du temps d'image,
+// appels de dessin, allocations, durée de chaque bloc) et peuvent être
+// enregistrées dans un fichier trace_event JSON, à ouvrir avec
+// chrome://tracing ou ui.perfetto.dev.
+//
+// Tout n'existe qu'avec -DSNAKE_PROFILING : sans ce drapeau, les macros ne
+// produisent aucun code et snakeProfiler.cpp est vide. Les allocations sont
+// comptées par snakeAllocations.cpp, actif avec le même drapeau.
+
+#pragma once
+
+#ifdef SNAKE_PROFILING
+
+#include "snakeStats.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+using ProfileClock = std::chrono::steady_clock;
+
+const uint32_t PROFILE_MAX_SCOPES = 16;       // Noms de blocs différents suivis par fil
+const uint32_t PROFILE_MAX_EVENTS = 1 << 20;  // Événements gardés par fil pour la trace
+
+/*
+  Ajoute la mesure d'un bloc au fil appelant (résumé de l'image et trace)
+  parametre "name" Nom du bloc (chaîne littérale : seul le pointeur est gardé)
+  parametre "start" Début du bloc
+  parametre "end" Fin du bloc
+*/
+void ProfileRecord(const char* name, ProfileClock::time_point start, ProfileClock::time_point end);
+
+/*
+  Compte un appel de dessin de l'image en cours
+*/
+void ProfileCountDrawCall();
+
+/*
+  Nomme le fil appelant dans la trace
+*/
+void ProfileNameThread(const char* name);
+
+/*
+  Commence une image : remet à zéro les durées des blocs, les appels de dessin
+  et le compteur d'allocations de l'image (fil de l'affichage)
+*/
+void ProfileBeginFrame();
+
+/*
+  Termine l'image commencée par ProfileBeginFrame et garde ses mesures pour le résumé
+*/
+void ProfileEndFrame();
+
+/*
+  retourne Les durées des images mesurées, en microsecondes
+*/
+const LatencyStats& ProfileFrameTimes();
+
+/*
+  Résumé lisible de la dernière image : percentiles du temps d'image,
+  appels de dessin, allocations et durée de chaque bloc (une ligne par bloc)
+*/
+std::string ProfileSummary();
+
+/*
+  Commence à garder les événements pour la trace (avant de démarrer les autres fils)
+  parametre "path" Fichier JSON écrit par ProfileWriteTrace
+*/
+void ProfileStartTrace(const std::string& path);
+
+/*
+  Écrit la trace au format trace_event (une fois les autres fils arrêtés)
+  retourne false si aucune trace n'est en cours ou si le fichier ne peut pas être créé
+*/
+bool ProfileWriteTrace();
+
+/*
+  Mesure la durée de vie d'un objet (voir PROFILE_SCOPE)
+*/
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), start(ProfileClock::now()) {}
+    ~ProfileScope() { ProfileRecord(name, start, ProfileClock::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    ProfileClock::time_point start;
+};
+
+#define PROFILE_JOIN_NAMES(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_NAMES(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(name)
+#define PROFILE_DRAW_CALL() ProfileCountDrawCall()
+#define PROFILE_THREAD(name) ProfileNameThread(name)
+#define PROFILE_BEGIN_FRAME() ProfileBeginFrame()
+#define PROFILE_END_FRAME() ProfileEndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_DRAW_CALL() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_BEGIN_FRAME() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+
+#endif
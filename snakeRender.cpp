@@ -0,0 +1,273 @@
+﻿#include "snakeRender.h"
+#include "snakeProfiler.h"
+
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+// Couleur unie utilisée à la place d'une image manquante
+static const sf::Color TILE_COLORS[(int)CellContent::Count] = {
+    sf::Color::Transparent,
+    SNAKE_COLOR,
+    FOOD_COLOR,
+    OBSTACLES_COLOR
+};
+
+/*
+  Déplacement d'une case à sa voisine, en tenant compte de la traversée des bords
+  retourne Le pas (-1, 0 ou 1) sur chaque axe
+*/
+static sf::Vector2f StepBetween(const GridShape& grid, Cell from, Cell to) {
+    int dx = grid.CellX(to) - grid.CellX(from);
+    int dy = grid.CellY(to) - grid.CellY(from);
+    if (dx > 1) { dx = -1; } else if (dx < -1) { dx = 1; }
+    if (dy > 1) { dy = -1; } else if (dy < -1) { dy = 1; }
+    return sf::Vector2f((float)dx, (float)dy);
+}
+
+void BoardRenderer::Init(sf::Vector2f gridOrigin, sf::Vector2u maxViewCells) {
+    origin = gridOrigin;
+    maxView = maxViewCells;
+    const sf::Image* images[(int)CellContent::Count] = {};
+    BuildAtlas(images);
+    Resize(GridShape());
+}
+
+void BoardRenderer::SetTileImages(const sf::Image* const images[]) {
+    BuildAtlas(images);
+    WriteView();
+}
+
+void BoardRenderer::BuildAtlas(const sf::Image* const images[]) {
+    // Images côte à côte dans l'atlas ; une tuile sans image est une case de couleur unie
+    sf::Image fallbacks[(int)CellContent::Count];
+    const sf::Image* sources[(int)CellContent::Count] = {};
+    unsigned int atlasWidth = 0;
+    unsigned int atlasHeight = 0;
+    for (int kind = 1; kind < (int)CellContent::Count; kind++) {
+        sources[kind] = images[kind];
+        if (sources[kind] == nullptr) {
+            fallbacks[kind].resize(sf::Vector2u(TILE_SIZE, TILE_SIZE), TILE_COLORS[kind]);
+            sources[kind] = &fallbacks[kind];
+        }
+        atlasWidth += sources[kind]->getSize().x;
+        atlasHeight = max(atlasHeight, sources[kind]->getSize().y);
+    }
+
+    sf::Image atlasImage(sf::Vector2u(atlasWidth, atlasHeight), sf::Color::Transparent);
+    unsigned int x = 0;
+    for (int kind = 1; kind < (int)CellContent::Count; kind++) {
+        sf::Vector2u size = sources[kind]->getSize();
+        (void)atlasImage.copy(*sources[kind], sf::Vector2u(x, 0));
+        tileRects[kind] = sf::IntRect(sf::Vector2i(x, 0), sf::Vector2i(size));
+        x += size.x;
+    }
+    if (!atlas.loadFromImage(atlasImage)) {
+        std::cout << "Error creating tile atlas!" << std::endl;
+    }
+}
+
+void BoardRenderer::Resize(const GridShape& shape) {
+    grid = shape;
+    viewWidth = min(grid.width, (int)maxView.x);
+    viewHeight = min(grid.height, (int)maxView.y);
+    cameraX = 0;
+    cameraY = 0;
+
+    // Une tuile = deux triangles ; les cases de la vue puis la tête et la queue mobiles
+    headQuad = (uint32_t)(viewWidth * viewHeight);
+    tailQuad = headQuad + 1;
+    uint32_t quadCount = headQuad + 2;
+    vertices.resize(quadCount * 6);
+    tiles.assign(grid.CellCount(), CellContent::Empty);
+    for (uint32_t quad = 0; quad < quadCount; quad++) {
+        WriteQuad(quad, sf::Vector2f(0, 0), CellContent::Empty);
+    }
+    useVertexBuffer = sf::VertexBuffer::isAvailable() && vertexBuffer.create(quadCount * 6);
+    Upload(0, quadCount);
+}
+
+sf::Vector2f BoardRenderer::ViewPixelSize() const {
+    return sf::Vector2f((float)(viewWidth * TILE_SIZE), (float)(viewHeight * TILE_SIZE));
+}
+
+bool BoardRenderer::IsVisible(Cell cell) const {
+    int x = grid.CellX(cell) - cameraX;
+    int y = grid.CellY(cell) - cameraY;
+    return x >= 0 && x < viewWidth && y >= 0 && y < viewHeight;
+}
+
+sf::Vector2f BoardRenderer::ViewTopLeft(Cell cell) const {
+    return sf::Vector2f((float)((grid.CellX(cell) - cameraX) * TILE_SIZE), (float)((grid.CellY(cell) - cameraY) * TILE_SIZE));
+}
+
+void BoardRenderer::WriteQuad(uint32_t quad, sf::Vector2f topLeft, CellContent content) {
+    sf::Vertex* corners = &vertices[quad * 6];
+
+    // Case vide : triangles dégénérés, qui ne coûtent rien à la carte graphique
+    if (content == CellContent::Empty) {
+        for (int i = 0; i < 6; i++) {
+            corners[i].position = topLeft;
+        }
+        return;
+    }
+
+    float left = topLeft.x;
+    float top = topLeft.y;
+    float right = left + TILE_SIZE;
+    float bottom = top + TILE_SIZE;
+    const sf::IntRect& rect = tileRects[(int)content];
+    float u0 = (float)rect.position.x;
+    float v0 = (float)rect.position.y;
+    float u1 = u0 + rect.size.x;
+    float v1 = v0 + rect.size.y;
+
+    corners[0].position = sf::Vector2f(left, top);      corners[0].texCoords = sf::Vector2f(u0, v0);
+    corners[1].position = sf::Vector2f(right, top);     corners[1].texCoords = sf::Vector2f(u1, v0);
+    corners[2].position = sf::Vector2f(left, bottom);   corners[2].texCoords = sf::Vector2f(u0, v1);
+    corners[3].position = sf::Vector2f(left, bottom);   corners[3].texCoords = sf::Vector2f(u0, v1);
+    corners[4].position = sf::Vector2f(right, top);     corners[4].texCoords = sf::Vector2f(u1, v0);
+    corners[5].position = sf::Vector2f(right, bottom);  corners[5].texCoords = sf::Vector2f(u1, v1);
+}
+
+void BoardRenderer::WriteCell(Cell cell) {
+    if (!IsVisible(cell)) {
+        return;
+    }
+    uint32_t quad = (uint32_t)((grid.CellY(cell) - cameraY) * viewWidth + (grid.CellX(cell) - cameraX));
+    CellContent content = cell == hiddenCell ? CellContent::Empty : tiles[cell];
+    WriteQuad(quad, ViewTopLeft(cell), content);
+    Upload(quad, 1);
+}
+
+void BoardRenderer::WriteView() {
+    uint32_t quad = 0;
+    for (int y = 0; y < viewHeight; y++) {
+        for (int x = 0; x < viewWidth; x++, quad++) {
+            Cell cell = grid.MakeCell(cameraX + x, cameraY + y);
+            CellContent content = cell == hiddenCell ? CellContent::Empty : tiles[cell];
+            WriteQuad(quad, sf::Vector2f((float)(x * TILE_SIZE), (float)(y * TILE_SIZE)), content);
+        }
+    }
+    Upload(0, headQuad);
+}
+
+bool BoardRenderer::FollowHead(Cell head, bool center) {
+    int headX = grid.CellX(head);
+    int headY = grid.CellY(head);
+    int x = cameraX;
+    int y = cameraY;
+    if (center) {
+        x = headX - viewWidth / 2;
+        y = headY - viewHeight / 2;
+    }
+    else {
+        // Zone centrale où la tête peut se déplacer sans faire bouger la caméra
+        int marginX = viewWidth / 4;
+        int marginY = viewHeight / 4;
+        x = min(max(x, headX - viewWidth + 1 + marginX), headX - marginX);
+        y = min(max(y, headY - viewHeight + 1 + marginY), headY - marginY);
+    }
+    x = min(max(x, 0), grid.width - viewWidth);
+    y = min(max(y, 0), grid.height - viewHeight);
+    bool moved = x != cameraX || y != cameraY;
+    cameraX = x;
+    cameraY = y;
+    return moved;
+}
+
+void BoardRenderer::Upload(uint32_t firstQuad, uint32_t quadCount) {
+    if (useVertexBuffer) {
+        (void)vertexBuffer.update(&vertices[firstQuad * 6], quadCount * 6, firstQuad * 6);
+    }
+}
+
+void BoardRenderer::Rebuild(const SimSnapshot& snapshot) {
+    if (snapshot.grid != grid) {
+        Resize(snapshot.grid);
+    }
+    fill(tiles.begin(), tiles.end(), CellContent::Empty);
+    for (uint32_t chunk = 0; level != nullptr && chunk < level->ChunkCount(); chunk++) {
+        level->ForEachWall(chunk, [this](Cell wall) { tiles[wall] = CellContent::Obstacle; });
+    }
+    for (Cell obstacle : snapshot.obstacles) {
+        tiles[obstacle] = CellContent::Obstacle;
+    }
+    if (snapshot.fruitPosition != NO_CELL) {
+        tiles[snapshot.fruitPosition] = CellContent::Fruit;
+    }
+    for (Cell fruit : snapshot.fruits) {
+        tiles[fruit] = CellContent::Fruit;
+    }
+    for (Cell cell : snapshot.rivals) {
+        tiles[cell] = CellContent::Snake;
+    }
+    for (Cell cell : snapshot.body) {
+        tiles[cell] = CellContent::Snake;
+    }
+    hiddenCell = snapshot.body.front();
+    FollowHead(hiddenCell, true);
+    WriteView();
+}
+
+void BoardRenderer::Apply(const SimSnapshot& snapshot) {
+    if (snapshot.generation != lastGeneration || snapshot.sequence != lastSequence + 1) {
+        Rebuild(snapshot);
+    }
+    else {
+        for (const CellChange& change : snapshot.changes) {
+            if (change.content != tiles[change.cell]) {
+                tiles[change.cell] = change.content;
+                WriteCell(change.cell);
+            }
+        }
+        Cell head = snapshot.body.front();
+        if (head != hiddenCell) {
+            Cell previous = hiddenCell;
+            hiddenCell = head;
+            if (FollowHead(head, false)) {
+                WriteView();
+            }
+            else {
+                WriteCell(previous);
+                WriteCell(head);
+            }
+        }
+    }
+    lastSequence = snapshot.sequence;
+    lastGeneration = snapshot.generation;
+}
+
+void BoardRenderer::Interpolate(const SimSnapshot& snapshot, float alpha) {
+    alpha = min(max(alpha, 0.0f), 1.0f);
+    WriteMovingQuad(headQuad, snapshot.previousHead, snapshot.body.front(), alpha);
+    WriteMovingQuad(tailQuad, snapshot.previousTail, snapshot.body.back(), alpha);
+    Upload(headQuad, 2);
+}
+
+void BoardRenderer::WriteMovingQuad(uint32_t quad, Cell from, Cell to, float alpha) {
+    if (!IsVisible(to)) {
+        WriteQuad(quad, sf::Vector2f(0, 0), CellContent::Empty);
+    }
+    else if (!IsVisible(from)) {
+        // Arrivée par un bord de la vue : pas d'interpolation depuis une case non dessinée
+        WriteQuad(quad, ViewTopLeft(to), CellContent::Snake);
+    }
+    else {
+        sf::Vector2f step = StepBetween(grid, from, to);
+        WriteQuad(quad, ViewTopLeft(from) + step * (alpha * TILE_SIZE), CellContent::Snake);
+    }
+}
+
+void BoardRenderer::Draw(sf::RenderTarget& target) const {
+    sf::RenderStates states;
+    states.texture = &atlas;
+    states.transform.translate(origin);
+    if (useVertexBuffer) {
+        target.draw(vertexBuffer, states);
+    }
+    else {
+        target.draw(vertices, states);
+    }
+    PROFILE_DRAW_CALL();
+}
@@ -0,0 +1,163 @@
+﻿// SFML VERSION 3.0
+//
+// Affichage groupé de la grille : toutes les tuiles (serpent, nourriture,
+// obstacles) sont regroupées dans une seule texture (atlas) et dessinées
+// avec un seul tampon de sommets, soit un appel de dessin par image
+// quelle que soit la longueur du serpent.
+//
+// Sur une grande grille, seule une fenêtre de cases autour de la tête (la
+// caméra) a des sommets : le coût d'une image dépend de la vue, pas de la grille.
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "snakeLevel.h"
+#include "snakeSim.h"
+#include "snakeThread.h"
+
+#include <cstdint>
+#include <vector>
+
+// Taille d'une tuile en pixels
+const int TILE_SIZE = 30;
+
+// Couleurs de secours tant qu'une image de l'atlas n'est pas chargée (ou si elle ne peut pas l'être)
+const sf::Color FOOD_COLOR = sf::Color(255, 99, 71, 255);        // Tomate pour la nourriture
+const sf::Color SNAKE_COLOR = sf::Color(50, 205, 50, 255);       // Vert lime pour le serpent
+const sf::Color OBSTACLES_COLOR = sf::Color(105, 105, 105, 255); // Gris foncé pour les obstacles
+
+/*
+  Dessine la grille de jeu en un seul appel, à partir des instantanés de la simulation.
+  La tête et la queue sont deux tuiles mobiles, interpolées entre deux pas ;
+  les autres cases ne sont réécrites que lorsqu'elles changent et sont visibles.
+  La caméra suit la tête, et ne se déplace que lorsque celle-ci s'approche du bord de la vue.
+*/
+class BoardRenderer {
+public:
+    /*
+      Construit un atlas de couleurs unies (en attendant les images) et prépare les sommets.
+      Doit être appelé après la création de la fenêtre (contexte OpenGL).
+      parametre "origin" Position en pixels du coin supérieur gauche de la grille
+      parametre "maxViewCells" Nombre maximal de cases affichées sur chaque axe
+    */
+    void Init(sf::Vector2f origin, sf::Vector2u maxViewCells);
+
+    /*
+      Reconstruit l'atlas avec les images des tuiles, au fur et à mesure de leur chargement
+      parametre "images" Image de chaque contenu de case (nullptr : couleur de secours)
+    */
+    void SetTileImages(const sf::Image* const images[]);
+
+    /*
+      Dessine les murs d'un niveau (lus dans le niveau, pas dans les instantanés)
+      parametre "wallLevel" Le niveau joué, nullptr : aucun mur
+    */
+    void SetLevel(const Level* wallLevel) { level = wallLevel; }
+
+    /*
+      Met à jour les cases à partir d'un instantané. Si l'instantané suit
+      directement le précédent, seules ses cases modifiées sont réécrites ;
+      sinon (nouvelle partie, instantané manqué) toute la grille est reconstruite.
+      parametre "snapshot" L'instantané à afficher
+    */
+    void Apply(const SimSnapshot& snapshot);
+
+    /*
+      Place la tête et la queue entre leur position au pas précédent et leur position actuelle
+      parametre "snapshot" L'instantané affiché
+      parametre "alpha" Avancement entre les deux pas, de 0 à 1
+    */
+    void Interpolate(const SimSnapshot& snapshot, float alpha);
+
+    /*
+      Dessine la grille
+      parametre "target" La cible où dessiner (fenêtre ou texture)
+    */
+    void Draw(sf::RenderTarget& target) const;
+
+    /*
+      retourne La taille en pixels de la zone dessinée (la vue)
+    */
+    sf::Vector2f ViewPixelSize() const;
+
+private:
+    /*
+      Assemble l'atlas ; les tuiles sans image sont des cases de couleur unie
+    */
+    void BuildAtlas(const sf::Image* const images[]);
+
+    /*
+      Dimensionne la vue et les sommets pour une grille
+    */
+    void Resize(const GridShape& shape);
+
+    /*
+      Reconstruit toute la grille à partir d'un instantané
+    */
+    void Rebuild(const SimSnapshot& snapshot);
+
+    /*
+      Déplace la caméra si la tête sort de la zone centrale de la vue
+      parametre "head" La case de la tête
+      parametre "center" Centrer la vue sur la tête plutôt que la déplacer au minimum
+      retourne true si la caméra a bougé
+    */
+    bool FollowHead(Cell head, bool center);
+
+    /*
+      Réécrit toutes les tuiles visibles (après un déplacement de la caméra)
+    */
+    void WriteView();
+
+    /*
+      Réécrit la tuile fixe d'une case si elle est visible
+      (la case de la tête reste vide : la tête est mobile)
+    */
+    void WriteCell(Cell cell);
+
+    /*
+      retourne true si la case est dans la vue
+    */
+    bool IsVisible(Cell cell) const;
+
+    /*
+      retourne Le coin supérieur gauche d'une case, en pixels depuis le coin de la vue
+    */
+    sf::Vector2f ViewTopLeft(Cell cell) const;
+
+    /*
+      Place une tuile mobile entre deux cases, ou la masque si sa case n'est pas visible
+    */
+    void WriteMovingQuad(uint32_t quad, Cell from, Cell to, float alpha);
+
+    /*
+      Écrit les six sommets (deux triangles) d'une tuile
+    */
+    void WriteQuad(uint32_t quad, sf::Vector2f topLeft, CellContent content);
+
+    /*
+      Envoie des tuiles modifiées à la carte graphique
+    */
+    void Upload(uint32_t firstQuad, uint32_t quadCount);
+
+    sf::Texture atlas;                                     // Toutes les tuiles dans une seule texture
+    sf::IntRect tileRects[(int)CellContent::Count];        // Rectangle de chaque tuile dans l'atlas
+    sf::VertexArray vertices{ sf::PrimitiveType::Triangles };  // Copie en mémoire des sommets
+    sf::VertexBuffer vertexBuffer{ sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Dynamic };
+    bool useVertexBuffer = false;                          // Tampon sur la carte graphique disponible
+    std::vector<CellContent> tiles;                        // Contenu de chaque case de la grille
+    GridShape grid{ 0, 0 };                                // Grille des tuiles
+    sf::Vector2u maxView;                                  // Taille maximale de la vue, en cases
+    int viewWidth = 0;                                     // Taille de la vue, en cases
+    int viewHeight = 0;
+    int cameraX = 0;                                       // Case du coin supérieur gauche de la vue
+    int cameraY = 0;
+    uint32_t headQuad = 0;                                 // Tuile mobile de la tête (après les cases de la vue)
+    uint32_t tailQuad = 0;                                 // Tuile mobile de la queue
+    Cell hiddenCell = NO_CELL;                             // Case de la tête (dessinée par la tuile mobile)
+    uint64_t lastSequence = 0;                             // Dernier instantané appliqué
+    uint64_t lastGeneration = 0;                           // Partie du dernier instantané
+    sf::Vector2f origin;                                   // Décalage de la grille dans la fenêtre
+    const Level* level = nullptr;                          // Murs à dessiner
+};
@@ -0,0 +1,682 @@
+﻿#include "snakeReplay.h"
+
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+static const char REPLAY_MAGIC[4] = { 'S', 'N', 'K', 'R' };
+static const uint16_t REPLAY_VERSION = 2;
+static const size_t FILE_HEADER_SIZE = 12;
+static const size_t CHUNK_HEADER_SIZE = 5;
+static const size_t BLOCK_PREFIX_SIZE = 12;  // Partie, pas de la keyframe, nombre de pas
+static const uint8_t BLOCK_CHUNK = 'B';
+static const uint8_t END_CHUNK = 'E';
+static const uint16_t NO_CELL16 = 0xFFFF;
+static const uint8_t FULL_STATE = 0;   // Keyframe complète
+static const uint8_t GAME_SEED = 1;    // Début de partie : la graine suffit (ResetState)
+static const size_t SPARE_BLOCKS = 2;    // Tampons d'avance : fin de partie et nouveau bloc sans attendre le disque
+static const size_t QUEUE_CAPACITY = 16; // Blocs en attente d'écriture sans agrandir les files
+static const uint32_t RESERVED_BODY = 4096;           // Cases du corps prévues dans un bloc (au-delà, il grandit)
+static const size_t SPARE_RESERVE_LIMIT = 16 << 20;   // Taille de bloc au-delà de laquelle les tampons d'avance ne sont pas réservés
+
+// Écriture d'entiers petit-boutistes
+static void Put8(vector<uint8_t>& out, uint8_t value) { out.push_back(value); }
+static void Put16(vector<uint8_t>& out, uint16_t value) {
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+static void Put32(vector<uint8_t>& out, uint32_t value) {
+    Put16(out, (uint16_t)value);
+    Put16(out, (uint16_t)(value >> 16));
+}
+static void Put64(vector<uint8_t>& out, uint64_t value) {
+    Put32(out, (uint32_t)value);
+    Put32(out, (uint32_t)(value >> 32));
+}
+static void Patch32(vector<uint8_t>& out, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[offset + i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/*
+  Lecture d'entiers petit-boutistes dans un tampon, sans jamais déborder :
+  une lecture hors limites renvoie 0 et met "ok" à false
+*/
+struct ByteReader {
+    const uint8_t* data;
+    size_t size;
+    size_t position = 0;
+    bool ok = true;
+
+    ByteReader(const uint8_t* bytes, size_t byteCount) : data(bytes), size(byteCount) {}
+
+    uint32_t Read(int byteCount) {
+        if (position + byteCount > size) {
+            ok = false;
+            return 0;
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < byteCount; i++) {
+            value |= (uint32_t)data[position + i] << (8 * i);
+        }
+        position += byteCount;
+        return value;
+    }
+    uint8_t U8() { return (uint8_t)Read(1); }
+    uint16_t U16() { return (uint16_t)Read(2); }
+    uint32_t U32() { return Read(4); }
+    uint64_t U64() {
+        uint64_t low = U32();
+        return low | (uint64_t)U32() << 32;
+    }
+};
+
+/*
+  retourne La direction obtenue par un quart de tour à gauche
+*/
+static SimAction LeftOf(SimAction direction) {
+    switch (direction) {
+    case SimAction::Right: return SimAction::Up;
+    case SimAction::Up: return SimAction::Left;
+    case SimAction::Left: return SimAction::Down;
+    case SimAction::Down: return SimAction::Right;
+    default: return SimAction::None;
+    }
+}
+
+ReplayTurn EncodeTurn(SimAction directionBefore, bool startedBefore, const SimState& after) {
+    SimAction direction = CurrentDirection(after);
+    if (direction == directionBefore) {
+        return startedBefore ? ReplayTurn::Straight : ReplayTurn::Start;
+    }
+    return direction == LeftOf(directionBefore) ? ReplayTurn::Left : ReplayTurn::Right;
+}
+
+SimAction DecodeTurn(ReplayTurn turn, const SimState& state) {
+    SimAction direction = CurrentDirection(state);
+    switch (turn) {
+    case ReplayTurn::Start: return direction;
+    case ReplayTurn::Left: return LeftOf(direction);
+    case ReplayTurn::Right: return OppositeAction(LeftOf(direction));
+    default: return SimAction::None;
+    }
+}
+
+/*
+  retourne La taille d'une case dans le fichier : 2 octets si la grille le permet, sinon 4
+*/
+static int CellBytes(const GridShape& grid) {
+    return grid.CellCount() < 0xFFFF ? 2 : 4;
+}
+
+static void PutCell(vector<uint8_t>& out, Cell cell, int cellBytes) {
+    if (cellBytes == 2) {
+        Put16(out, cell == NO_CELL ? NO_CELL16 : (uint16_t)cell);
+    }
+    else {
+        Put32(out, cell);
+    }
+}
+
+static Cell ReadCell(ByteReader& reader, int cellBytes) {
+    if (cellBytes == 2) {
+        uint16_t cell = reader.U16();
+        return cell == NO_CELL16 ? NO_CELL : cell;
+    }
+    return reader.U32();
+}
+
+/*
+  Écrit l'état d'une partie (tout ce dont dépendent les pas suivants).
+  Au début d'une partie, la graine de ResetState suffit ; ensuite l'état est
+  écrit en entier, y compris l'ordre des cases libres dont dépendent les tirages.
+  parametre "out" Tampon de sortie
+  parametre "state" L'état à écrire
+*/
+static void WriteState(vector<uint8_t>& out, const SimState& state) {
+    if (state.tick == 0 && !state.started) {
+        Put8(out, GAME_SEED);
+        Put64(out, state.gameSeed);
+        Put8(out, (uint8_t)state.obstacleCount);
+        return;
+    }
+    int cellBytes = CellBytes(state.grid);
+    Put8(out, FULL_STATE);
+    Put64(out, state.rng);
+    Put8(out, (uint8_t)state.obstacleCount);
+    Put8(out, (uint8_t)(int8_t)state.dirX);
+    Put8(out, (uint8_t)(int8_t)state.dirY);
+    Put8(out, (uint8_t)((state.started ? 1 : 0) | (state.shouldGrow ? 2 : 0) | (state.gameOver ? 4 : 0)));
+    Put32(out, (uint32_t)state.score);
+    PutCell(out, state.fruitPosition, cellBytes);
+    Put32(out, (uint32_t)state.obstacles.size());
+    for (Cell obstacle : state.obstacles) {
+        PutCell(out, obstacle, cellBytes);
+    }
+    // Corps de la queue vers la tête, dans l'ordre de PushHead
+    Put32(out, state.body.Length());
+    state.body.ForEachFromTail([&](Cell cell) { PutCell(out, cell, cellBytes); });
+    Put32(out, state.freeCells.Count());
+    for (uint32_t i = 0; i < state.freeCells.Size(); i++) {
+        PutCell(out, state.freeCells.At(i), cellBytes);
+    }
+}
+
+/*
+  Lit un état écrit par WriteState
+  parametre "reader" Position dans le bloc
+  parametre "state" L'état à remplacer (déjà initialisé par InitState aux bonnes dimensions)
+  parametre "order" Tampon de travail pour l'ordre des cases libres
+  retourne false si les données sont incohérentes
+*/
+static bool ReadState(ByteReader& reader, SimState& state, vector<Cell>& order) {
+    uint8_t kind = reader.U8();
+    if (kind == GAME_SEED) {
+        state.rng = reader.U64();
+        state.obstacleCount = reader.U8();
+        ResetState(state);
+        return reader.ok;
+    }
+    if (kind != FULL_STATE) {
+        return false;
+    }
+    int cellBytes = CellBytes(state.grid);
+    uint32_t cellCount = state.grid.CellCount();
+    state.rng = reader.U64();
+    state.obstacleCount = reader.U8();
+    state.dirX = (int8_t)reader.U8();
+    state.dirY = (int8_t)reader.U8();
+    uint8_t flags = reader.U8();
+    state.started = (flags & 1) != 0;
+    state.shouldGrow = (flags & 2) != 0;
+    state.gameOver = (flags & 4) != 0;
+    state.score = (int32_t)reader.U32();
+    state.fruitPosition = ReadCell(reader, cellBytes);
+    if (state.fruitPosition != NO_CELL && state.fruitPosition >= cellCount) {
+        return false;
+    }
+
+    state.obstacleCells.Clear();
+    state.blockedCells.Clear();
+    state.obstacles.clear();
+    uint32_t obstacleCount = reader.U32();
+    if (obstacleCount > cellCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < obstacleCount && reader.ok; i++) {
+        Cell obstacle = ReadCell(reader, cellBytes);
+        if (obstacle >= cellCount) {
+            return false;
+        }
+        state.obstacles.push_back(obstacle);
+        state.obstacleCells.Set(obstacle);
+        state.blockedCells.Set(obstacle);
+    }
+
+    state.body.Clear();
+    uint32_t length = reader.U32();
+    if (length == 0 || length > cellCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < length && reader.ok; i++) {
+        Cell cell = ReadCell(reader, cellBytes);
+        if (cell >= cellCount) {
+            return false;
+        }
+        state.body.PushHead(cell);
+        state.blockedCells.Set(cell);
+    }
+
+    uint32_t freeCount = reader.U32();
+    order.resize(cellCount);
+    for (Cell& cell : order) {
+        cell = ReadCell(reader, cellBytes);
+        if (cell >= cellCount) {
+            return false;
+        }
+    }
+    if (!reader.ok || freeCount > cellCount) {
+        return false;
+    }
+    state.freeCells.Load(order.data(), freeCount);
+    state.changedCells.clear();
+    state.fullRefresh = true;
+    return true;
+}
+
+/*
+  retourne Le virage numéro "index" dans une suite de virages à 2 bits
+*/
+static ReplayTurn TurnAt(const uint8_t* turns, uint32_t index) {
+    return (ReplayTurn)((turns[index >> 2] >> ((index & 3) * 2)) & 3);
+}
+
+/*
+  Lit et vérifie l'en-tête d'un fichier
+  parametre "grid" Reçoit les dimensions de la grille enregistrée
+  retourne false si ce n'est pas un enregistrement lisible
+*/
+static bool ReadFileHeader(FILE* file, GridShape& grid) {
+    uint8_t header[FILE_HEADER_SIZE];
+    if (fread(header, 1, FILE_HEADER_SIZE, file) != FILE_HEADER_SIZE || memcmp(header, REPLAY_MAGIC, 4) != 0) {
+        return false;
+    }
+    ByteReader reader(header + 4, FILE_HEADER_SIZE - 4);
+    uint16_t version = reader.U16();
+    grid.width = reader.U16();
+    grid.height = reader.U16();
+    return version == REPLAY_VERSION &&
+        grid.width >= MIN_GRID_SIZE && grid.width <= MAX_GRID_SIZE &&
+        grid.height >= MIN_GRID_SIZE && grid.height <= MAX_GRID_SIZE;
+}
+
+/*
+  Lit l'en-tête d'un bloc
+  retourne false en fin de fichier
+*/
+static bool ReadChunkHeader(FILE* file, uint8_t& type, uint32_t& length) {
+    uint8_t header[CHUNK_HEADER_SIZE];
+    if (fread(header, 1, CHUNK_HEADER_SIZE, file) != CHUNK_HEADER_SIZE) {
+        return false;
+    }
+    type = header[0];
+    length = ByteReader(header + 1, 4).U32();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Écriture
+
+bool ReplayWriter::Open(const string& path, const GridShape& grid) {
+    Close();
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    vector<uint8_t> header(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    Put16(header, REPLAY_VERSION);
+    Put16(header, (uint16_t)grid.width);
+    Put16(header, (uint16_t)grid.height);
+    Put16(header, (uint16_t)REPLAY_KEYFRAME_INTERVAL);
+    writeFailed = fwrite(header.data(), 1, header.size(), file) != header.size();
+
+    // Un bloc habituel : keyframe (ordre de toutes les cases, obstacles, corps d'au plus
+    // RESERVED_BODY cases) et virages. Un corps plus long agrandit le tampon à la keyframe
+    // suivante, une fois par taille atteinte puisque les tampons gardent leur capacité.
+    // Les tampons d'avance évitent d'attendre le disque tant qu'il n'a pas plus de
+    // SPARE_BLOCKS blocs de retard ; sur les très grandes grilles, ils ne sont pas réservés
+    // d'avance et grandissent à leur premier usage.
+    uint32_t cellCount = grid.CellCount();
+    size_t blockCapacity = CHUNK_HEADER_SIZE + BLOCK_PREFIX_SIZE + 64 + REPLAY_KEYFRAME_INTERVAL / 4
+                         + (size_t)CellBytes(grid) * (cellCount + UINT8_MAX + min(cellCount, RESERVED_BODY));
+    block.reserve(blockCapacity);
+    pending.reserve(QUEUE_CAPACITY);
+    spare.reserve(QUEUE_CAPACITY);
+    while (blockCapacity <= SPARE_RESERVE_LIMIT && spare.size() < SPARE_BLOCKS) {
+        spare.emplace_back();
+        spare.back().reserve(blockCapacity);
+    }
+    gameIndex = 0;
+    inGame = false;
+    closing = false;
+    writer = thread(&ReplayWriter::WriterLoop, this);
+    return true;
+}
+
+void ReplayWriter::BeginGame(const SimState& state) {
+    if (file == nullptr) {
+        return;
+    }
+    // Partie abandonnée sans fin : ses pas sont gardés, comme pour une session interrompue
+    if (inGame) {
+        FlushBlock();
+        gameIndex++;
+    }
+    inGame = true;
+    StartBlock(state);
+}
+
+void ReplayWriter::StartBlock(const SimState& state) {
+    block.clear();
+    Put8(block, BLOCK_CHUNK);
+    Put32(block, 0);
+    Put32(block, gameIndex);
+    Put32(block, (uint32_t)state.tick);
+    ticksOffset = block.size();
+    Put32(block, 0);
+    WriteState(block, state);
+    blockTicks = 0;
+}
+
+void ReplayWriter::RecordTick(ReplayTurn turn, const SimState& state) {
+    if (!inGame) {
+        return;
+    }
+    if ((blockTicks & 3) == 0) {
+        block.push_back(0);
+    }
+    block.back() |= (uint8_t)turn << ((blockTicks & 3) * 2);
+    blockTicks++;
+    if (blockTicks == REPLAY_KEYFRAME_INTERVAL) {
+        FlushBlock();
+        StartBlock(state);
+    }
+}
+
+void ReplayWriter::FlushBlock() {
+    Patch32(block, ticksOffset, blockTicks);
+    Patch32(block, 1, (uint32_t)(block.size() - CHUNK_HEADER_SIZE));
+    Send(block);
+}
+
+void ReplayWriter::EndGame(const SimState& state) {
+    if (!inGame) {
+        return;
+    }
+    // Un bloc sans pas (partie finie pile sur une keyframe) n'apporte rien
+    if (blockTicks > 0) {
+        FlushBlock();
+    }
+    block.clear();
+    Put8(block, END_CHUNK);
+    Put32(block, 12);
+    Put32(block, gameIndex);
+    Put32(block, (uint32_t)state.tick);
+    Put32(block, (uint32_t)state.score);
+    Send(block);
+    gameIndex++;
+    inGame = false;
+}
+
+void ReplayWriter::Send(vector<uint8_t>& chunk) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        pending.emplace_back();
+        pending.back().swap(chunk);
+        if (!spare.empty()) {
+            chunk.swap(spare.back());
+            spare.pop_back();
+        }
+    }
+    chunk.clear();
+    queueSignal.notify_one();
+}
+
+void ReplayWriter::WriterLoop() {
+    vector<vector<uint8_t>> batch;
+    batch.reserve(QUEUE_CAPACITY);
+    for (;;) {
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueSignal.wait(lock, [this] { return closing || !pending.empty(); });
+            if (pending.empty()) {
+                return;
+            }
+            batch.swap(pending);
+        }
+        // Après un échec, les blocs suivants sont abandonnés : le fichier s'arrête au dernier bloc complet
+        for (const vector<uint8_t>& chunk : batch) {
+            if (!writeFailed && fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size()) {
+                writeFailed = true;
+            }
+        }
+        if (!writeFailed && fflush(file) != 0) {
+            writeFailed = true;
+        }
+        {
+            lock_guard<mutex> lock(queueMutex);
+            for (vector<uint8_t>& chunk : batch) {
+                spare.emplace_back();
+                spare.back().swap(chunk);
+            }
+        }
+        batch.clear();
+    }
+}
+
+bool ReplayWriter::Close() {
+    if (file == nullptr) {
+        return true;
+    }
+    // Partie interrompue : ses pas sont gardés, sans bloc de fin
+    if (inGame) {
+        FlushBlock();
+        inGame = false;
+    }
+    {
+        lock_guard<mutex> lock(queueMutex);
+        closing = true;
+    }
+    queueSignal.notify_one();
+    writer.join();
+    bool written = !writeFailed;
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    file = nullptr;
+    writeFailed = false;
+    return written;
+}
+
+// ---------------------------------------------------------------------------
+// Relecture
+
+bool ReplayReader::Open(const string& path) {
+    Close();
+    file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    if (fseek(file, 0, SEEK_END) != 0) {
+        Close();
+        return false;
+    }
+    long fileSize = ftell(file);
+    rewind(file);
+    if (!ReadFileHeader(file, grid)) {
+        Close();
+        return false;
+    }
+
+    // Index : seuls les en-têtes sont lus, le contenu des blocs est sauté
+    uint8_t type;
+    uint32_t length;
+    long offset = ftell(file);
+    while (ReadChunkHeader(file, type, length)) {
+        // Dernier bloc tronqué (session coupée pendant l'écriture) : ignoré
+        uint8_t prefix[BLOCK_PREFIX_SIZE];
+        if (offset + (long)(CHUNK_HEADER_SIZE + length) > fileSize || length < BLOCK_PREFIX_SIZE || fread(prefix, 1, BLOCK_PREFIX_SIZE, file) != BLOCK_PREFIX_SIZE) {
+            break;
+        }
+        ByteReader reader(prefix, BLOCK_PREFIX_SIZE);
+        uint32_t game = reader.U32();
+        uint32_t tick = reader.U32();
+        uint32_t ticks = reader.U32();
+        // Parties numérotées à la suite par l'écrivain : un numéro plus loin ou un pas
+        // hors limites est une corruption, l'index s'arrête là comme pour un bloc tronqué
+        if (game > games.size() || (type == BLOCK_CHUNK && tick > UINT32_MAX - ticks)) {
+            break;
+        }
+        if (game == games.size()) {
+            games.emplace_back();
+        }
+        GameEntry& entry = games[game];
+        if (type == BLOCK_CHUNK) {
+            if (entry.blockCount == 0) {
+                entry.firstBlock = (uint32_t)blocks.size();
+            }
+            entry.blockCount++;
+            entry.ticks = max(entry.ticks, tick + ticks);
+            blocks.push_back({ game, tick, ticks, offset });
+        }
+        else if (type == END_CHUNK) {
+            entry.finished = true;
+        }
+        if (fseek(file, (long)(length - BLOCK_PREFIX_SIZE), SEEK_CUR) != 0) {
+            break;
+        }
+        offset = ftell(file);
+    }
+    return true;
+}
+
+void ReplayReader::Close() {
+    if (file != nullptr) {
+        fclose(file);
+        file = nullptr;
+    }
+    blocks.clear();
+    games.clear();
+}
+
+bool ReplayReader::LoadBlock(uint32_t blockIndex, SimState& state) {
+    const BlockEntry& entry = blocks[blockIndex];
+    uint8_t type;
+    uint32_t length;
+    if (fseek(file, entry.offset, SEEK_SET) != 0 || !ReadChunkHeader(file, type, length)) {
+        return false;
+    }
+    payload.resize(length);
+    if (fread(payload.data(), 1, length, file) != length) {
+        return false;
+    }
+    if (state.grid != grid || state.freeCells.Size() != grid.CellCount()) {
+        state.grid = grid;
+        InitState(state, 0);
+    }
+
+    ByteReader reader(payload.data(), payload.size());
+    reader.position = BLOCK_PREFIX_SIZE;
+    if (!ReadState(reader, state, order) || reader.position + ((uint64_t)entry.ticks + 3) / 4 > payload.size()) {
+        return false;
+    }
+    state.tick = entry.tick;
+    turnsOffset = reader.position;
+    currentGame = entry.game;
+    currentBlock = blockIndex;
+    blockPosition = 0;
+    return true;
+}
+
+bool ReplayReader::Seek(uint32_t game, uint32_t tick, SimState& state) {
+    if (game >= games.size() || games[game].blockCount == 0 || tick > games[game].ticks) {
+        return false;
+    }
+    // Dernière keyframe avant le pas demandé, puis au plus un bloc de pas rejoués
+    const GameEntry& entry = games[game];
+    uint32_t blockIndex = entry.firstBlock;
+    for (uint32_t i = entry.firstBlock; i < entry.firstBlock + entry.blockCount; i++) {
+        if (blocks[i].tick <= tick) {
+            blockIndex = i;
+        }
+    }
+    if (!LoadBlock(blockIndex, state)) {
+        return false;
+    }
+    SimOutcome outcome;
+    while (state.tick < tick) {
+        if (!Next(state, outcome)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReplayReader::Next(SimState& state, SimOutcome& outcome) {
+    while (blockPosition == blocks[currentBlock].ticks) {
+        uint32_t next = currentBlock + 1;
+        if (next >= blocks.size() || blocks[next].game != currentGame || !LoadBlock(next, state)) {
+            return false;
+        }
+    }
+    ReplayTurn turn = TurnAt(&payload[turnsOffset], blockPosition);
+    outcome = Step(state, DecodeTurn(turn, state));
+    blockPosition++;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Vérification en masse
+
+bool ValidateReplay(const string& path, ReplayReport& report) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        report.error = "cannot open " + path;
+        return false;
+    }
+    SimState state;
+    long fileSize = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    rewind(file);
+    if (fileSize < 0 || !ReadFileHeader(file, state.grid)) {
+        fclose(file);
+        report.error = "not a replay file: " + path;
+        return false;
+    }
+    InitState(state, 0);
+    vector<uint8_t> payload;
+    vector<uint8_t> expected;
+    vector<Cell> order;
+    bool haveGame = false;
+    uint32_t currentGame = 0;
+
+    uint8_t type;
+    uint32_t length;
+    while (ReadChunkHeader(file, type, length)) {
+        // Longueur lue avant l'allocation : un en-tête corrompu ne réserve pas des gigaoctets
+        if ((long)length > fileSize - ftell(file)) {
+            report.error = "corrupt chunk in " + path;
+            break;
+        }
+        payload.resize(length);
+        if (fread(payload.data(), 1, length, file) != length) {
+            report.error = "truncated chunk in " + path;
+            break;
+        }
+        ByteReader reader(payload.data(), payload.size());
+        uint32_t game = reader.U32();
+        uint32_t tick = reader.U32();
+        uint32_t ticks = reader.U32();
+        if (!reader.ok) {
+            report.error = "corrupt chunk in " + path;
+            break;
+        }
+
+        if (type == BLOCK_CHUNK) {
+            // Keyframe suivante d'une partie en cours : elle doit être identique à l'état rejoué
+            size_t stateStart = reader.position;
+            bool continues = haveGame && game == currentGame && tick != 0;
+            if (continues) {
+                expected.clear();
+                WriteState(expected, state);
+                if (tick != state.tick || stateStart + expected.size() > payload.size() ||
+                    memcmp(&payload[stateStart], expected.data(), expected.size()) != 0) {
+                    report.mismatches++;
+                }
+            }
+            if (!ReadState(reader, state, order) || reader.position + ((uint64_t)ticks + 3) / 4 > payload.size()) {
+                report.error = "corrupt keyframe in " + path;
+                break;
+            }
+            state.tick = tick;
+            haveGame = true;
+            currentGame = game;
+
+            const uint8_t* turns = &payload[reader.position];
+            for (uint32_t i = 0; i < ticks; i++) {
+                Step(state, DecodeTurn(TurnAt(turns, i), state));
+            }
+            report.ticks += ticks;
+        }
+        else if (type == END_CHUNK) {
+            // Ici "tick" est le nombre de pas de la partie et "ticks" son score
+            if (!haveGame || game != currentGame || !state.gameOver || state.tick != tick || state.score != (int32_t)ticks) {
+                report.mismatches++;
+            }
+            report.games++;
+            haveGame = false;
+        }
+    }
+    fclose(file);
+    return report.error.empty() && report.mismatches == 0;
+}
@@ -0,0 +1,223 @@
+﻿// Enregistrement et relecture des parties (sans dépendance à SFML)
+//
+// Une partie est entièrement déterminée par l'état du générateur au départ
+// et par les virages joués : le fichier ne garde que 2 bits par pas
+// (tout droit, gauche, droite, départ), relatifs à la direction courante.
+// Le flux est découpé en blocs commençant chacun par une image complète de
+// l'état (keyframe) : aller à un pas quelconque ne rejoue qu'un bloc.
+//
+// Format (petit-boutiste) :
+//   en-tête  "SNKR", version u16, largeur u16, hauteur u16, intervalle u16
+//   cases    u16 si la grille a moins de 65535 cases, sinon u32
+//   blocs    type u8, longueur u32, contenu
+//     'B' : partie u32, pas u32, nombre de pas u32, état complet (keyframe), virages (4 par octet)
+//     'E' : fin de partie (partie u32, nombre de pas u32, score i32)
+
+#pragma once
+
+#include "snakeSim.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Nombre de pas entre deux keyframes (borne le coût d'un déplacement dans la relecture)
+const uint32_t REPLAY_KEYFRAME_INTERVAL = 4096;
+
+/*
+  Virage d'un pas, relatif à la direction avant le pas
+*/
+enum class ReplayTurn : uint8_t {
+    Straight,  // Direction inchangée
+    Left,      // Quart de tour à gauche
+    Right,     // Quart de tour à droite
+    Start      // Premier pas de la partie, sans virage
+};
+
+/*
+  Code le virage joué lors d'un pas
+  parametre "directionBefore" Direction avant le pas
+  parametre "startedBefore" La partie avait-elle commencé avant le pas
+  parametre "after" L'état après le pas
+  retourne Le virage à enregistrer
+*/
+ReplayTurn EncodeTurn(SimAction directionBefore, bool startedBefore, const SimState& after);
+
+/*
+  Retrouve l'action qui rejoue un virage
+  parametre "turn" Le virage enregistré
+  parametre "state" L'état avant le pas
+  retourne L'action à passer à Step
+*/
+SimAction DecodeTurn(ReplayTurn turn, const SimState& state);
+
+/*
+  Enregistre les parties d'une session. L'écriture sur disque se fait sur un
+  fil séparé : le fil qui joue ne fait que remplir un bloc en mémoire.
+*/
+class ReplayWriter {
+public:
+    ~ReplayWriter() { Close(); }
+
+    /*
+      Crée le fichier et écrit l'en-tête
+      parametre "path" Chemin du fichier
+      parametre "grid" Dimensions de la grille des parties enregistrées
+      retourne false si le fichier ne peut pas être créé
+    */
+    bool Open(const std::string& path, const GridShape& grid);
+
+    bool IsOpen() const { return file != nullptr; }
+
+    /*
+      Commence une nouvelle partie (après InitState ou ResetState).
+      Une partie en cours sans EndGame est gardée comme interrompue.
+    */
+    void BeginGame(const SimState& state);
+
+    /*
+      Enregistre un pas joué (ni attente, ni partie terminée)
+      parametre "turn" Le virage du pas
+      parametre "state" L'état après le pas
+    */
+    void RecordTick(ReplayTurn turn, const SimState& state);
+
+    /*
+      Termine la partie en cours
+    */
+    void EndGame(const SimState& state);
+
+    /*
+      Écrit les données en attente et ferme le fichier
+      retourne false si une écriture a échoué (disque plein...) : l'enregistrement est incomplet
+    */
+    bool Close();
+
+private:
+    void StartBlock(const SimState& state);
+    void FlushBlock();
+    void Send(std::vector<uint8_t>& chunk);
+    void WriterLoop();
+
+    FILE* file = nullptr;
+    uint32_t gameIndex = 0;
+    bool inGame = false;
+    std::vector<uint8_t> block;                 // Bloc en cours de remplissage
+    uint32_t blockTicks = 0;                    // Pas déjà dans le bloc
+    size_t ticksOffset = 0;                     // Position du nombre de pas dans le bloc
+
+    std::thread writer;
+    std::mutex queueMutex;
+    std::condition_variable queueSignal;
+    std::vector<std::vector<uint8_t>> pending;  // Blocs à écrire
+    std::vector<std::vector<uint8_t>> spare;    // Tampons réutilisables
+    bool closing = false;
+    bool writeFailed = false;                   // Écriture refusée (lu par Close après la fin du fil)
+};
+
+/*
+  Relit un fichier de parties. L'ouverture ne lit que les en-têtes des blocs
+  pour construire l'index des keyframes ; Seek ne rejoue ensuite qu'un bloc.
+*/
+class ReplayReader {
+public:
+    ~ReplayReader() { Close(); }
+
+    /*
+      Ouvre un fichier et indexe ses blocs
+      retourne false si le fichier est absent ou n'est pas un enregistrement
+    */
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return file != nullptr; }
+
+    uint32_t GameCount() const { return (uint32_t)games.size(); }
+
+    /*
+      retourne Les dimensions de la grille enregistrée
+    */
+    const GridShape& Grid() const { return grid; }
+
+    /*
+      retourne Le nombre de pas enregistrés pour une partie
+    */
+    uint32_t GameTicks(uint32_t game) const { return games[game].ticks; }
+
+    /*
+      retourne true si la fin de la partie a été enregistrée (sinon session interrompue)
+    */
+    bool GameFinished(uint32_t game) const { return games[game].finished; }
+
+    /*
+      Place la relecture au pas "tick" d'une partie
+      parametre "game" Numéro de la partie
+      parametre "tick" Nombre de pas déjà joués (0 : début de partie)
+      parametre "state" Reçoit l'état à ce pas (initialisé aux dimensions enregistrées)
+      retourne false si ce pas n'existe pas dans le fichier
+    */
+    bool Seek(uint32_t game, uint32_t tick, SimState& state);
+
+    /*
+      Rejoue le pas suivant de la partie courante
+      parametre "state" L'état, avancé d'un pas
+      parametre "outcome" Reçoit le résultat du pas
+      retourne false si la partie n'a plus de pas enregistrés
+    */
+    bool Next(SimState& state, SimOutcome& outcome);
+
+    /*
+      retourne La partie courante
+    */
+    uint32_t CurrentGame() const { return currentGame; }
+
+private:
+    struct BlockEntry {
+        uint32_t game;
+        uint32_t tick;     // Pas de la keyframe
+        uint32_t ticks;    // Pas enregistrés dans le bloc
+        long offset;       // Position du bloc dans le fichier
+    };
+    struct GameEntry {
+        uint32_t firstBlock = 0;
+        uint32_t blockCount = 0;
+        uint32_t ticks = 0;
+        bool finished = false;
+    };
+
+    bool LoadBlock(uint32_t blockIndex, SimState& state);
+
+    FILE* file = nullptr;
+    GridShape grid;
+    std::vector<BlockEntry> blocks;
+    std::vector<GameEntry> games;
+    std::vector<uint8_t> payload;  // Bloc courant
+    std::vector<Cell> order;       // Ordre des cases libres lu dans une keyframe
+    uint32_t currentGame = 0;
+    uint32_t currentBlock = 0;
+    uint32_t blockPosition = 0;    // Pas déjà rejoués dans le bloc courant
+    size_t turnsOffset = 0;        // Début des virages dans "payload"
+};
+
+/*
+  Résultat de la vérification d'un fichier
+*/
+struct ReplayReport {
+    uint64_t games = 0;         // Parties terminées et vérifiées
+    uint64_t ticks = 0;         // Pas rejoués
+    uint64_t mismatches = 0;    // Keyframes ou fins de partie différentes de la relecture
+    std::string error;          // Fichier illisible ou tronqué
+};
+
+/*
+  Vérifie un fichier en un seul passage séquentiel : chaque partie est
+  rejouée depuis sa première keyframe, et chaque keyframe et score final
+  suivants sont comparés à l'état obtenu.
+  parametre "path" Chemin du fichier
+  parametre "report" Reçoit le résultat
+  retourne true si le fichier est lisible et que tout concorde
+*/
+bool ValidateReplay(const std::string& path, ReplayReport& report);
@@ -0,0 +1,245 @@
+﻿// Vérification en masse des enregistrements de parties, sans affichage
+//
+// Compilation : g++ -std=c++17 -O2 -pthread snakeReplayCheck.cpp snakeAutopilot.cpp snakeReplay.cpp snakeSim.cpp
+//               snakeStats.cpp -o snakeReplayCheck
+// Utilisation : ./snakeReplayCheck fichier.snkr [...]            vérifie les fichiers (un fil par cœur)
+//               ./snakeReplayCheck --seek partie pas fichier.snkr  affiche l'état à un pas donné
+//               ./snakeReplayCheck --generate parties fichier.snkr enregistre des parties jouées au hasard
+//               ./snakeReplayCheck --generate parties LxH fichier.snkr  idem sur une grille LxH
+//               ./snakeReplayCheck --solve parties LxH obstacles fichier.snkr
+//                                  enregistre des parties jouées par le pilote automatique
+
+#include "snakeAutopilot.h"
+#include "snakeReplay.h"
+#include "snakeSim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/*
+  Enregistre des parties jouées au hasard (données de test)
+  parametre "gameCount" Nombre de parties
+  parametre "path" Fichier à créer
+  parametre "grid" Dimensions de la grille
+  retourne Code de sortie
+*/
+static int Generate(uint32_t gameCount, const char* path, const GridShape& grid) {
+    ReplayWriter writer;
+    SimState state;
+    state.grid = grid;
+    InitState(state, 42);
+    if (!writer.Open(path, state.grid)) {
+        cerr << "cannot create " << path << endl;
+        return 1;
+    }
+    uint64_t inputRng = 7;
+    writer.BeginGame(state);
+    for (uint32_t game = 0; game < gameCount; ) {
+        SimAction directionBefore = CurrentDirection(state);
+        bool startedBefore = state.started;
+        SimOutcome outcome = Step(state, (SimAction)RandomBelow(inputRng, 5));
+        if (outcome != SimOutcome::Waiting) {
+            writer.RecordTick(EncodeTurn(directionBefore, startedBefore, state), state);
+        }
+        if (state.gameOver) {
+            writer.EndGame(state);
+            game++;
+            ResetState(state);
+            if (game < gameCount) {
+                writer.BeginGame(state);
+            }
+        }
+    }
+    if (!writer.Close()) {
+        cerr << "error writing " << path << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+  Fait jouer le pilote automatique et enregistre ses parties (test d'endurance,
+  parties parfaites). Une partie sans nourriture pendant quatre fois le nombre
+  de cases est abandonnée : elle reste dans le fichier, sans fin.
+  parametre "gameCount" Nombre de parties
+  parametre "grid" Dimensions de la grille
+  parametre "obstacleCount" Obstacles replacés à chaque nourriture
+  parametre "path" Fichier à créer
+  retourne Code de sortie (1 si une partie est perdue ou abandonnée, ou le fichier incomplet)
+*/
+static int Solve(uint32_t gameCount, const GridShape& grid, int obstacleCount, const char* path) {
+    ReplayWriter writer;
+    SimState state;
+    state.grid = grid;
+    state.obstacleCount = obstacleCount;
+    InitState(state, 42);
+    if (!writer.Open(path, state.grid)) {
+        cerr << "cannot create " << path << endl;
+        return 1;
+    }
+    Autopilot autopilot;
+    uint32_t won = 0;
+    uint32_t lost = 0;
+    uint32_t stalled = 0;
+    uint64_t totalTicks = 0;
+    uint64_t lastFruitTick = 0;
+    uint64_t stallTicks = 4 * (uint64_t)state.grid.CellCount();
+    auto start = chrono::steady_clock::now();
+    writer.BeginGame(state);
+    for (uint32_t game = 0; game < gameCount; ) {
+        SimAction directionBefore = CurrentDirection(state);
+        bool startedBefore = state.started;
+        SimOutcome outcome = Step(state, autopilot.Decide(state));
+        if (outcome != SimOutcome::Waiting) {
+            writer.RecordTick(EncodeTurn(directionBefore, startedBefore, state), state);
+        }
+        if (outcome == SimOutcome::AteFruit) {
+            lastFruitTick = state.tick;
+        }
+        if (state.gameOver || state.tick - lastFruitTick > stallTicks) {
+            if (outcome == SimOutcome::BoardFull) {
+                won++;
+            }
+            else if (state.gameOver) {
+                lost++;
+            }
+            else {
+                stalled++;
+            }
+            if (state.gameOver) {
+                writer.EndGame(state);
+            }
+            totalTicks += state.tick;
+            game++;
+            ResetState(state);
+            lastFruitTick = 0;
+            if (game < gameCount) {
+                writer.BeginGame(state);
+            }
+        }
+    }
+    bool written = writer.Close();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "grid " << state.grid.width << "x" << state.grid.height << ", " << obstacleCount << " obstacles" << endl;
+    cout << "games: " << gameCount << " (" << won << " won, " << lost << " lost, " << stalled << " stalled)" << endl;
+    cout << "ticks: " << totalTicks << " (" << (uint64_t)(totalTicks / seconds) << " ticks/sec)" << endl;
+    cout << "moves: " << autopilot.cycleMoves << " cycle, " << autopilot.pathMoves << " path, "
+         << autopilot.detourMoves << " detour" << endl;
+    cout << "decisions: " << autopilot.decisionLatency.Summary() << endl;
+    if (!written) {
+        cerr << "error writing " << path << endl;
+        return 1;
+    }
+    return won == gameCount ? 0 : 1;
+}
+
+/*
+  Rejoue une partie jusqu'à un pas et affiche l'état obtenu
+  retourne Code de sortie
+*/
+static int Seek(uint32_t game, uint32_t tick, const char* path) {
+    ReplayReader reader;
+    if (!reader.Open(path)) {
+        cerr << "cannot read " << path << endl;
+        return 1;
+    }
+    SimState state;
+    auto start = chrono::steady_clock::now();
+    if (!reader.Seek(game, tick, state)) {
+        cerr << "no tick " << tick << " in game " << game << " (" << reader.GameCount() << " games)" << endl;
+        return 1;
+    }
+    double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "grid " << state.grid.width << "x" << state.grid.height << ", game " << game << " tick " << state.tick << " of " << reader.GameTicks(game)
+         << ": score " << state.score << ", length " << state.body.Length()
+         << ", head (" << state.grid.CellX(state.body.Head()) << ", " << state.grid.CellY(state.body.Head()) << ")"
+         << ", seek " << milliseconds << " ms" << endl;
+    return 0;
+}
+
+/*
+  Vérifie des fichiers en parallèle, chaque fil prenant le fichier suivant
+  retourne Code de sortie (1 si un fichier est illisible ou incohérent)
+*/
+static int Validate(const vector<const char*>& paths) {
+    atomic<size_t> nextPath{ 0 };
+    atomic<uint64_t> totalGames{ 0 };
+    atomic<uint64_t> totalTicks{ 0 };
+    atomic<uint32_t> failures{ 0 };
+    mutex outputMutex;
+
+    auto worker = [&]() {
+        for (size_t i = nextPath++; i < paths.size(); i = nextPath++) {
+            ReplayReport report;
+            if (!ValidateReplay(paths[i], report)) {
+                failures++;
+                lock_guard<mutex> lock(outputMutex);
+                cout << paths[i] << ": " << (report.error.empty() ? "mismatch" : report.error)
+                     << " (" << report.mismatches << " mismatches)" << endl;
+            }
+            totalGames += report.games;
+            totalTicks += report.ticks;
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    uint32_t threadCount = min<uint32_t>(max(1u, thread::hardware_concurrency()), (uint32_t)paths.size());
+    vector<thread> threads;
+    for (uint32_t t = 1; t < threadCount; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "files: " << paths.size() << " (" << failures << " failed)" << endl;
+    cout << "games: " << totalGames << endl;
+    cout << "ticks: " << totalTicks << endl;
+    cout << "ticks/sec: " << (uint64_t)(totalTicks / seconds) << endl;
+    return failures == 0 ? 0 : 1;
+}
+
+/*
+  Fonction principale de l'outil
+  retourne Code de sortie
+*/
+int main(int argc, char** argv)
+{
+    if (argc == 4 && strcmp(argv[1], "--generate") == 0) {
+        return Generate((uint32_t)strtoul(argv[2], nullptr, 10), argv[3], GridShape());
+    }
+    if (argc == 5 && strcmp(argv[1], "--generate") == 0) {
+        GridShape grid;
+        if (!ParseGridShape(argv[3], grid)) {
+            cerr << "bad grid size: " << argv[3] << endl;
+            return 1;
+        }
+        return Generate((uint32_t)strtoul(argv[2], nullptr, 10), argv[4], grid);
+    }
+    if (argc == 6 && strcmp(argv[1], "--solve") == 0) {
+        GridShape grid;
+        if (!ParseGridShape(argv[3], grid)) {
+            cerr << "bad grid size: " << argv[3] << endl;
+            return 1;
+        }
+        return Solve((uint32_t)strtoul(argv[2], nullptr, 10), grid, atoi(argv[4]), argv[5]);
+    }
+    if (argc == 5 && strcmp(argv[1], "--seek") == 0) {
+        return Seek((uint32_t)strtoul(argv[2], nullptr, 10), (uint32_t)strtoul(argv[3], nullptr, 10), argv[4]);
+    }
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " replay.snkr [...]" << endl;
+        return 1;
+    }
+    return Validate(vector<const char*>(argv + 1, argv + argc));
+}
@@ -0,0 +1,49 @@
+﻿#include "snakeResources.h"
+#include "snakeAssets.h"
+#include "snakeProfiler.h"
+
+#include <iostream>
+using namespace std;
+
+const sf::Font& ResourceCache::GetFont(const string& path) {
+    unique_ptr<sf::Font>& font = fonts[path];
+    if (!font) {
+        font = make_unique<sf::Font>();
+        string resolved = ResolveAssetPath(path);
+        if (resolved.empty() || !font->openFromFile(resolved)) {
+            std::cout << "Error loading font!" << std::endl;
+        }
+    }
+    return *font;
+}
+
+CachedText::CachedText(const sf::Font& font, unsigned int size, sf::Color color, sf::Vector2f position)
+    : text(font) {
+    text.setCharacterSize(size);
+    text.setFillColor(color);
+    text.setPosition(position);
+}
+
+void CachedText::SetString(const string& value) {
+    if (value != current) {
+        current = value;
+        text.setString(current);
+    }
+    hasNumber = false;
+}
+
+void CachedText::SetNumber(const char* prefix, int value) {
+    if (hasNumber && value == currentNumber) {
+        return;
+    }
+    current = prefix;
+    current += to_string(value);
+    text.setString(current);
+    currentNumber = value;
+    hasNumber = true;
+}
+
+void CachedText::Draw(sf::RenderTarget& target) const {
+    target.draw(text);
+    PROFILE_DRAW_CALL();
+}
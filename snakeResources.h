@@ -0,0 +1,78 @@
+﻿// SFML VERSION 3.0
+//
+// Cache des polices chargées une seule fois au démarrage, et textes mis en
+// forme seulement lorsque leur contenu change (les images sont chargées par
+// AssetLoader, voir snakeAssets.h).
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+
+// Police utilisée pour tous les textes du jeu
+const std::string FONT_PATH = "./Font/Heavitas.ttf";
+
+/*
+  Cache des polices : chaque fichier n'est lu qu'une fois,
+  les références rendues restent valables tant que le cache existe.
+*/
+class ResourceCache {
+public:
+    /*
+      Donne une police, chargée au premier appel
+      parametre "path" Chemin du fichier de police (casse indifférente, voir ResolveAssetPath)
+      retourne La police (vide si le chargement a échoué)
+    */
+    const sf::Font& GetFont(const std::string& path);
+
+private:
+    std::map<std::string, std::unique_ptr<sf::Font>> fonts;  // Polices par chemin
+};
+
+/*
+  Texte dont la mise en page n'est refaite que lorsque le contenu change
+*/
+class CachedText {
+public:
+    /*
+      Constructeur du texte
+      parametre "font" Police (doit rester valable, voir ResourceCache)
+      parametre "size" Taille des caractères
+      parametre "color" Couleur du texte
+      parametre "position" Position du texte dans la fenêtre
+    */
+    CachedText(const sf::Font& font, unsigned int size, sf::Color color, sf::Vector2f position);
+
+    /*
+      Change le texte s'il est différent du texte affiché
+      parametre "value" Nouveau texte
+    */
+    void SetString(const std::string& value);
+
+    /*
+      Affiche un nombre précédé d'un préfixe ; rien n'est refait si le nombre n'a pas changé
+      parametre "prefix" Texte placé devant le nombre
+      parametre "value" Nombre à afficher
+    */
+    void SetNumber(const char* prefix, int value);
+
+    /*
+      Dessine le texte
+      parametre "target" La cible où dessiner
+    */
+    void Draw(sf::RenderTarget& target) const;
+
+    /*
+      retourne Le rectangle occupé par le texte dans la fenêtre
+    */
+    sf::FloatRect Bounds() const { return text.getGlobalBounds(); }
+
+private:
+    sf::Text text;            // Texte SFML (géométrie des glyphes en cache)
+    std::string current;      // Texte actuellement affiché
+    int currentNumber = 0;    // Nombre affiché par SetNumber
+    bool hasNumber = false;   // SetNumber a déjà été appelé
+};
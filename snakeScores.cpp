@@ -0,0 +1,234 @@
+﻿#include "snakeScores.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+using namespace std;
+
+static const char LOG_MAGIC[4] = { 'S', 'N', 'K', 'S' };
+static const char INDEX_MAGIC[4] = { 'S', 'N', 'K', 'T' };
+static const uint16_t SCORE_VERSION = 1;
+
+// En-tête du journal
+struct ScoreLogHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint64_t count;          // Enregistrements valides (mis à jour après chaque ajout)
+    uint8_t reserved[48];
+};
+static_assert(sizeof(ScoreLogHeader) == sizeof(ScoreRecord), "en-tête de la taille d'un enregistrement");
+
+// En-tête de l'index
+struct ScoreIndexHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t capacity;
+    uint32_t count;          // Entrées du classement
+    uint32_t crc;            // CRC-32 de l'en-tête (crc à 0) et des entrées
+    uint64_t covered;        // Parties du journal déjà prises en compte
+};
+
+// Une place du classement
+struct ScoreIndexEntry {
+    int32_t score;
+    uint32_t reserved;
+    uint64_t record;
+};
+
+static const uint64_t INDEX_SIZE = sizeof(ScoreIndexHeader) + SCORE_TOP_CAPACITY * sizeof(ScoreIndexEntry);
+
+uint32_t Crc32(uint32_t crc, const void* data, size_t size) {
+    struct Table {
+        uint32_t values[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                }
+                values[i] = value;
+            }
+        }
+    };
+    static const Table table;
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void SetPlayerName(ScoreRecord& record, const string& name) {
+    memset(record.player, 0, sizeof(record.player));
+    memcpy(record.player, name.data(), min(name.size(), sizeof(record.player)));
+}
+
+bool ScoreStore::Open(const string& path) {
+    Close();
+    if (!log.Open(path + ".log", true)) {
+        return false;
+    }
+    if (log.Size() == 0) {
+        if (!log.Resize(sizeof(ScoreLogHeader) + SCORE_LOG_GROWTH * sizeof(ScoreRecord))) {
+            Close();
+            return false;
+        }
+        ScoreLogHeader& header = Header();
+        memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+        header.version = SCORE_VERSION;
+        header.recordSize = sizeof(ScoreRecord);
+        header.count = 0;
+    }
+    if (log.Size() < sizeof(ScoreLogHeader) || memcmp(Header().magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 ||
+        Header().version != SCORE_VERSION || Header().recordSize != sizeof(ScoreRecord)) {
+        Close();
+        return false;
+    }
+    capacity = (log.Size() - sizeof(ScoreLogHeader)) / sizeof(ScoreRecord);
+    RecoverCount();
+    if (!LoadIndex(path + ".top")) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ScoreStore::Close() {
+    log.Close();
+    index.Close();
+    count = 0;
+    capacity = 0;
+}
+
+ScoreLogHeader& ScoreStore::Header() {
+    return *(ScoreLogHeader*)log.Data();
+}
+
+ScoreIndexHeader& ScoreStore::TopHeader() {
+    return *(ScoreIndexHeader*)index.Data();
+}
+
+const ScoreIndexHeader& ScoreStore::TopHeader() const {
+    return *(const ScoreIndexHeader*)index.Data();
+}
+
+ScoreIndexEntry* ScoreStore::TopEntries() {
+    return (ScoreIndexEntry*)(index.Data() + sizeof(ScoreIndexHeader));
+}
+
+const ScoreIndexEntry* ScoreStore::TopEntries() const {
+    return (const ScoreIndexEntry*)(index.Data() + sizeof(ScoreIndexHeader));
+}
+
+const ScoreRecord& ScoreStore::Record(uint64_t record) const {
+    return ((const ScoreRecord*)(log.Data() + sizeof(ScoreLogHeader)))[record];
+}
+
+bool ScoreStore::IsValid(uint64_t record) const {
+    const ScoreRecord& entry = Record(record);
+    return entry.sequence == record + 1 && entry.crc == Crc32(0, &entry, offsetof(ScoreRecord, crc));
+}
+
+void ScoreStore::RecoverCount() {
+    // Le nombre de l'en-tête est écrit après l'enregistrement : s'il désigne un
+    // enregistrement abîmé (écriture sur disque dans le désordre), on reprend du début
+    count = min(Header().count, capacity);
+    if (count > 0 && !IsValid(count - 1)) {
+        count = 0;
+    }
+    while (count < capacity && IsValid(count)) {
+        count++;
+    }
+    Header().count = count;
+}
+
+bool ScoreStore::LoadIndex(const string& path) {
+    if (!index.Open(path, true)) {
+        return false;
+    }
+    if (index.Size() != INDEX_SIZE && !index.Resize(INDEX_SIZE)) {
+        return false;
+    }
+    ScoreIndexHeader& header = TopHeader();
+    uint32_t crc = header.crc;
+    header.crc = 0;
+    bool valid = memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 && header.version == SCORE_VERSION &&
+        header.capacity == SCORE_TOP_CAPACITY && header.count <= SCORE_TOP_CAPACITY && header.covered <= count &&
+        crc == Crc32(Crc32(0, &header, sizeof(header)), TopEntries(), header.count * sizeof(ScoreIndexEntry));
+    header.crc = crc;
+
+    // Index absent ou abîmé : reconstruit à partir de tout le journal
+    if (!valid) {
+        memset(index.Data(), 0, INDEX_SIZE);
+        memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.version = SCORE_VERSION;
+        header.capacity = SCORE_TOP_CAPACITY;
+    }
+    // Seules les parties ajoutées après la dernière mise à jour de l'index sont relues
+    for (uint64_t record = header.covered; record < count; record++) {
+        InsertTop(Record(record).score, record);
+    }
+    SealIndex();
+    return true;
+}
+
+void ScoreStore::InsertTop(int32_t score, uint64_t record) {
+    ScoreIndexHeader& header = TopHeader();
+    ScoreIndexEntry* entries = TopEntries();
+    if (header.count == SCORE_TOP_CAPACITY && entries[header.count - 1].score >= score) {
+        return;
+    }
+    // Après les scores égaux : à score égal, la partie la plus ancienne reste devant
+    uint32_t position = header.count;
+    while (position > 0 && entries[position - 1].score < score) {
+        position--;
+    }
+    uint32_t last = min(header.count, SCORE_TOP_CAPACITY - 1);
+    memmove(entries + position + 1, entries + position, (last - position) * sizeof(ScoreIndexEntry));
+    entries[position] = { score, 0, record };
+    header.count = last + 1;
+}
+
+void ScoreStore::SealIndex() {
+    ScoreIndexHeader& header = TopHeader();
+    header.covered = count;
+    header.crc = 0;
+    header.crc = Crc32(Crc32(0, &header, sizeof(header)), TopEntries(), header.count * sizeof(ScoreIndexEntry));
+    index.Flush(0, INDEX_SIZE);
+}
+
+bool ScoreStore::Add(const ScoreRecord& record) {
+    if (!IsOpen()) {
+        return false;
+    }
+    if (count == capacity) {
+        if (!log.Resize(log.Size() + SCORE_LOG_GROWTH * sizeof(ScoreRecord))) {
+            return false;
+        }
+        capacity += SCORE_LOG_GROWTH;
+    }
+
+    // Enregistrement complet d'abord, puis nombre de l'en-tête
+    ScoreRecord& entry = ((ScoreRecord*)(log.Data() + sizeof(ScoreLogHeader)))[count];
+    entry = record;
+    entry.sequence = count + 1;
+    entry.crc = Crc32(0, &entry, offsetof(ScoreRecord, crc));
+    count++;
+    Header().count = count;
+    log.Flush(sizeof(ScoreLogHeader) + (count - 1) * sizeof(ScoreRecord), sizeof(ScoreRecord));
+    log.Flush(0, sizeof(ScoreLogHeader));
+
+    InsertTop(entry.score, count - 1);
+    SealIndex();
+    return true;
+}
+
+uint32_t ScoreStore::TopCount() const {
+    return index.IsOpen() ? TopHeader().count : 0;
+}
+
+const ScoreRecord& ScoreStore::Top(uint32_t rank) const {
+    return Record(TopEntries()[rank].record);
+}
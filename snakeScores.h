@@ -0,0 +1,143 @@
+﻿// Meilleurs scores enregistrés sur disque (sans dépendance à SFML)
+//
+// Chaque partie terminée est ajoutée à un journal d'enregistrements de taille
+// fixe, projeté en mémoire. Chaque enregistrement porte son numéro et une
+// somme de contrôle (CRC-32) : après un arrêt brutal, un enregistrement
+// incomplet est ignoré puis réécrit, les précédents restent intacts.
+// L'en-tête garde le nombre d'enregistrements valides ; à l'ouverture, seuls
+// ceux écrits après la dernière mise à jour de ce nombre sont relus.
+//
+// Les meilleurs scores sont tenus à jour dans un index séparé, lui aussi
+// projeté : le classement se lit sans parcourir le journal, quelle que soit
+// sa taille. Un index absent ou abîmé est reconstruit en un passage.
+//
+// Format (ordre des octets de la machine, petit-boutiste sur les cibles du jeu) :
+//   .log  en-tête de 64 octets : "SNKS", version u16, taille d'un enregistrement u16, nombre u64
+//         puis les enregistrements (ScoreRecord, 64 octets), par blocs de SCORE_LOG_GROWTH
+//   .top  en-tête : "SNKT", version u16, capacité u16, nombre u32, CRC-32 u32, parties couvertes u64
+//         puis les entrées (score i32, numéro de l'enregistrement u64), du meilleur au moins bon
+
+#pragma once
+
+#include "snakeMappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+const uint32_t SCORE_TOP_CAPACITY = 100;    // Scores gardés dans l'index
+const uint32_t SCORE_LOG_GROWTH = 4096;     // Enregistrements ajoutés au journal à chaque agrandissement
+const uint32_t SCORE_PLAYER_LENGTH = 20;    // Taille maximale du nom du joueur
+
+/*
+  Une partie terminée, telle qu'écrite dans le journal
+*/
+struct ScoreRecord {
+    uint64_t sequence = 0;                  // Numéro de l'enregistrement + 1 (0 : emplacement libre)
+    uint64_t seed = 0;                      // Graine de la partie (rejouable)
+    int64_t time = 0;                       // Fin de la partie, en secondes depuis 1970
+    int32_t score = 0;
+    uint32_t length = 0;                    // Longueur finale du serpent
+    uint32_t ticks = 0;                     // Pas joués
+    uint32_t durationMs = 0;                // Durée de la partie
+    char player[SCORE_PLAYER_LENGTH] = {};  // Nom du joueur (terminé par 0 s'il est plus court)
+    uint32_t crc = 0;                       // CRC-32 des octets précédents
+};
+static_assert(sizeof(ScoreRecord) == 64, "ScoreRecord fait partie du format du journal");
+
+struct ScoreLogHeader;
+struct ScoreIndexHeader;
+struct ScoreIndexEntry;
+
+/*
+  Copie un nom de joueur dans un enregistrement (tronqué si besoin)
+*/
+void SetPlayerName(ScoreRecord& record, const std::string& name);
+
+/*
+  CRC-32 (polynôme 0xEDB88320, celui de zip et png)
+  parametre "crc" Valeur précédente (0 au départ)
+*/
+uint32_t Crc32(uint32_t crc, const void* data, size_t size);
+
+/*
+  Journal des parties et index des meilleurs scores
+*/
+class ScoreStore {
+public:
+    /*
+      Ouvre ou crée le journal "path.log" et son index "path.top"
+      parametre "path" Chemin des fichiers, sans extension
+      retourne false si un des fichiers ne peut pas être ouvert ou n'est pas un journal de scores
+    */
+    bool Open(const std::string& path);
+
+    void Close();
+    bool IsOpen() const { return log.IsOpen(); }
+
+    /*
+      Ajoute une partie au journal et à l'index
+      parametre "record" La partie (le numéro et la somme de contrôle sont remplis ici)
+      retourne false si le journal est fermé ou le disque plein
+    */
+    bool Add(const ScoreRecord& record);
+
+    /*
+      retourne Le nombre de parties enregistrées
+    */
+    uint64_t Count() const { return count; }
+
+    /*
+      retourne Une partie du journal, par numéro (0 : la plus ancienne)
+    */
+    const ScoreRecord& Record(uint64_t index) const;
+
+    /*
+      retourne Le nombre de scores du classement (au plus SCORE_TOP_CAPACITY)
+    */
+    uint32_t TopCount() const;
+
+    /*
+      Donne une partie du classement ; à score égal, la plus ancienne est devant
+      parametre "rank" Rang, 0 pour le meilleur score
+    */
+    const ScoreRecord& Top(uint32_t rank) const;
+
+private:
+    ScoreLogHeader& Header();
+    ScoreIndexHeader& TopHeader();
+    const ScoreIndexHeader& TopHeader() const;
+    ScoreIndexEntry* TopEntries();
+    const ScoreIndexEntry* TopEntries() const;
+
+    /*
+      Vérifie un enregistrement : numéro attendu et somme de contrôle
+    */
+    bool IsValid(uint64_t index) const;
+
+    /*
+      Retrouve le nombre d'enregistrements valides à partir de celui de l'en-tête
+    */
+    void RecoverCount();
+
+    /*
+      Ouvre l'index et y ajoute les parties qu'il ne couvre pas encore
+      (ou le reconstruit s'il est absent ou abîmé)
+    */
+    bool LoadIndex(const std::string& path);
+
+    /*
+      Place une partie dans le classement si son score y a sa place
+    */
+    void InsertTop(int32_t score, uint64_t record);
+
+    /*
+      Note les parties couvertes par l'index et met à jour sa somme de contrôle
+    */
+    void SealIndex();
+
+    MappedFile log;
+    MappedFile index;
+    uint64_t count = 0;      // Enregistrements valides
+    uint64_t capacity = 0;   // Emplacements dans le fichier
+};
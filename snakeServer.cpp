@@ -0,0 +1,555 @@
+﻿// Serveur de parties en local : de nombreuses parties à cadence fixe sur une seule boucle d'événements
+//
+// Chaque client ouvre une session : une partie et sa file de virages. À chaque pas,
+// toutes les parties avancent, puis chaque client reçoit ce qui a changé dans la
+// sienne (voir snakeNet.h). Tout tient sur un seul fil : la part de temps où il
+// travaille donne le nombre de sessions qu'un cœur tient à cette cadence.
+// Charge de test : snakeBots ; client graphique : snakeClient.
+//
+// Compilation : g++ -std=c++17 -O2 snakeServer.cpp snakeInput.cpp snakeNet.cpp snakeSim.cpp snakeStats.cpp
+//               -o snakeServer
+// Utilisation : ./snakeServer [--listen udp:7777] [--tick-ms N] [--grid LxH] [--sessions N] [--idle S]
+//                             [--report S] [--seconds S] [--seed N]
+//                 --listen   adresse d'écoute (udp:PORT, tcp:PORT, unix:CHEMIN), peut être répété
+//                            (udp:7777 par défaut)
+//                 --tick-ms  durée d'un pas (200 ms par défaut, comme le jeu)
+//                 --sessions sessions ouvertes en même temps au plus (4096 par défaut)
+//                 --idle     une session udp sans message depuis S secondes est fermée (10 par défaut,
+//                            au moins 3 fois NET_KEEPALIVE)
+//                 --report   résumé toutes les S secondes (5 par défaut)
+//                 --seconds  arrêt après S secondes (0 par défaut : jusqu'à Ctrl+C)
+
+#include "snakeInput.h"
+#include "snakeNet.h"
+#include "snakeSim.h"
+#include "snakeStats.h"
+
+#include <poll.h>
+#include <signal.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static const uint32_t NO_SESSION = 0xFFFFFFFF;
+
+// Ctrl+C : la boucle s'arrête et écrit son dernier résumé
+static volatile sig_atomic_t stopRequested = 0;
+
+static void RequestStop(int) {
+    stopRequested = 1;
+}
+
+/*
+  Partie d'un client
+*/
+struct Session {
+    SimState state;
+    InputQueue turns;                  // Virages reçus, un appliqué par pas
+    NetLink link;
+    NetSentState sent;                 // Ce que le client connaît de la partie
+    uint64_t peerKey = 0;              // Client udp : clé de son adresse
+    bool active = false;
+    bool greeted = false;              // Hello reçu : la partie avance et les pas sont envoyés
+    bool closing = false;              // Fermée après le traitement en cours (Bye, lien rompu)
+    bool keyframe = false;             // Le prochain pas envoie une Keyframe (nouvelle partie)
+    uint32_t tick = 0;                 // Dernier pas envoyé
+    uint32_t generation = 0;           // Partie de la session
+    uint32_t lastInput = 0;            // Numéro du dernier virage reçu
+    uint32_t ack = 0;                  // Dernier virage pris en compte (appliqué ou refusé)
+    Clock::time_point lastHeard;       // Dernier message reçu
+};
+
+/*
+  Socket d'écoute
+*/
+struct Listener {
+    int socket;
+    NetTransport transport;
+};
+
+/*
+  Serveur : sockets d'écoute, sessions et boucle d'événements
+*/
+class Server {
+public:
+    ~Server();
+
+    /*
+      Ouvre une adresse d'écoute
+      retourne false si elle ne peut pas être ouverte
+    */
+    bool Listen(const NetEndpoint& endpoint);
+
+    /*
+      Fait tourner la boucle jusqu'à Ctrl+C ou la fin de la durée
+      parametre "seconds" Durée (0 : sans limite)
+    */
+    void Run(double seconds);
+
+    GridShape grid;                              // Grille de toutes les parties
+    uint64_t seed = 1;                           // Graine des parties (une suite par session)
+    chrono::nanoseconds interval{ chrono::milliseconds(200) };
+    uint32_t maxSessions = 4096;
+    chrono::duration<double> idleTimeout{ 10 };
+    chrono::duration<double> reportInterval{ 5 };
+
+private:
+    void BuildPollSet();
+    void HandleEvents();
+    void ReceiveDatagrams(int socket);
+    void AcceptConnections(int socket);
+    void Handle(uint32_t index, const uint8_t* data, uint32_t size);
+    uint32_t Open();
+    void CloseMarked();
+    void Tick();
+    void SendKeyframe(Session& session);
+    void Send(Session& session);
+    void Report(double windowSeconds);
+
+    vector<Listener> listeners;
+    vector<unique_ptr<Session>> sessions;        // Emplacements réutilisés (aucune allocation en régime établi)
+    vector<uint32_t> freeSlots;
+    uint32_t activeCount = 0;
+    unordered_map<uint64_t, uint32_t> udpSessions;  // Clé de l'adresse -> session
+    vector<pollfd> pollSet;                      // Écoutes puis sessions de flux
+    vector<uint32_t> pollSessions;               // Session de chaque entrée de pollSet après les écoutes
+    NetWriter writer;
+    NetLink stray;                               // Réponse à une adresse udp sans session
+    uint8_t datagram[NET_MAX_MESSAGE];
+    uint32_t sessionsOpened = 0;
+
+    // Fenêtre du résumé en cours
+    LatencyStats tickTime;                       // Durée d'un pas de toutes les sessions (µs)
+    LatencyStats lateness;                       // Retard du début d'un pas sur son échéance (µs)
+    chrono::duration<double> busy{ 0 };          // Temps passé hors de poll
+    uint64_t messagesOut = 0;
+    uint64_t bytesOut = 0;
+    uint64_t keyframesOut = 0;
+    uint64_t ticks = 0;
+    uint64_t sessionTicks = 0;                   // Pas joués, toutes sessions confondues
+    uint64_t messagesIn = 0;
+    uint64_t droppedOut = 0;                     // Datagrammes perdus (file du système pleine)
+    uint64_t refused = 0;                        // Connexions refusées (--sessions atteint)
+};
+
+Server::~Server() {
+    for (unique_ptr<Session>& session : sessions) {
+        if (session) {
+            session->link.Close();
+        }
+    }
+    for (const Listener& listener : listeners) {
+        NetCloseSocket(listener.socket);
+    }
+}
+
+bool Server::Listen(const NetEndpoint& endpoint) {
+    int socket = NetListen(endpoint);
+    if (socket < 0) {
+        return false;
+    }
+    listeners.push_back({ socket, endpoint.transport });
+    cout << "Listening on " << FormatEndpoint(endpoint) << endl;
+    return true;
+}
+
+uint32_t Server::Open() {
+    if (sessions.empty()) {
+        sessions.resize(maxSessions);
+        for (uint32_t i = maxSessions; i-- > 0; ) {
+            freeSlots.push_back(i);
+        }
+    }
+    if (freeSlots.empty()) {
+        refused++;
+        return NO_SESSION;
+    }
+    uint32_t index = freeSlots.back();
+    freeSlots.pop_back();
+    if (!sessions[index]) {
+        sessions[index] = make_unique<Session>();
+    }
+    Session& session = *sessions[index];
+    session.state.grid = grid;
+    InitState(session.state, StreamSeed(seed, sessionsOpened++));
+    session.turns.Clear();
+    session.peerKey = 0;
+    session.active = true;
+    session.greeted = false;
+    session.closing = false;
+    session.keyframe = false;
+    session.tick = 0;
+    session.generation = 0;
+    session.lastInput = 0;
+    session.ack = 0;
+    session.lastHeard = Clock::now();
+    activeCount++;
+    return index;
+}
+
+void Server::CloseMarked() {
+    for (uint32_t index = 0; index < sessions.size(); index++) {
+        Session* session = sessions[index].get();
+        if (session == nullptr || !session->active || !session->closing) {
+            continue;
+        }
+        droppedOut += session->link.dropped;
+        session->link.dropped = 0;
+        session->link.Close();
+        if (session->peerKey != 0) {
+            udpSessions.erase(session->peerKey);
+        }
+        session->active = false;
+        freeSlots.push_back(index);
+        activeCount--;
+    }
+}
+
+void Server::BuildPollSet() {
+    pollSet.clear();
+    pollSessions.clear();
+    for (const Listener& listener : listeners) {
+        pollSet.push_back({ listener.socket, POLLIN, 0 });
+    }
+    for (uint32_t index = 0; index < sessions.size(); index++) {
+        const Session* session = sessions[index].get();
+        if (session == nullptr || !session->active || session->peerKey != 0) {
+            continue;
+        }
+        short events = POLLIN | (session->link.HasPendingOutput() ? POLLOUT : 0);
+        pollSet.push_back({ session->link.Socket(), events, 0 });
+        pollSessions.push_back(index);
+    }
+}
+
+void Server::HandleEvents() {
+    for (size_t i = 0; i < pollSet.size(); i++) {
+        short events = pollSet[i].revents;
+        if (events == 0) {
+            continue;
+        }
+        if (i < listeners.size()) {
+            if (listeners[i].transport == NetTransport::Udp) {
+                ReceiveDatagrams(listeners[i].socket);
+            }
+            else {
+                AcceptConnections(listeners[i].socket);
+            }
+            continue;
+        }
+        uint32_t index = pollSessions[i - listeners.size()];
+        Session& session = *sessions[index];
+        if ((events & POLLOUT) && !session.link.Flush()) {
+            session.closing = true;
+        }
+        if ((events & (POLLIN | POLLHUP | POLLERR)) &&
+            !session.link.Receive([&](const uint8_t* data, uint32_t size) { Handle(index, data, size); })) {
+            session.closing = true;
+        }
+    }
+    CloseMarked();
+}
+
+void Server::ReceiveDatagrams(int socket) {
+    NetPeerAddress from;
+    for (;;) {
+        int size = NetReceiveFrom(socket, datagram, sizeof(datagram), from);
+        if (size <= 0) {
+            return;
+        }
+        uint64_t key = from.Key();
+        auto known = udpSessions.find(key);
+        uint32_t index = known != udpSessions.end() ? known->second : NO_SESSION;
+        if (index == NO_SESSION) {
+            // Seul un Hello ouvre une session. Un autre message vient d'une session fermée
+            // (inactive trop longtemps) : Bye lui dit de renvoyer Hello
+            if (datagram[0] != (uint8_t)NetMessage::Hello) {
+                if (datagram[0] != (uint8_t)NetMessage::Bye) {
+                    stray.AttachPeer(socket, from);
+                    writer.Start(NetMessage::Bye);
+                    stray.Send(writer);
+                    stray.Close();
+                }
+                continue;
+            }
+            if ((index = Open()) == NO_SESSION) {
+                continue;
+            }
+            sessions[index]->link.AttachPeer(socket, from);
+            sessions[index]->peerKey = key;
+            udpSessions[key] = index;
+        }
+        Handle(index, datagram, (uint32_t)size);
+    }
+}
+
+void Server::AcceptConnections(int socket) {
+    for (;;) {
+        int connection = NetAccept(socket);
+        if (connection < 0) {
+            return;
+        }
+        uint32_t index = Open();
+        if (index == NO_SESSION) {
+            NetCloseSocket(connection);
+            continue;
+        }
+        sessions[index]->link.Attach(connection, true);
+    }
+}
+
+void Server::Handle(uint32_t index, const uint8_t* data, uint32_t size) {
+    Session& session = *sessions[index];
+    if (session.closing) {
+        return;
+    }
+    messagesIn++;
+    session.lastHeard = Clock::now();
+    NetReader reader(data, size);
+    NetMessage type = (NetMessage)reader.Read(1);
+    switch (type) {
+    case NetMessage::Hello:
+        if (reader.Read(1) != NET_VERSION) {
+            session.closing = true;
+            break;
+        }
+        session.greeted = true;
+        SendKeyframe(session);
+        break;
+    case NetMessage::Input: {
+        uint32_t sequence = reader.Read(4);
+        uint32_t action = reader.Read(1);
+        if (!reader.ok || action < (uint32_t)SimAction::Up || action > (uint32_t)SimAction::Right) {
+            break;
+        }
+        SimState& state = session.state;
+        if (!state.gameOver) {
+            session.turns.Push((SimAction)action, state.started ? CurrentDirection(state) : SimAction::None,
+                               InputClock::now(), sequence);
+        }
+        session.lastInput = sequence;
+        break;
+    }
+    case NetMessage::Restart:
+        if (session.state.gameOver) {
+            ResetState(session.state);
+            session.turns.Clear();
+            session.generation++;
+            session.keyframe = true;
+        }
+        break;
+    case NetMessage::Resync:
+        if (session.greeted) {
+            SendKeyframe(session);
+        }
+        break;
+    case NetMessage::Bye:
+        session.closing = true;
+        break;
+    case NetMessage::Ping:
+        break;
+    default:
+        break;
+    }
+}
+
+void Server::SendKeyframe(Session& session) {
+    WriteKeyframe(writer, session.state, session.sent, session.tick, session.ack, session.generation,
+                  (uint32_t)chrono::duration_cast<chrono::microseconds>(interval).count());
+    keyframesOut++;
+    Send(session);
+}
+
+void Server::Send(Session& session) {
+    messagesOut++;
+    bytesOut += writer.size;
+    if (!session.link.Send(writer)) {
+        session.closing = true;
+    }
+}
+
+void Server::Tick() {
+    Clock::time_point now = Clock::now();
+    ticks++;
+    for (unique_ptr<Session>& slot : sessions) {
+        Session* session = slot.get();
+        if (session == nullptr || !session->active || session->closing) {
+            continue;
+        }
+        if (session->peerKey != 0 && now - session->lastHeard > idleTimeout) {
+            session->closing = true;
+            continue;
+        }
+        if (!session->greeted) {
+            continue;
+        }
+
+        // Un virage au plus par pas, comme dans le jeu ; la file vide, tous les virages reçus sont pris en compte
+        TurnRequest turn;
+        bool hasTurn = session->turns.Pop(turn);
+        Step(session->state, turn.action);
+        sessionTicks++;
+        if (hasTurn) {
+            session->ack = turn.sequence;
+        }
+        if (session->turns.Count() == 0) {
+            session->ack = session->lastInput;
+        }
+
+        session->tick++;
+        if (session->keyframe) {
+            session->keyframe = false;
+            SendKeyframe(*session);
+        }
+        else if (WriteDelta(writer, session->state, session->sent, session->tick, session->ack)) {
+            Send(*session);
+        }
+        else {
+            SendKeyframe(*session);
+        }
+    }
+    CloseMarked();
+}
+
+void Server::Report(double windowSeconds) {
+    double busyFraction = busy.count() / windowSeconds;
+    double playing = ticks > 0 ? (double)sessionTicks / ticks : 0.0;   // Sessions jouées par pas, en moyenne
+    double ticksPerSecond = 1e9 / (double)interval.count();
+    char line[512];
+    snprintf(line, sizeof(line),
+             "sessions %u | tick mean %.3f p99 %.3f max %.3f ms | late p99 %.3f max %.3f ms | busy %.1f%%"
+             " -> %.0f sessions/core at %.0f ticks/s\n"
+             "  in %.0f msg/s | out %.0f msg/s, %.1f KB/s, %.1f B/msg | keyframes %llu | dropped %llu | refused %llu",
+             activeCount, tickTime.Mean() / 1000, tickTime.Percentile(99) / 1000, tickTime.Max() / 1000,
+             lateness.Percentile(99) / 1000, lateness.Max() / 1000, busyFraction * 100,
+             busyFraction > 0 ? playing / busyFraction : 0.0, ticksPerSecond,
+             messagesIn / windowSeconds, messagesOut / windowSeconds, bytesOut / windowSeconds / 1024,
+             messagesOut > 0 ? (double)bytesOut / messagesOut : 0.0, (unsigned long long)keyframesOut,
+             (unsigned long long)droppedOut, (unsigned long long)refused);
+    cout << line << endl;
+    tickTime.Clear();
+    lateness.Clear();
+    busy = chrono::duration<double>(0);
+    messagesOut = 0;
+    bytesOut = 0;
+    keyframesOut = 0;
+    ticks = 0;
+    sessionTicks = 0;
+    messagesIn = 0;
+    droppedOut = 0;
+    refused = 0;
+}
+
+void Server::Run(double seconds) {
+    Clock::time_point start = Clock::now();
+    Clock::time_point nextTick = start + interval;
+    Clock::time_point windowStart = start;
+    while (stopRequested == 0 && (seconds <= 0 || Clock::now() - start < chrono::duration<double>(seconds))) {
+        BuildPollSet();
+        Clock::time_point now = Clock::now();
+        // Arrondi au-dessus : poll ne réveille pas avant l'échéance
+        int timeout = now >= nextTick ? 0 : (int)ceil(chrono::duration<double, milli>(nextTick - now).count());
+        int ready = poll(pollSet.data(), (nfds_t)pollSet.size(), timeout);
+        Clock::time_point awake = Clock::now();
+        if (ready > 0) {
+            HandleEvents();
+        }
+        // Échéances comptées depuis le départ : un pas en retard ne décale pas les suivants
+        now = Clock::now();
+        if (now >= nextTick) {
+            lateness.Add(chrono::duration<double, micro>(now - nextTick).count());
+            Tick();
+            tickTime.Add(chrono::duration<double, micro>(Clock::now() - now).count());
+            nextTick += interval;
+        }
+        now = Clock::now();
+        busy += now - awake;
+        if (now - windowStart >= reportInterval) {
+            Report(chrono::duration<double>(now - windowStart).count());
+            windowStart = now;
+        }
+    }
+    Report(chrono::duration<double>(Clock::now() - windowStart).count());
+}
+
+int main(int argc, char** argv)
+{
+    Server server;
+    vector<NetEndpoint> endpoints;
+    double seconds = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            NetEndpoint endpoint;
+            if (!ParseEndpoint(argv[++i], endpoint)) {
+                cerr << "bad address: " << argv[i] << endl;
+                return 1;
+            }
+            endpoints.push_back(endpoint);
+        }
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc) {
+            server.interval = chrono::microseconds((int64_t)(atof(argv[++i]) * 1000));
+        }
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            if (!ParseGridShape(argv[++i], server.grid)) {
+                cerr << "bad grid size: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+            server.maxSessions = max((uint32_t)strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if (strcmp(argv[i], "--idle") == 0 && i + 1 < argc) {
+            // Plus court, un client qui ne fait qu'attendre (Ping seulement) serait fermé
+            server.idleTimeout = chrono::duration<double>(max(atof(argv[++i]), 3.0 * NET_KEEPALIVE.count()));
+        }
+        else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            server.reportInterval = chrono::duration<double>(max(atof(argv[++i]), 0.1));
+        }
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            server.seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            cerr << "usage: " << argv[0] << " [--listen udp:7777] [--tick-ms N] [--grid LxH] [--sessions N]"
+                 << " [--idle S] [--report S] [--seconds S] [--seed N]" << endl;
+            return 1;
+        }
+    }
+    if (server.interval.count() <= 0) {
+        cerr << "bad tick interval" << endl;
+        return 1;
+    }
+    // Un serpent qui remplit la grille doit tenir dans une Keyframe
+    SimState probe;
+    if (NetKeyframeSize(server.grid.CellCount(), (uint32_t)probe.obstacleCount) > NET_MAX_MESSAGE) {
+        cerr << "grid too large for a keyframe: " << server.grid.width << "x" << server.grid.height << endl;
+        return 1;
+    }
+    if (endpoints.empty()) {
+        NetEndpoint endpoint;
+        ParseEndpoint("udp:7777", endpoint);
+        endpoints.push_back(endpoint);
+    }
+    for (const NetEndpoint& endpoint : endpoints) {
+        if (!server.Listen(endpoint)) {
+            return 1;
+        }
+    }
+    signal(SIGINT, RequestStop);
+    signal(SIGTERM, RequestStop);
+    signal(SIGPIPE, SIG_IGN);
+    server.Run(seconds);
+    return 0;
+}
@@ -0,0 +1,405 @@
+﻿#include "snakeSim.h"
+
+#include "snakeLevel.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+uint64_t NextRandom(uint64_t& rng) {
+    uint64_t z = (rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint32_t RandomBelow(uint64_t& rng, uint32_t bound) {
+    return (uint32_t)(((NextRandom(rng) >> 32) * bound) >> 32);
+}
+
+uint64_t StreamSeed(uint64_t seed, uint32_t index) {
+    uint64_t rng = seed ^ ((uint64_t)index << 32 | index);
+    return NextRandom(rng);
+}
+
+/*
+  Note une case modifiée dans le journal, si celui-ci est actif
+  parametre "state" L'état de la partie
+  parametre "cell" La case modifiée
+*/
+static void MarkChanged(SimState& state, Cell cell) {
+    if (state.trackChanges) {
+        state.changedCells.push_back(cell);
+    }
+}
+
+/*
+  Pose les murs d'un bloc du niveau, s'ils ne le sont pas déjà
+  parametre "state" L'état de la partie (avec un niveau)
+  parametre "chunk" Numéro du bloc
+*/
+static void LoadChunk(SimState& state, uint32_t chunk) {
+    if (state.loadedChunks.Test(chunk)) {
+        return;
+    }
+    state.loadedChunks.Set(chunk);
+    state.level->ForEachWall(chunk, [&state](Cell wall) {
+        state.obstacleCells.Set(wall);
+        state.blockedCells.Set(wall);
+        state.freeCells.Remove(wall);
+    });
+}
+
+/*
+  Pose les murs du bloc d'une case et des huit blocs voisins (la grille est torique),
+  si la case a changé de bloc depuis le dernier appel
+  parametre "state" L'état de la partie (avec un niveau)
+  parametre "cell" La case (la tête du serpent)
+*/
+static void LoadChunksAround(SimState& state, Cell cell) {
+    const Level& level = *state.level;
+    uint32_t chunk = level.ChunkOf(cell);
+    if (chunk == state.levelChunk) {
+        return;
+    }
+    state.levelChunk = chunk;
+    int column = (int)(chunk % level.ChunkColumns());
+    int row = (int)(chunk / level.ChunkColumns());
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            LoadChunk(state, level.ChunkAt(column + dx, row + dy));
+        }
+    }
+}
+
+/*
+  Tire une case libre uniformément et la marque comme occupée.
+  Avec un niveau, une case d'un bloc pas encore posé peut être un mur :
+  le bloc est posé et le tirage recommence s'il l'était.
+  parametre "state" L'état de la partie
+  retourne La case tirée, ou NO_CELL si la grille est pleine
+*/
+static Cell TakeRandomFreeCell(SimState& state) {
+    for (;;) {
+        uint32_t freeCount = state.freeCells.Count();
+        if (freeCount == 0) {
+            return NO_CELL;
+        }
+        Cell cell = state.freeCells.At(RandomBelow(state.rng, freeCount));
+        if (state.level != nullptr) {
+            LoadChunk(state, state.level->ChunkOf(cell));
+            if (!state.freeCells.Contains(cell)) {
+                continue;
+            }
+        }
+        state.freeCells.Remove(cell);
+        return cell;
+    }
+}
+
+/*
+  Choisit la case de la nourriture : la prochaine case libre de la table du niveau,
+  sinon une case libre au hasard
+  parametre "state" L'état de la partie
+  retourne La case choisie, ou NO_CELL si la grille est pleine
+*/
+static Cell TakeFruitCell(SimState& state) {
+    const Level* level = state.level;
+    for (uint32_t i = 0; level != nullptr && i < level->FruitCount(); i++) {
+        Cell cell = level->Fruit(state.nextFruit);
+        state.nextFruit = state.nextFruit + 1 == level->FruitCount() ? 0 : state.nextFruit + 1;
+        LoadChunk(state, level->ChunkOf(cell));
+        if (state.freeCells.Contains(cell)) {
+            state.freeCells.Remove(cell);
+            return cell;
+        }
+    }
+    return TakeRandomFreeCell(state);
+}
+
+/*
+  Replace la nourriture et les obstacles sur des cases libres.
+  Les anciens obstacles sont rendus avant le tirage, comme dans le jeu d'origine.
+  parametre "state" L'état de la partie
+  retourne false si la grille n'a plus de place pour la nourriture
+*/
+static bool RespawnItems(SimState& state) {
+    for (Cell obstacle : state.obstacles) {
+        state.obstacleCells.Reset(obstacle);
+        state.blockedCells.Reset(obstacle);
+        state.freeCells.Insert(obstacle);
+        MarkChanged(state, obstacle);
+    }
+    state.obstacles.clear();
+
+    state.fruitPosition = TakeFruitCell(state);
+    if (state.fruitPosition == NO_CELL) {
+        return false;
+    }
+    MarkChanged(state, state.fruitPosition);
+    for (int i = 0; i < state.obstacleCount; i++) {
+        Cell obstacle = TakeRandomFreeCell(state);
+        if (obstacle == NO_CELL) {
+            break;
+        }
+        state.obstacles.push_back(obstacle);
+        state.obstacleCells.Set(obstacle);
+        state.blockedCells.Set(obstacle);
+        MarkChanged(state, obstacle);
+    }
+    return true;
+}
+
+/*
+  Une dimension de la grille. SIZE est la taille connue à la compilation,
+  0 si elle n'est connue qu'à l'exécution.
+*/
+template <int SIZE, bool POWER_OF_TWO = SIZE != 0 && (SIZE & (SIZE - 1)) == 0>
+struct Axis {
+    /*
+      Ajuste une coordonnée pour permettre au serpent de traverser les bords de la grille
+      parametre "coordinate" La coordonnée à ajuster (au plus un pas hors de la grille)
+      parametre "size" La taille lue à l'exécution (ignorée si SIZE est connue)
+      retourne La coordonnée dans [0, taille)
+    */
+    static int WrapPosition(int coordinate, int size) {
+        int length = SIZE != 0 ? SIZE : size;
+        if (coordinate < 0) { return length - 1; }
+        if (coordinate >= length) { return 0; }
+        return coordinate;
+    }
+};
+
+// Puissance de deux : un masque suffit (-1 & (SIZE - 1) == SIZE - 1)
+template <int SIZE>
+struct Axis<SIZE, true> {
+    static int WrapPosition(int coordinate, int) {
+        return coordinate & (SIZE - 1);
+    }
+};
+
+/*
+  Change la direction du serpent, sauf demi-tour
+  parametre "state" L'état de la partie
+  parametre "action" L'action du joueur
+*/
+static void ApplyAction(SimState& state, SimAction action) {
+    switch (action) {
+    case SimAction::Left:
+        if (state.dirX != 1) { state.dirX = -1; state.dirY = 0; state.started = true; }
+        break;
+    case SimAction::Right:
+        if (state.dirX != -1) { state.dirX = 1; state.dirY = 0; state.started = true; }
+        break;
+    case SimAction::Up:
+        if (state.dirY != 1) { state.dirX = 0; state.dirY = -1; state.started = true; }
+        break;
+    case SimAction::Down:
+        if (state.dirY != -1) { state.dirX = 0; state.dirY = 1; state.started = true; }
+        break;
+    case SimAction::None:
+        break;
+    }
+}
+
+CellContent ClassifyCell(const SimState& state, Cell cell) {
+    if (state.blockedCells.Test(cell)) {
+        // La tête entrée dans un obstacle (fin de partie) reste affichée
+        bool obstacle = state.obstacleCells.Test(cell) && cell != state.body.Head();
+        return obstacle ? CellContent::Obstacle : CellContent::Snake;
+    }
+    if (cell == state.fruitPosition) {
+        return CellContent::Fruit;
+    }
+    return CellContent::Empty;
+}
+
+SimAction CurrentDirection(const SimState& state) {
+    if (state.dirX < 0) { return SimAction::Left; }
+    if (state.dirX > 0) { return SimAction::Right; }
+    return state.dirY < 0 ? SimAction::Up : SimAction::Down;
+}
+
+SimAction OppositeAction(SimAction action) {
+    switch (action) {
+    case SimAction::Left: return SimAction::Right;
+    case SimAction::Right: return SimAction::Left;
+    case SimAction::Up: return SimAction::Down;
+    case SimAction::Down: return SimAction::Up;
+    default: return SimAction::None;
+    }
+}
+
+static StepFunction SelectStep(const GridShape& grid);
+
+void InitState(SimState& state, uint64_t seed) {
+    if (state.level != nullptr) {
+        state.grid = state.level->Grid();
+        state.obstacleCount = (int)state.level->RandomObstacles();
+        state.loadedChunks.Init(state.level->ChunkCount());
+    }
+    state.grid.width = min(max(state.grid.width, MIN_GRID_SIZE), MAX_GRID_SIZE);
+    state.grid.height = min(max(state.grid.height, MIN_GRID_SIZE), MAX_GRID_SIZE);
+    state.stepFunction = SelectStep(state.grid);
+    uint32_t cellCount = state.grid.CellCount();
+    state.rng = seed;
+    state.body.Init(cellCount, state.grid);
+    state.blockedCells.Init(cellCount);
+    state.obstacleCells.Init(cellCount);
+    state.freeCells.Init(cellCount);
+    state.obstacles.reserve(state.obstacleCount);
+    state.changedCells.reserve(2 * state.obstacleCount + 64);
+    ResetState(state);
+}
+
+void ResetState(SimState& state) {
+    state.body.Clear();
+    state.blockedCells.Clear();
+    state.obstacleCells.Clear();
+    state.freeCells.Fill();
+    state.obstacles.clear();
+    // Départ en (4..6, 10) sur la grille 25x25, à la même hauteur relative ailleurs
+    int startY = state.grid.height * 2 / 5;
+    Cell start[3] = { state.grid.MakeCell(4, startY), state.grid.MakeCell(5, startY), state.grid.MakeCell(6, startY) };
+    state.dirX = 1;
+    state.dirY = 0;
+    if (state.level != nullptr) {
+        // Premier départ du niveau : la tête sur le point de départ, le corps derrière elle
+        state.loadedChunks.Clear();
+        state.levelChunk = NO_CELL;
+        state.nextFruit = 0;
+        const LevelSpawn& spawn = state.level->Spawn(0);
+        static const int MOVES[4][2] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+        const int* move = MOVES[spawn.direction - (int)SimAction::Up];
+        state.dirX = move[0];
+        state.dirY = move[1];
+        for (int i = 0; i < 3; i++) {
+            int x = ((int)spawn.x - (2 - i) * move[0] + state.grid.width) % state.grid.width;
+            int y = ((int)spawn.y - (2 - i) * move[1] + state.grid.height) % state.grid.height;
+            start[i] = state.grid.MakeCell(x, y);
+        }
+        LoadChunksAround(state, start[2]);
+    }
+    for (Cell cell : start) {
+        state.body.PushHead(cell);
+        state.blockedCells.Set(cell);
+        state.freeCells.Remove(cell);
+    }
+    state.shouldGrow = false;
+    state.score = 0;
+    state.started = false;
+    state.gameOver = false;
+    state.tick = 0;
+    state.gameSeed = state.rng;
+    RespawnItems(state);
+    state.changedCells.clear();
+    state.fullRefresh = true;
+}
+
+/*
+  Pas de simulation pour une grille WIDTH x HEIGHT (0 : dimensions lues dans state.grid)
+*/
+template <int WIDTH, int HEIGHT>
+static SimOutcome StepGrid(SimState& state, SimAction action) {
+    if (state.gameOver) {
+        return SimOutcome::GameOver;
+    }
+
+    ApplyAction(state, action);
+    if (!state.started) {
+        return SimOutcome::Waiting;
+    }
+    state.tick++;
+
+    // Déplacement du serpent : la queue libère sa case avant que la tête n'avance
+    const uint32_t width = WIDTH != 0 ? WIDTH : (uint32_t)state.grid.width;
+    Cell head = state.body.Head();
+    int x = Axis<WIDTH>::WrapPosition((int)(head % width) + state.dirX, state.grid.width);
+    int y = Axis<HEIGHT>::WrapPosition((int)(head / width) + state.dirY, state.grid.height);
+    Cell headPosition = (Cell)y * width + (Cell)x;
+    if (state.level != nullptr) {
+        // Murs des blocs autour de la tête, posés avant qu'elle n'y entre
+        LoadChunksAround(state, headPosition);
+    }
+    if (state.shouldGrow) {
+        state.shouldGrow = false;
+    }
+    else {
+        Cell tail = state.body.PopTail();
+        state.blockedCells.Reset(tail);
+        state.freeCells.Insert(tail);
+        MarkChanged(state, tail);
+    }
+    // Corps, obstacles et murs : une seule lecture, quel que soit leur nombre
+    bool blocked = state.blockedCells.Test(headPosition);
+    state.body.PushHead(headPosition);
+    state.blockedCells.Set(headPosition);
+    state.freeCells.Remove(headPosition);
+    MarkChanged(state, headPosition);
+
+    // Nourriture
+    SimOutcome outcome = SimOutcome::Moved;
+    if (headPosition == state.fruitPosition) {
+        state.shouldGrow = true;
+        state.score++;
+        outcome = SimOutcome::AteFruit;
+        if (!RespawnItems(state)) {
+            state.gameOver = true;
+            return SimOutcome::BoardFull;
+        }
+    }
+
+    // Collision, en O(1) : le second plateau ne sert qu'à nommer l'obstacle touché
+    if (blocked) {
+        state.gameOver = true;
+        return state.obstacleCells.Test(headPosition) ? SimOutcome::HitObstacle : SimOutcome::HitSelf;
+    }
+    return outcome;
+}
+
+/*
+  Choisit la version de Step compilée pour des dimensions données
+  retourne La version spécialisée si elle existe, sinon la version générale
+*/
+static StepFunction SelectStep(const GridShape& grid) {
+    if (grid.width == grid.height) {
+        switch (grid.width) {
+        case 16: return &StepGrid<16, 16>;
+        case 25: return &StepGrid<25, 25>;
+        case 32: return &StepGrid<32, 32>;
+        case 64: return &StepGrid<64, 64>;
+        case 128: return &StepGrid<128, 128>;
+        case 256: return &StepGrid<256, 256>;
+        case 512: return &StepGrid<512, 512>;
+        case 1024: return &StepGrid<1024, 1024>;
+        case 2048: return &StepGrid<2048, 2048>;
+        case 4096: return &StepGrid<4096, 4096>;
+        default: break;
+        }
+    }
+    return &StepGrid<0, 0>;
+}
+
+bool HasFixedStep(const GridShape& grid) {
+    return SelectStep(grid) != &StepGrid<0, 0>;
+}
+
+bool ParseGridShape(const char* text, GridShape& grid) {
+    char* end = nullptr;
+    long width = strtol(text, &end, 10);
+    long height = width;
+    if (end != text && (*end == 'x' || *end == 'X')) {
+        const char* heightText = end + 1;
+        height = strtol(heightText, &end, 10);
+        if (end == heightText) {
+            return false;
+        }
+    }
+    if (end == text || *end != '\0' ||
+        width < MIN_GRID_SIZE || width > MAX_GRID_SIZE || height < MIN_GRID_SIZE || height > MAX_GRID_SIZE) {
+        return false;
+    }
+    grid.width = (int)width;
+    grid.height = (int)height;
+    return true;
+}
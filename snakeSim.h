@@ -0,0 +1,613 @@
+﻿// Noyau de simulation du jeu Snake (aucune dépendance à SFML)
+//
+// Ce module contient toute la logique du jeu : déplacement du serpent,
+// collisions, nourriture et obstacles. Il peut être compilé seul
+// (g++ -std=c++17 -O2 -c snakeSim.cpp) et utilisé par le jeu graphique
+// comme par les outils en ligne de commande (benchmark, etc.).
+//
+// -DSNAKE_PACKED_BODY (pour tous les fichiers) : corps du serpent sur 2 bits par
+// segment, pour les très grandes grilles (4096x4096 : 4 Mo au lieu de 64 Mo).
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class Level;
+
+// Taille de la grille : 25x25 par défaut, choisie au démarrage (SimState::grid)
+const int DEFAULT_GRID_SIZE = 25;
+const int MIN_GRID_SIZE = 8;      // Place pour le serpent de départ
+const int MAX_GRID_SIZE = 4096;
+
+// Case de la grille, codée sur un entier : y * largeur + x
+typedef uint32_t Cell;
+const Cell NO_CELL = 0xFFFFFFFF;  // Absence de case (ex. : plus de place pour la nourriture)
+
+/*
+  Dimensions de la grille (torique) et conversions entre case et coordonnées
+*/
+struct GridShape {
+    int width = DEFAULT_GRID_SIZE;
+    int height = DEFAULT_GRID_SIZE;
+
+    uint32_t CellCount() const { return (uint32_t)width * (uint32_t)height; }
+    Cell MakeCell(int x, int y) const { return (Cell)y * (Cell)width + (Cell)x; }
+    int CellX(Cell cell) const { return (int)(cell % (uint32_t)width); }
+    int CellY(Cell cell) const { return (int)(cell / (uint32_t)width); }
+
+    bool operator==(const GridShape& other) const { return width == other.width && height == other.height; }
+    bool operator!=(const GridShape& other) const { return !(*this == other); }
+};
+
+/*
+  Ensemble de cases stocké sur un bit par case (test, ajout et retrait en O(1))
+*/
+class Bitboard {
+public:
+    /*
+      Dimensionne le plateau et le vide
+      parametre "cellCount" Nombre de cases
+    */
+    void Init(uint32_t cellCount) {
+        words.assign((cellCount + 63) / 64, 0);
+    }
+
+    /*
+      Vide le plateau sans le redimensionner
+    */
+    void Clear() {
+        std::fill(words.begin(), words.end(), 0);
+    }
+
+    bool Test(Cell cell) const { return (words[cell >> 6] >> (cell & 63)) & 1; }
+    void Set(Cell cell) { words[cell >> 6] |= (uint64_t)1 << (cell & 63); }
+    void Reset(Cell cell) { words[cell >> 6] &= ~((uint64_t)1 << (cell & 63)); }
+
+private:
+    std::vector<uint64_t> words;  // 64 cases par mot
+};
+
+#ifdef SNAKE_PACKED_BODY
+/*
+  Corps du serpent, version compacte (-DSNAKE_PACKED_BODY) : la queue, puis la direction
+  de chaque segment vers le suivant sur 2 bits (un quart d'octet par segment au lieu de
+  4 octets). La tête et la queue sont gardées avec leurs coordonnées : ajout de tête et
+  retrait de queue en O(1), sans division. At(index) part de l'extrémité la plus proche ;
+  pour tout parcourir, ForEach et ForEachFromTail coûtent O(1) par segment.
+  L'indice 0 désigne la tête, Length() - 1 la queue.
+*/
+class SnakeBody {
+public:
+    /*
+      Alloue le tampon une fois pour toutes
+      parametre "capacity" Longueur maximale du serpent
+      parametre "shape" Dimensions de la grille (pour suivre les bords du tore)
+    */
+    void Init(uint32_t capacity, const GridShape& shape) {
+        grid = shape;
+        directions.assign((capacity + 3) / 4, 0);
+        slotCount = capacity;
+        Clear();
+    }
+
+    void Clear() { tailSlot = 0; length = 0; }
+
+    /*
+      Ajoute une nouvelle tête, voisine de l'ancienne
+      parametre "cell" Case de la nouvelle tête
+    */
+    void PushHead(Cell cell) {
+        if (length == 0) {
+            headX = tailX = grid.CellX(cell);
+            headY = tailY = grid.CellY(cell);
+            head = tail = cell;
+            length = 1;
+            return;
+        }
+        uint32_t direction = DirectionTo(cell);
+        WriteDirection(Slot(length - 1), direction);
+        Move(headX, headY, direction);
+        head = cell;
+        length++;
+    }
+
+    /*
+      Retire la queue
+      retourne La case libérée
+    */
+    Cell PopTail() {
+        Cell old = tail;
+        length--;
+        if (length > 0) {
+            Move(tailX, tailY, ReadDirection(tailSlot));
+            tail = grid.MakeCell(tailX, tailY);
+            tailSlot = tailSlot + 1 == slotCount ? 0 : tailSlot + 1;
+        }
+        return old;
+    }
+
+    /*
+      Agrandit le tampon en gardant les segments (pour un serpent sans longueur maximale connue)
+      parametre "capacity" Nouvelle capacité, au moins Length()
+    */
+    void Grow(uint32_t capacity) {
+        std::vector<uint8_t> resized((capacity + 3) / 4, 0);
+        for (uint32_t k = 0; k + 1 < length; k++) {
+            uint32_t direction = ReadDirection(Slot(k));
+            resized[k >> 2] |= (uint8_t)(direction << ((k & 3) * 2));
+        }
+        directions.swap(resized);
+        slotCount = capacity;
+        tailSlot = 0;
+    }
+
+    Cell Head() const { return head; }
+    Cell Tail() const { return tail; }
+    uint32_t Length() const { return length; }
+    uint32_t Capacity() const { return slotCount; }
+
+    /*
+      retourne La case du segment "index" (0 = tête), en O(min(index, Length() - 1 - index))
+    */
+    Cell At(uint32_t index) const {
+        int x, y;
+        if (index < length / 2) {
+            x = headX;
+            y = headY;
+            for (uint32_t k = length - 1; k > length - 1 - index; k--) {
+                Move(x, y, ReadDirection(Slot(k - 1)) ^ 1);
+            }
+        }
+        else {
+            x = tailX;
+            y = tailY;
+            for (uint32_t k = 0; k < length - 1 - index; k++) {
+                Move(x, y, ReadDirection(Slot(k)));
+            }
+        }
+        return grid.MakeCell(x, y);
+    }
+
+    /*
+      Appelle "visit" pour chaque segment, de la tête à la queue
+    */
+    template <class Visit>
+    void ForEach(Visit&& visit) const {
+        if (length == 0) {
+            return;
+        }
+        int x = headX;
+        int y = headY;
+        visit(head);
+        for (uint32_t k = length - 1; k > 0; k--) {
+            Move(x, y, ReadDirection(Slot(k - 1)) ^ 1);
+            visit(grid.MakeCell(x, y));
+        }
+    }
+
+    /*
+      Appelle "visit" pour chaque segment, de la queue à la tête
+    */
+    template <class Visit>
+    void ForEachFromTail(Visit&& visit) const {
+        if (length == 0) {
+            return;
+        }
+        int x = tailX;
+        int y = tailY;
+        visit(tail);
+        for (uint32_t k = 0; k + 1 < length; k++) {
+            Move(x, y, ReadDirection(Slot(k)));
+            visit(grid.MakeCell(x, y));
+        }
+    }
+
+private:
+    // Directions, dans l'ordre de SimAction (Up, Down, Left, Right) : d ^ 1 est la direction opposée
+    enum : uint32_t { UP, DOWN, LEFT, RIGHT };
+
+    uint32_t Slot(uint32_t k) const {
+        uint32_t slot = tailSlot + k;
+        return slot >= slotCount ? slot - slotCount : slot;
+    }
+
+    uint32_t ReadDirection(uint32_t slot) const {
+        return (directions[slot >> 2] >> ((slot & 3) * 2)) & 3;
+    }
+
+    void WriteDirection(uint32_t slot, uint32_t direction) {
+        uint8_t& byte = directions[slot >> 2];
+        uint32_t shift = (slot & 3) * 2;
+        byte = (uint8_t)((byte & ~(3u << shift)) | (direction << shift));
+    }
+
+    /*
+      Direction de la tête vers une case voisine, d'après l'écart entre les deux cases
+      (distinct pour chaque direction, bords compris, dès que la grille a au moins 3 cases de côté)
+    */
+    uint32_t DirectionTo(Cell cell) const {
+        int64_t delta = (int64_t)cell - (int64_t)head;
+        int64_t width = grid.width;
+        int64_t wrap = (int64_t)(grid.height - 1) * width;
+        if (delta == 1 || delta == 1 - width) { return RIGHT; }
+        if (delta == -1 || delta == width - 1) { return LEFT; }
+        if (delta == width || delta == -wrap) { return DOWN; }
+        return UP;
+    }
+
+    void Move(int& x, int& y, uint32_t direction) const {
+        switch (direction) {
+        case UP: y = y == 0 ? grid.height - 1 : y - 1; break;
+        case DOWN: y = y + 1 == grid.height ? 0 : y + 1; break;
+        case LEFT: x = x == 0 ? grid.width - 1 : x - 1; break;
+        default: x = x + 1 == grid.width ? 0 : x + 1; break;
+        }
+    }
+
+    GridShape grid;
+    std::vector<uint8_t> directions;  // Direction du segment k vers le segment k + 1 (depuis la queue), 4 par octet
+    uint32_t slotCount = 0;           // Capacité, en segments
+    uint32_t tailSlot = 0;            // Emplacement de la direction qui part de la queue
+    uint32_t length = 0;              // Nombre de segments
+    Cell head = 0;
+    Cell tail = 0;
+    int headX = 0;
+    int headY = 0;
+    int tailX = 0;
+    int tailY = 0;
+};
+#else
+/*
+  Corps du serpent : tampon circulaire de capacité fixe, sauf appel à Grow (une case par segment)
+  L'indice 0 désigne la tête, Length() - 1 la queue.
+*/
+class SnakeBody {
+public:
+    /*
+      Alloue le tampon une fois pour toutes
+      parametre "capacity" Longueur maximale du serpent
+      parametre "grid" Dimensions de la grille (utilisées par la version compacte)
+    */
+    void Init(uint32_t capacity, const GridShape& grid) {
+        (void)grid;
+        cells.assign(capacity, 0);
+        headSlot = 0;
+        length = 0;
+    }
+
+    void Clear() { headSlot = 0; length = 0; }
+
+    /*
+      Ajoute une nouvelle tête
+      parametre "cell" Case de la nouvelle tête
+    */
+    void PushHead(Cell cell) {
+        if (length > 0) {
+            headSlot = headSlot + 1 == cells.size() ? 0 : headSlot + 1;
+        }
+        cells[headSlot] = cell;
+        length++;
+    }
+
+    /*
+      Retire la queue
+      retourne La case libérée
+    */
+    Cell PopTail() {
+        Cell tail = Tail();
+        length--;
+        return tail;
+    }
+
+    /*
+      Agrandit le tampon en gardant les segments (pour un serpent sans longueur maximale connue)
+      parametre "capacity" Nouvelle capacité, au moins Length()
+    */
+    void Grow(uint32_t capacity) {
+        std::vector<Cell> resized(capacity);
+        for (uint32_t i = 0; i < length; i++) {
+            resized[length - 1 - i] = At(i);
+        }
+        cells.swap(resized);
+        headSlot = length > 0 ? length - 1 : 0;
+    }
+
+    Cell Head() const { return cells[headSlot]; }
+    Cell Tail() const { return At(length - 1); }
+    uint32_t Length() const { return length; }
+    uint32_t Capacity() const { return (uint32_t)cells.size(); }
+
+    /*
+      retourne La case du segment "index" (0 = tête)
+    */
+    Cell At(uint32_t index) const {
+        uint32_t slot = headSlot >= index ? headSlot - index : headSlot + (uint32_t)cells.size() - index;
+        return cells[slot];
+    }
+
+    /*
+      Appelle "visit" pour chaque segment, de la tête à la queue
+    */
+    template <class Visit>
+    void ForEach(Visit&& visit) const {
+        uint32_t slot = headSlot;
+        for (uint32_t i = 0; i < length; i++) {
+            visit(cells[slot]);
+            slot = slot == 0 ? (uint32_t)cells.size() - 1 : slot - 1;
+        }
+    }
+
+    /*
+      Appelle "visit" pour chaque segment, de la queue à la tête
+    */
+    template <class Visit>
+    void ForEachFromTail(Visit&& visit) const {
+        if (length == 0) {
+            return;
+        }
+        uint32_t slot = headSlot >= length - 1 ? headSlot - (length - 1) : headSlot + (uint32_t)cells.size() - (length - 1);
+        for (uint32_t i = 0; i < length; i++) {
+            visit(cells[slot]);
+            slot = slot + 1 == cells.size() ? 0 : slot + 1;
+        }
+    }
+
+private:
+    std::vector<Cell> cells;  // Cases du corps, rangées circulairement
+    uint32_t headSlot = 0;    // Emplacement de la tête dans "cells"
+    uint32_t length = 0;      // Nombre de segments
+};
+#endif
+
+/*
+  Index des cases libres : tableau partitionné [libres | occupées] et index inverse.
+  Ajout, retrait et tirage uniforme d'une case libre en O(1), quel que soit
+  le remplissage de la grille.
+*/
+class FreeCells {
+public:
+    /*
+      Dimensionne l'index, toutes les cases étant libres
+      parametre "cellCount" Nombre de cases
+    */
+    void Init(uint32_t cellCount) {
+        cells.resize(cellCount);
+        slots.resize(cellCount);
+        Fill();
+    }
+
+    /*
+      Marque toutes les cases comme libres
+    */
+    void Fill() {
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            cells[i] = i;
+            slots[i] = i;
+        }
+        count = (uint32_t)cells.size();
+    }
+
+    bool Contains(Cell cell) const { return slots[cell] < count; }
+    uint32_t Count() const { return count; }
+    uint32_t Size() const { return (uint32_t)cells.size(); }
+    Cell At(uint32_t index) const { return cells[index]; }
+
+    /*
+      Restaure un ordre complet des cases (libres puis occupées), tel que
+      lu par At(0) ... At(Size() - 1) ; les tirages suivants en dépendent
+      parametre "order" Les Size() cases dans leur ordre
+      parametre "freeCount" Nombre de cases libres en tête de "order"
+    */
+    void Load(const Cell* order, uint32_t freeCount) {
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            cells[i] = order[i];
+            slots[order[i]] = i;
+        }
+        count = freeCount;
+    }
+
+    /*
+      Retire une case de l'ensemble (sans effet si elle est déjà occupée)
+      parametre "cell" La case qui devient occupée
+    */
+    void Remove(Cell cell) {
+        uint32_t slot = slots[cell];
+        if (slot >= count) {
+            return;
+        }
+        count--;
+        Swap(slot, count);
+    }
+
+    /*
+      Ajoute une case à l'ensemble (sans effet si elle est déjà libre)
+      parametre "cell" La case qui devient libre
+    */
+    void Insert(Cell cell) {
+        uint32_t slot = slots[cell];
+        if (slot < count) {
+            return;
+        }
+        Swap(slot, count);
+        count++;
+    }
+
+private:
+    void Swap(uint32_t a, uint32_t b) {
+        Cell cellA = cells[a];
+        Cell cellB = cells[b];
+        cells[a] = cellB;
+        slots[cellB] = a;
+        cells[b] = cellA;
+        slots[cellA] = b;
+    }
+
+    std::vector<Cell> cells;      // Cases, les "count" premières sont libres
+    std::vector<uint32_t> slots;  // Position de chaque case dans "cells"
+    uint32_t count = 0;           // Nombre de cases libres
+};
+
+/*
+  Contenu d'une case de la grille
+*/
+enum class CellContent : uint8_t {
+    Empty,
+    Snake,
+    Fruit,
+    Obstacle,
+    Count
+};
+
+/*
+  Action transmise à la simulation pour un pas de jeu
+*/
+enum class SimAction {
+    None,   // Aucune touche : le serpent garde sa direction
+    Up,
+    Down,
+    Left,
+    Right
+};
+
+/*
+  Résultat d'un pas de simulation
+*/
+enum class SimOutcome {
+    Waiting,      // La partie n'a pas encore commencé
+    Moved,        // Le serpent a avancé normalement
+    AteFruit,     // Le serpent a mangé la nourriture
+    HitSelf,      // Le serpent s'est mordu : fin de partie
+    HitObstacle,  // Le serpent a heurté un obstacle : fin de partie
+    BoardFull,    // Plus aucune case libre pour la nourriture : partie gagnée
+    GameOver      // La partie était déjà terminée, rien n'a changé
+};
+
+struct SimState;
+
+/*
+  Pas de simulation compilé pour une taille de grille (voir Step)
+*/
+typedef SimOutcome (*StepFunction)(SimState& state, SimAction action);
+
+/*
+  État complet d'une partie
+*/
+struct SimState {
+    GridShape grid;                     // Dimensions, à choisir avant InitState
+    StepFunction stepFunction = nullptr;  // Pas spécialisé pour ces dimensions (choisi par InitState)
+    SnakeBody body;                     // Corps du serpent
+    Bitboard blockedCells;              // Cases interdites à la tête : serpent, obstacles et murs
+    Bitboard obstacleCells;             // Cases des obstacles et des murs posés
+    FreeCells freeCells;                // Cases ni serpent, ni obstacle, ni mur, ni nourriture
+    int dirX = 1;                       // Direction du mouvement (x)
+    int dirY = 0;                       // Direction du mouvement (y)
+    bool shouldGrow = false;            // Le serpent doit grandir au prochain mouvement
+    Cell fruitPosition = NO_CELL;       // Position de la nourriture
+    std::vector<Cell> obstacles;        // Positions des obstacles
+    int obstacleCount = 2;              // Nombre d'obstacles replacés à chaque nourriture
+    int score = 0;                      // Score de la partie en cours
+    bool started = false;               // Le joueur a donné une première direction
+    bool gameOver = false;              // La partie est terminée
+    uint64_t tick = 0;                  // Nombre de pas joués depuis le début de la partie
+    uint64_t rng = 0;                   // État du générateur pseudo-aléatoire
+    uint64_t gameSeed = 0;              // État du générateur au début de la partie (la redonne à l'identique)
+
+    // Niveau (à choisir avant InitState) : il impose les dimensions, le départ, la table de
+    // nourriture et le nombre d'obstacles. Ses murs sont posés par blocs, ceux qui entourent
+    // la tête et ceux où tombe un tirage, sans jamais parcourir toute la carte.
+    const Level* level = nullptr;       // nullptr : grille vide, départ et nourriture d'origine
+    Bitboard loadedChunks;              // Blocs du niveau dont les murs sont posés
+    uint32_t levelChunk = NO_CELL;      // Bloc de la tête lors du dernier chargement
+    uint32_t nextFruit = 0;             // Prochaine entrée de la table de nourriture
+
+    // Journal des cases modifiées, utilisé par l'affichage pour ne mettre à jour que ce qui a bougé
+    bool trackChanges = false;          // Active le journal (désactivé pour les calculs en masse)
+    std::vector<Cell> changedCells;     // Cases modifiées depuis la dernière lecture du journal
+    bool fullRefresh = true;            // Toute la grille a changé (nouvelle partie)
+};
+
+/*
+  Initialise une nouvelle partie avec une graine donnée.
+  Les tableaux sont dimensionnés d'après state.grid (ou d'après state.level).
+  parametre "state" L'état à initialiser
+  parametre "seed" Graine du générateur pseudo-aléatoire
+*/
+void InitState(SimState& state, uint64_t seed);
+
+/*
+  Recommence une partie en conservant le générateur pseudo-aléatoire
+  parametre "state" L'état à réinitialiser
+*/
+void ResetState(SimState& state);
+
+/*
+  Joue un pas de simulation : applique l'action, déplace le serpent
+  puis vérifie la nourriture et les collisions.
+  Les tailles courantes ont une version compilée pour leurs dimensions
+  (divisions par des constantes, bords par masque pour une puissance de deux).
+  parametre "state" L'état de la partie
+  parametre "action" L'action du joueur pour ce pas
+  retourne Le résultat du pas
+*/
+inline SimOutcome Step(SimState& state, SimAction action) {
+    return state.stepFunction(state, action);
+}
+
+/*
+  retourne true si ces dimensions ont une version spécialisée de Step
+*/
+bool HasFixedStep(const GridShape& grid);
+
+/*
+  Lit des dimensions écrites "LxH" ou "N" (grille carrée)
+  parametre "text" Le texte à lire
+  parametre "grid" Reçoit les dimensions
+  retourne false si le texte n'est pas valide ou hors de [MIN_GRID_SIZE, MAX_GRID_SIZE]
+*/
+bool ParseGridShape(const char* text, GridShape& grid);
+
+/*
+  Donne le contenu d'une case
+  parametre "state" L'état de la partie
+  parametre "cell" La case à examiner
+  retourne Serpent, nourriture, obstacle ou vide
+*/
+CellContent ClassifyCell(const SimState& state, Cell cell);
+
+/*
+  Donne la direction actuelle du serpent sous forme d'action
+  parametre "state" L'état de la partie
+  retourne L'action qui correspond à la direction du mouvement
+*/
+SimAction CurrentDirection(const SimState& state);
+
+/*
+  retourne L'action de sens opposé (None pour None)
+*/
+SimAction OppositeAction(SimAction action);
+
+/*
+  Générateur splitmix64 : rapide, déterministe et valable pour toute graine
+  parametre "rng" État du générateur (modifié)
+  retourne 64 bits pseudo-aléatoires
+*/
+uint64_t NextRandom(uint64_t& rng);
+
+/*
+  Tire un entier pseudo-aléatoire dans [0, bound)
+  parametre "rng" État du générateur (modifié)
+  parametre "bound" Borne supérieure exclue
+  retourne Entier aléatoire
+*/
+uint32_t RandomBelow(uint64_t& rng, uint32_t bound);
+
+/*
+  Graine d'un flux indépendant, dérivée d'une graine commune et d'un numéro
+  (partie d'un lot, serpent d'une arène...)
+  parametre "seed" Graine commune
+  parametre "index" Numéro du flux
+  retourne La graine du flux
+*/
+uint64_t StreamSeed(uint64_t seed, uint32_t index);
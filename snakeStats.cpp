@@ -0,0 +1,64 @@
+﻿#include "snakeStats.h"
+
+#include <algorithm>
+#include <cstdio>
+using namespace std;
+
+LatencyStats::LatencyStats(uint32_t capacity) {
+    samples.reserve(capacity);
+    sorted.reserve(capacity);
+}
+
+void LatencyStats::Add(double microseconds) {
+    if (samples.size() < samples.capacity()) {
+        samples.push_back(microseconds);
+    }
+    else {
+        samples[nextSample] = microseconds;
+        nextSample = nextSample + 1 == samples.size() ? 0 : nextSample + 1;
+    }
+    count++;
+    sum += microseconds;
+    maximum = max(maximum, microseconds);
+}
+
+void LatencyStats::Merge(const LatencyStats& other) {
+    double keptSum = 0;
+    for (double sample : other.samples) {
+        Add(sample);
+        keptSum += sample;
+    }
+    // Mesures déjà sorties du tampon de l'autre : comptées dans le total seulement
+    count += other.count - other.samples.size();
+    sum += other.sum - keptSum;
+    maximum = max(maximum, other.maximum);
+}
+
+void LatencyStats::Clear() {
+    samples.clear();
+    nextSample = 0;
+    count = 0;
+    sum = 0;
+    maximum = 0;
+}
+
+double LatencyStats::Percentile(double percent) const {
+    if (samples.empty()) {
+        return 0;
+    }
+    sorted.assign(samples.begin(), samples.end());
+    size_t index = (size_t)(percent / 100 * (sorted.size() - 1) + 0.5);
+    nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+string LatencyStats::Summary() const {
+    char buffer[160];
+    Format(buffer, sizeof(buffer));
+    return buffer;
+}
+
+void LatencyStats::Format(char* buffer, size_t size) const {
+    snprintf(buffer, size, "n=%llu mean=%.3fms p50=%.3fms p99=%.3fms max=%.3fms",
+        (unsigned long long)count, Mean() / 1000, Percentile(50) / 1000, Percentile(99) / 1000, Max() / 1000);
+}
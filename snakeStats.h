@@ -0,0 +1,72 @@
+﻿// Statistiques de latence (moyenne, percentiles, maximum), sans dépendance à SFML
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+  Accumule des mesures de durée et en donne un résumé.
+  Les dernières "capacity" mesures sont gardées pour le calcul des percentiles.
+  Tous les tableaux sont alloués par le constructeur : Add, Percentile et
+  Format n'allouent rien.
+*/
+class LatencyStats {
+public:
+    /*
+      Constructeur
+      parametre "capacity" Nombre de mesures gardées pour les percentiles
+    */
+    explicit LatencyStats(uint32_t capacity = 4096);
+
+    /*
+      Ajoute une mesure
+      parametre "microseconds" Durée mesurée en microsecondes
+    */
+    void Add(double microseconds);
+
+    /*
+      Ajoute les mesures d'un autre accumulateur (fils de mesure réunis en fin de session) ;
+      les percentiles portent sur ses mesures gardées, dans la limite de la capacité
+      parametre "other" L'accumulateur à ajouter
+    */
+    void Merge(const LatencyStats& other);
+
+    /*
+      Efface toutes les mesures
+    */
+    void Clear();
+
+    uint64_t Count() const { return count; }
+    double Mean() const { return count > 0 ? sum / count : 0; }
+    double Max() const { return maximum; }
+
+    /*
+      Donne un percentile des dernières mesures
+      parametre "percent" Percentile voulu, entre 0 et 100
+      retourne La durée en microsecondes
+    */
+    double Percentile(double percent) const;
+
+    /*
+      Résumé lisible : nombre, moyenne, p50, p99 et maximum en millisecondes
+    */
+    std::string Summary() const;
+
+    /*
+      Écrit le résumé de Summary dans un tableau, sans allocation
+      parametre "buffer" Tableau à remplir (terminé par 0)
+      parametre "size" Taille du tableau
+    */
+    void Format(char* buffer, size_t size) const;
+
+private:
+    std::vector<double> samples;         // Dernières mesures (tampon circulaire)
+    mutable std::vector<double> sorted;  // Copie triée partiellement par Percentile
+    uint32_t nextSample = 0;             // Prochain emplacement à écrire
+    uint64_t count = 0;                  // Nombre total de mesures
+    double sum = 0;                      // Somme de toutes les mesures
+    double maximum = 0;                  // Plus grande mesure
+};
@@ -0,0 +1,335 @@
+﻿#include "snakeThread.h"
+#include "snakeProfiler.h"
+
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+void CaptureSnapshot(SimState& state, SimSnapshot& snapshot) {
+    snapshot.grid = state.grid;
+    snapshot.body.resize(state.body.Length());
+    Cell* segment = snapshot.body.data();
+    state.body.ForEach([&segment](Cell cell) { *segment++ = cell; });
+    snapshot.fruitPosition = state.fruitPosition;
+    snapshot.obstacles.assign(state.obstacles.begin(), state.obstacles.end());
+
+    snapshot.changes.clear();
+    for (Cell cell : state.changedCells) {
+        snapshot.changes.push_back({ cell, ClassifyCell(state, cell) });
+    }
+    state.changedCells.clear();
+
+    snapshot.dirX = state.dirX;
+    snapshot.dirY = state.dirY;
+    snapshot.score = state.score;
+    snapshot.tick = state.tick;
+    snapshot.gameSeed = state.gameSeed;
+    snapshot.started = state.started;
+    snapshot.gameOver = state.gameOver;
+}
+
+void CaptureArenaSnapshot(Arena& arena, uint32_t player, SimSnapshot& snapshot, bool full) {
+    const ArenaSnake& snake = arena.Snake(player);
+    snapshot.grid = arena.Grid();
+    snapshot.body.resize(snake.body.Length());
+    Cell* segment = snapshot.body.data();
+    snake.body.ForEach([&segment](Cell cell) { *segment++ = cell; });
+    snapshot.fruitPosition = NO_CELL;
+    snapshot.obstacles.assign(arena.Obstacles().begin(), arena.Obstacles().end());
+
+    // Contenu complet seulement pour une reconstruction : les autres pas ne portent que les changements
+    snapshot.fruits.clear();
+    snapshot.rivals.clear();
+    if (full) {
+        for (Cell fruit : arena.Fruits()) {
+            if (fruit != NO_CELL) {
+                snapshot.fruits.push_back(fruit);
+            }
+        }
+        for (uint32_t i = 0; i < arena.SnakeCount(); i++) {
+            const ArenaSnake& rival = arena.Snake(i);
+            if (i == player || !rival.alive) {
+                continue;
+            }
+            rival.body.ForEach([&snapshot](Cell cell) { snapshot.rivals.push_back(cell); });
+        }
+    }
+
+    snapshot.changes.clear();
+    for (Cell cell : arena.changedCells) {
+        snapshot.changes.push_back({ cell, arena.ClassifyCell(cell) });
+    }
+    arena.changedCells.clear();
+
+    snapshot.dirX = snake.dirX;
+    snapshot.dirY = snake.dirY;
+    snapshot.score = snake.score;
+    snapshot.tick = arena.Tick();
+    snapshot.gameSeed = 0;
+    snapshot.started = true;
+    snapshot.gameOver = false;
+}
+
+void ReserveSnapshot(const SimState& state, SimSnapshot& snapshot) {
+    snapshot.body.reserve(min(state.grid.CellCount(), SNAPSHOT_RESERVED_CELLS));
+    snapshot.obstacles.reserve(state.obstacleCount);
+    snapshot.changes.reserve(state.changedCells.capacity());
+}
+
+void ReserveArenaSnapshot(const Arena& arena, SimSnapshot& snapshot) {
+    uint32_t reserved = min(arena.Grid().CellCount(), SNAPSHOT_RESERVED_CELLS);
+    snapshot.body.reserve(reserved);
+    snapshot.rivals.reserve(reserved);
+    snapshot.fruits.reserve(arena.Fruits().size());
+    snapshot.obstacles.reserve(arena.Obstacles().size());
+    snapshot.changes.reserve(arena.changedCells.capacity());
+}
+
+void SimThread::Start(uint64_t seed, chrono::nanoseconds tickInterval, const string& recordPath, const GridShape& grid) {
+    interval = tickInterval;
+    state.trackChanges = true;
+    state.grid = grid;
+    state.level = level;
+    InitState(state, seed);
+    if (!recordPath.empty() && level != nullptr) {
+        cout << "Replays are not recorded on a level" << endl;
+    }
+    else if (!recordPath.empty()) {
+        if (recorder.Open(recordPath, state.grid)) {
+            recorder.BeginGame(state);
+        }
+        else {
+            cout << "Error creating replay file " << recordPath << endl;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        ReserveSnapshot(state, snapshots.Buffer(i));
+    }
+    Publish(state.body.Head(), state.body.Tail());
+
+    Launch();
+}
+
+bool SimThread::StartPlayback(const string& replayPath, chrono::nanoseconds tickInterval) {
+    interval = tickInterval;
+    state.trackChanges = true;
+    InitState(state, 0);
+    if (!playback.Open(replayPath) || !playback.Seek(0, 0, state)) {
+        playback.Close();
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        ReserveSnapshot(state, snapshots.Buffer(i));
+    }
+    Publish(state.body.Head(), state.body.Tail());
+
+    Launch();
+    return true;
+}
+
+void SimThread::StartArena(uint64_t seed, chrono::nanoseconds tickInterval, uint32_t snakeCount, const GridShape& grid) {
+    interval = tickInterval;
+    arena.trackChanges = true;
+    arena.Init(grid, max(snakeCount, 1u), max(snakeCount / 2, 1u), snakeCount / 4, seed, 0, level);
+    arena.SetBot(ARENA_PLAYER, false);
+    // Arène trop pleine pour placer le joueur tout de suite : les autres serpents avancent d'abord
+    while (!arena.Snake(ARENA_PLAYER).alive) {
+        arena.Step();
+    }
+    state.grid = arena.Grid();
+    for (int i = 0; i < 3; i++) {
+        ReserveArenaSnapshot(arena, snapshots.Buffer(i));
+    }
+    Publish(arena.Snake(ARENA_PLAYER).body.Head(), arena.Snake(ARENA_PLAYER).body.Tail());
+
+    Launch();
+}
+
+void SimThread::Launch() {
+    running = true;
+    if (!manualStepping) {
+        thread = std::thread(&SimThread::Run, this);
+    }
+}
+
+void SimThread::Stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (!recorder.Close()) {
+        cout << "Error writing replay file (recording incomplete)" << endl;
+    }
+}
+
+void SimThread::PushTurn(SimAction action, InputClock::time_point pressedAt) {
+    SimCommand command;
+    command.type = SimCommand::Type::Turn;
+    command.action = action;
+    command.pressedAt = pressedAt;
+    commands.Push(command);
+}
+
+void SimThread::RequestRestart() {
+    SimCommand command;
+    command.type = SimCommand::Type::Restart;
+    commands.Push(command);
+}
+
+void SimThread::SetAutopilot(bool enabled) {
+    SimCommand command;
+    command.type = SimCommand::Type::Autopilot;
+    command.enabled = enabled;
+    commands.Push(command);
+}
+
+void SimThread::Publish(Cell previousHead, Cell previousTail) {
+    SimSnapshot& snapshot = snapshots.WriteBuffer();
+    bool newGeneration = state.fullRefresh;
+    if (state.fullRefresh) {
+        generation++;
+        state.fullRefresh = false;
+    }
+    if (IsArena()) {
+        // Le lecteur ne reconstruit qu'à une nouvelle partie ou après un instantané manqué : si le précédent
+        // n'est toujours pas lu, celui-ci peut le remplacer et doit porter tout le contenu
+        CaptureArenaSnapshot(arena, ARENA_PLAYER, snapshot, newGeneration || snapshots.Unread());
+    }
+    else {
+        CaptureSnapshot(state, snapshot);
+    }
+    snapshot.sequence = ++sequence;
+    snapshot.generation = generation;
+    snapshot.tickTime = InputClock::now();
+    snapshot.previousHead = previousHead;
+    snapshot.previousTail = previousTail;
+    snapshots.Publish();
+}
+
+void SimThread::Run() {
+    PROFILE_THREAD("simulation");
+    // Les échéances sont calculées depuis le départ : un retard ponctuel ne décale pas les pas suivants
+    InputClock::time_point nextTick = InputClock::now();
+    while (running) {
+        nextTick += interval;
+        this_thread::sleep_until(nextTick);
+        Tick();
+    }
+}
+
+void SimThread::Tick() {
+    PROFILE_SCOPE("tick");
+
+    // Commandes reçues depuis le dernier pas
+    SimCommand command;
+    while (commands.Pop(command)) {
+        if (command.type == SimCommand::Type::Restart) {
+            if (state.gameOver && playback.IsOpen()) {
+                playback.Seek(min(playback.CurrentGame() + 1, playback.GameCount() - 1), 0, state);
+            }
+            else if (state.gameOver) {
+                ResetState(state);
+                turns.Clear();
+                recorder.BeginGame(state);
+            }
+        }
+        else if (command.type == SimCommand::Type::Autopilot) {
+            autopilotEnabled = command.enabled;
+            turns.Clear();
+        }
+        else if (IsArena() && !autopilotEnabled) {
+            turns.Push(command.action, arena.Direction(ARENA_PLAYER), command.pressedAt);
+        }
+        else if (!state.gameOver && !playback.IsOpen() && !autopilotEnabled) {
+            turns.Push(command.action, state.started ? CurrentDirection(state) : SimAction::None, command.pressedAt);
+        }
+    }
+    if (IsArena()) {
+        ArenaStep();
+        return;
+    }
+
+    Cell previousHead = state.body.Head();
+    Cell previousTail = state.body.Tail();
+    SimOutcome outcome = playback.IsOpen() ? PlaybackStep() : PlayerStep();
+    if (outcome == SimOutcome::Waiting || outcome == SimOutcome::GameOver) {
+        previousHead = state.body.Head();
+        previousTail = state.body.Tail();
+    }
+    Publish(previousHead, previousTail);
+}
+
+SimOutcome SimThread::PlayerStep() {
+    // Un pas avec au plus un virage, enregistré sur 2 bits
+    TurnRequest turn;
+    bool hasTurn = turns.Pop(turn);
+    if (autopilotEnabled) {
+        PROFILE_SCOPE("autopilot");
+        turn.action = autopilot.Decide(state);
+    }
+    SimAction directionBefore = CurrentDirection(state);
+    bool startedBefore = state.started;
+    SimOutcome outcome = Step(state, turn.action);
+    if (hasTurn) {
+        inputLatency.Add(chrono::duration<double, micro>(InputClock::now() - turn.pressedAt).count());
+    }
+    if (outcome != SimOutcome::Waiting && outcome != SimOutcome::GameOver) {
+        recorder.RecordTick(EncodeTurn(directionBefore, startedBefore, state), state);
+    }
+    if (outcome == SimOutcome::HitSelf || outcome == SimOutcome::HitObstacle || outcome == SimOutcome::BoardFull) {
+        turns.Clear();
+        recorder.EndGame(state);
+        // Résumés écrits sans allocation : le fil de simulation n'alloue pas en régime établi
+        char summary[160];
+        inputLatency.Format(summary, sizeof(summary));
+        cout << "Input latency: " << summary << endl;
+        if (autopilot.decisionLatency.Count() > 0) {
+            autopilot.decisionLatency.Format(summary, sizeof(summary));
+            cout << "Autopilot decisions: " << summary << endl;
+        }
+    }
+    return outcome;
+}
+
+void SimThread::ArenaStep() {
+    TurnRequest turn;
+    bool hasTurn = turns.Pop(turn);
+    const ArenaSnake& player = arena.Snake(ARENA_PLAYER);
+    bool wasAlive = player.alive;
+    Cell previousHead = wasAlive ? player.body.Head() : NO_CELL;
+    Cell previousTail = wasAlive ? player.body.Tail() : NO_CELL;
+    arena.SetBot(ARENA_PLAYER, autopilotEnabled);
+    arena.SetAction(ARENA_PLAYER, turn.action);
+    {
+        PROFILE_SCOPE("arena");
+        arena.Step();
+    }
+    if (hasTurn) {
+        inputLatency.Add(chrono::duration<double, micro>(InputClock::now() - turn.pressedAt).count());
+    }
+    // Joueur en attente d'une place : l'affichage garde le dernier instantané
+    // (les changements s'accumulent dans le journal de l'arène jusqu'au suivant)
+    if (!player.alive) {
+        return;
+    }
+    // Réapparition ailleurs : pas d'interpolation depuis l'ancienne position
+    if (!wasAlive || IsDeath(arena.Outcome(ARENA_PLAYER))) {
+        previousHead = player.body.Head();
+        previousTail = player.body.Tail();
+        turns.Clear();
+    }
+    Publish(previousHead, previousTail);
+}
+
+SimOutcome SimThread::PlaybackStep() {
+    if (state.gameOver) {
+        return SimOutcome::GameOver;
+    }
+    SimOutcome outcome;
+    if (!playback.Next(state, outcome)) {
+        // Enregistrement interrompu avant la fin de la partie : elle s'arrête là
+        state.gameOver = true;
+        return SimOutcome::GameOver;
+    }
+    return outcome;
+}
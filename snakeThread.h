@@ -0,0 +1,334 @@
+﻿// Simulation sur son propre fil d'exécution, à cadence fixe (sans dépendance à SFML)
+//
+// Le fil de simulation publie après chaque pas un instantané immuable de la
+// partie dans un triple tampon sans verrou ; l'affichage lit le plus récent
+// à sa propre cadence. Les touches passent dans l'autre sens par une file
+// sans verrou à un producteur et un consommateur.
+
+#pragma once
+
+#include "snakeArena.h"
+#include "snakeAutopilot.h"
+#include "snakeInput.h"
+#include "snakeReplay.h"
+#include "snakeSim.h"
+#include "snakeStats.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+  Case modifiée par un pas, avec son nouveau contenu
+*/
+struct CellChange {
+    Cell cell;
+    CellContent content;
+};
+
+/*
+  Instantané d'une partie, publié après chaque pas
+*/
+struct SimSnapshot {
+    uint64_t sequence = 0;               // Numéro de publication (croissant)
+    uint64_t generation = 0;             // Numéro de partie (change à chaque nouvelle partie)
+    GridShape grid;                      // Dimensions de la grille
+    InputClock::time_point tickTime;     // Instant du pas
+    std::vector<Cell> body;              // Corps du serpent, tête en premier
+    Cell previousHead = 0;               // Tête avant ce pas (pour l'interpolation)
+    Cell previousTail = 0;               // Queue avant ce pas
+    Cell fruitPosition = NO_CELL;        // Position de la nourriture
+    std::vector<Cell> obstacles;         // Positions des obstacles
+    std::vector<CellChange> changes;     // Cases modifiées par ce pas
+    std::vector<Cell> rivals;            // Arène : cases des autres serpents
+    std::vector<Cell> fruits;            // Arène : nourritures (fruitPosition est alors NO_CELL)
+    int dirX = 1;                        // Direction du mouvement
+    int dirY = 0;
+    int score = 0;
+    uint64_t tick = 0;                   // Pas joués depuis le début de la partie
+    uint64_t gameSeed = 0;               // Graine de la partie (voir SimState::gameSeed)
+    bool started = false;
+    bool gameOver = false;
+};
+
+/*
+  Copie l'état d'une partie dans un instantané et vide le journal des cases modifiées.
+  Les tableaux de l'instantané gardent leur capacité : pas d'allocation en régime établi.
+  parametre "state" L'état de la partie (son journal est vidé)
+  parametre "snapshot" L'instantané à remplir
+*/
+void CaptureSnapshot(SimState& state, SimSnapshot& snapshot);
+
+/*
+  Copie l'état d'une arène vu par un serpent (le joueur) dans un instantané et vide
+  le journal des cases modifiées. Le serpent doit être sur la grille.
+  parametre "arena" L'arène (son journal est vidé)
+  parametre "player" Numéro du serpent suivi par l'affichage
+  parametre "snapshot" L'instantané à remplir
+  parametre "full" Copier aussi les autres serpents et les nourritures (rivals, fruits), nécessaires
+                   seulement à un lecteur qui reconstruit la grille ; sinon ces tableaux sont vidés
+*/
+void CaptureArenaSnapshot(Arena& arena, uint32_t player, SimSnapshot& snapshot, bool full);
+
+// Cases du corps réservées d'avance dans un instantané (au-delà, le tableau grandit)
+const uint32_t SNAPSHOT_RESERVED_CELLS = 1 << 20;
+
+/*
+  Réserve les tableaux d'un instantané pour la grille et les obstacles d'une partie :
+  CaptureSnapshot n'alloue ensuite plus rien, même au premier passage à une longueur
+  (tant que le serpent ne dépasse pas SNAPSHOT_RESERVED_CELLS cases)
+  parametre "state" L'état de la partie (après InitState)
+  parametre "snapshot" L'instantané à préparer
+*/
+void ReserveSnapshot(const SimState& state, SimSnapshot& snapshot);
+
+/*
+  Réserve les tableaux d'un instantané pour une arène, comme ReserveSnapshot
+  (les autres serpents jusqu'à SNAPSHOT_RESERVED_CELLS cases)
+  parametre "arena" L'arène (après Init)
+  parametre "snapshot" L'instantané à préparer
+*/
+void ReserveArenaSnapshot(const Arena& arena, SimSnapshot& snapshot);
+
+/*
+  Triple tampon sans verrou : un écrivain et un lecteur travaillent chacun sur
+  leur tampon, le troisième sert d'échange. Le lecteur obtient toujours
+  l'instantané complet le plus récent, sans jamais bloquer l'écrivain.
+*/
+template <class T>
+class TripleBuffer {
+public:
+    /*
+      retourne Le tampon que l'écrivain peut remplir
+    */
+    T& WriteBuffer() { return buffers[back]; }
+
+    /*
+      Publie le tampon de l'écrivain
+    */
+    void Publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /*
+      retourne true si le dernier tampon publié n'a pas encore été lu : s'il est
+      remplacé avant d'être lu, le lecteur verra un trou dans la suite des publications
+    */
+    bool Unread() const { return (middle.load(std::memory_order_acquire) & FRESH) != 0; }
+
+    /*
+      Récupère le dernier tampon publié, s'il est nouveau
+      retourne true si ReadBuffer() a changé
+    */
+    bool Acquire() {
+        if ((middle.load(std::memory_order_acquire) & FRESH) == 0) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /*
+      retourne Le tampon du lecteur (valable jusqu'au prochain Acquire)
+    */
+    const T& ReadBuffer() const { return buffers[front]; }
+
+    /*
+      Accès direct à un des trois tampons, avant que l'écrivain et le lecteur ne démarrent
+    */
+    T& Buffer(int index) { return buffers[index]; }
+
+private:
+    static const uint8_t INDEX = 3;  // Bits de l'indice du tampon d'échange
+    static const uint8_t FRESH = 4;  // Le tampon d'échange n'a pas encore été lu
+
+    T buffers[3];
+    std::atomic<uint8_t> middle{ 1 };  // Tampon d'échange
+    uint8_t back = 0;                  // Tampon de l'écrivain
+    uint8_t front = 2;                 // Tampon du lecteur
+};
+
+/*
+  File bornée sans verrou pour un producteur et un consommateur
+*/
+template <class T, uint32_t CAPACITY>
+class SpscQueue {
+public:
+    /*
+      retourne false si la file est pleine
+    */
+    bool Push(const T& item) {
+        uint32_t tail = writeIndex.load(std::memory_order_relaxed);
+        if (tail - readIndex.load(std::memory_order_acquire) == CAPACITY) {
+            return false;
+        }
+        items[tail % CAPACITY] = item;
+        writeIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+      retourne false si la file est vide
+    */
+    bool Pop(T& item) {
+        uint32_t head = readIndex.load(std::memory_order_relaxed);
+        if (head == writeIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[head % CAPACITY];
+        readIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[CAPACITY];
+    std::atomic<uint32_t> writeIndex{ 0 };
+    std::atomic<uint32_t> readIndex{ 0 };
+};
+
+// Serpent dirigé par le joueur dans une arène
+const uint32_t ARENA_PLAYER = 0;
+
+/*
+  Commande envoyée par l'affichage au fil de simulation
+*/
+struct SimCommand {
+    enum class Type { Turn, Restart, Autopilot };
+    Type type = Type::Turn;
+    SimAction action = SimAction::None;
+    bool enabled = false;               // Autopilot : activer ou couper le pilote automatique
+    InputClock::time_point pressedAt;
+};
+
+/*
+  Fil de simulation à cadence fixe
+*/
+class SimThread {
+public:
+    ~SimThread() { Stop(); }
+
+    /*
+      Crée la partie et lance le fil
+      parametre "seed" Graine du générateur pseudo-aléatoire
+      parametre "tickInterval" Durée d'un pas
+      parametre "recordPath" Fichier où enregistrer les parties (vide : pas d'enregistrement)
+      parametre "grid" Dimensions de la grille
+    */
+    void Start(uint64_t seed, std::chrono::nanoseconds tickInterval, const std::string& recordPath = "",
+               const GridShape& grid = GridShape());
+
+    /*
+      Relit un enregistrement au lieu de jouer ; les virages envoyés sont ignorés
+      et une nouvelle partie demandée passe à la partie enregistrée suivante.
+      La grille est celle de l'enregistrement.
+      parametre "replayPath" Fichier enregistré
+      parametre "tickInterval" Durée d'un pas
+      retourne false si le fichier ne peut pas être lu
+    */
+    bool StartPlayback(const std::string& replayPath, std::chrono::nanoseconds tickInterval);
+
+    /*
+      Joue dans une arène : le joueur dirige le serpent ARENA_PLAYER, les autres
+      sont des robots. Un serpent mort réapparaît aussitôt : la partie ne finit pas.
+      parametre "seed" Graine de l'arène
+      parametre "tickInterval" Durée d'un pas
+      parametre "snakeCount" Nombre de serpents, joueur compris
+      parametre "grid" Dimensions de la grille
+    */
+    void StartArena(uint64_t seed, std::chrono::nanoseconds tickInterval, uint32_t snakeCount, const GridShape& grid);
+
+    /*
+      Pas joués à la demande : Start, StartPlayback et StartArena ne lancent pas de fil
+      et chaque appel à Advance joue un pas (rendu hors écran, où la cadence suit
+      l'affichage et non l'horloge). À appeler avant le démarrage.
+    */
+    void SetManualStepping(bool manual) { manualStepping = manual; }
+
+    /*
+      Joue sur un niveau (dimensions, murs, départs, nourriture) au lieu d'une grille vide.
+      Les parties ne sont alors pas enregistrées : le format d'enregistrement ne désigne
+      pas de niveau. Le niveau doit rester ouvert tant que le fil tourne. À appeler
+      avant Start ou StartArena.
+    */
+    void SetLevel(const Level* playLevel) { level = playLevel; }
+
+    /*
+      Joue un pas et publie son instantané, sur le fil appelant (voir SetManualStepping)
+    */
+    void Advance() { Tick(); }
+
+    /*
+      Arrête le fil et attend sa fin
+    */
+    void Stop();
+
+    /*
+      Envoie un virage ; il sera appliqué au plus tôt au prochain pas
+    */
+    void PushTurn(SimAction action, InputClock::time_point pressedAt);
+
+    /*
+      Demande une nouvelle partie si la partie en cours est terminée
+    */
+    void RequestRestart();
+
+    /*
+      Active ou coupe le pilote automatique ; les virages du joueur sont alors ignorés
+    */
+    void SetAutopilot(bool enabled);
+
+    /*
+      Récupère le dernier instantané publié
+      retourne true si un nouvel instantané est disponible dans Latest()
+    */
+    bool Acquire() { return snapshots.Acquire(); }
+    const SimSnapshot& Latest() const { return snapshots.ReadBuffer(); }
+
+    std::chrono::nanoseconds TickInterval() const { return interval; }
+
+    /*
+      retourne Les dimensions de la grille (fixées au démarrage du fil)
+    */
+    const GridShape& Grid() const { return state.grid; }
+
+    /*
+      retourne true si le fil relit un enregistrement
+    */
+    bool IsPlayback() const { return playback.IsOpen(); }
+
+    /*
+      retourne true si le fil fait avancer une arène
+    */
+    bool IsArena() const { return arena.SnakeCount() > 0; }
+
+    LatencyStats inputLatency;  // Délai touche -> pas (à lire une fois le fil arrêté)
+    Autopilot autopilot;        // Pilote automatique (à lire une fois le fil arrêté)
+
+private:
+    void Launch();
+    void Run();
+    void Tick();
+    SimOutcome PlayerStep();
+    SimOutcome PlaybackStep();
+    void ArenaStep();
+    void Publish(Cell previousHead, Cell previousTail);
+
+    SimState state;                              // Appartient au fil de simulation
+    InputQueue turns;                            // Virages filtrés, un par pas
+    SpscQueue<SimCommand, 64> commands;          // Affichage -> simulation
+    TripleBuffer<SimSnapshot> snapshots;         // Simulation -> affichage
+    ReplayWriter recorder;                       // Enregistrement de la session
+    ReplayReader playback;                       // Relecture (si ouverte)
+    Arena arena;                                 // Arène (si démarrée par StartArena)
+    bool autopilotEnabled = false;               // Le pilote automatique joue à la place du joueur
+    uint64_t sequence = 0;
+    uint64_t generation = 0;
+    std::chrono::nanoseconds interval{ 0 };
+    bool manualStepping = false;                 // Pas joués par Advance, sans fil
+    const Level* level = nullptr;                // Niveau joué (nullptr : grille vide)
+    std::atomic<bool> running{ false };
+    std::thread thread;
+};
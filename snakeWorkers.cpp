@@ -0,0 +1,102 @@
+﻿#include "snakeWorkers.h"
+
+#include <algorithm>
+using namespace std;
+
+void WorkerPool::Init(uint32_t threadCount) {
+    Shutdown();
+    // Le fil appelant travaille aussi : il ne faut lancer que threadCount - 1 fils
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    stopping = false;
+    epoch = 0;
+    taskCount = 0;
+    nextTask.store(0);
+    for (uint32_t t = 1; t < threadCount; t++) {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+void WorkerPool::Shutdown() {
+    {
+        lock_guard<mutex> lock(runMutex);
+        stopping = true;
+    }
+    startSignal.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void WorkerPool::Run(uint32_t count, void* taskContext, TaskFunction taskFunction) {
+    if (count == 0) {
+        return;
+    }
+    // Une seule tâche ou aucun fil : inutile de réveiller qui que ce soit
+    if (count == 1 || workers.empty()) {
+        for (uint32_t i = 0; i < count; i++) {
+            taskFunction(taskContext, i);
+        }
+        return;
+    }
+    uint32_t runEpoch;
+    {
+        lock_guard<mutex> lock(runMutex);
+        function = taskFunction;
+        context = taskContext;
+        taskCount = count;
+        runEpoch = ++epoch;
+        remaining.store(count, memory_order_relaxed);
+        nextTask.store((uint64_t)runEpoch << 32, memory_order_release);
+    }
+    startSignal.notify_all();
+
+    RunTasks(runEpoch, taskFunction, taskContext, count);
+
+    unique_lock<mutex> lock(runMutex);
+    doneSignal.wait(lock, [this] { return remaining.load(memory_order_acquire) == 0; });
+}
+
+void WorkerPool::WorkerLoop() {
+    uint32_t seenEpoch = 0;
+    for (;;) {
+        TaskFunction runFunction;
+        void* runContext;
+        uint32_t runCount;
+        {
+            unique_lock<mutex> lock(runMutex);
+            startSignal.wait(lock, [&] { return stopping || epoch != seenEpoch; });
+            if (stopping) {
+                return;
+            }
+            seenEpoch = epoch;
+            runFunction = function;
+            runContext = context;
+            runCount = taskCount;
+        }
+        RunTasks(seenEpoch, runFunction, runContext, runCount);
+    }
+}
+
+void WorkerPool::RunTasks(uint32_t runEpoch, TaskFunction runFunction, void* runContext, uint32_t runCount) {
+    uint32_t finished = 0;
+    uint64_t cursor = nextTask.load(memory_order_acquire);
+    for (;;) {
+        // Travail déjà terminé (et peut-être remplacé) ou plus de tâche à prendre
+        if ((uint32_t)(cursor >> 32) != runEpoch || (uint32_t)cursor >= runCount) {
+            break;
+        }
+        if (!nextTask.compare_exchange_weak(cursor, cursor + 1, memory_order_acq_rel)) {
+            continue;
+        }
+        runFunction(runContext, (uint32_t)cursor);
+        finished++;
+        cursor = nextTask.load(memory_order_acquire);
+    }
+    if (finished > 0 && remaining.fetch_sub(finished, memory_order_acq_rel) == finished) {
+        lock_guard<mutex> lock(runMutex);
+        doneSignal.notify_one();
+    }
+}
@@ -0,0 +1,72 @@
+﻿// Groupe de fils d'exécution pour les boucles parallèles (sans dépendance à SFML)
+//
+// Run découpe un travail en tâches numérotées, prises une à une par les fils
+// (appelant compris) : les fils rapides absorbent le travail des fils
+// retardés. Les fils restent en attente entre deux appels ; un appel ne
+// crée aucun fil et n'alloue rien.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  Fils d'exécution partagés par des boucles parallèles successives
+*/
+class WorkerPool {
+public:
+    ~WorkerPool() { Shutdown(); }
+
+    /*
+      Lance les fils
+      parametre "threadCount" Nombre de fils, appelant compris (0 : un par cœur)
+    */
+    void Init(uint32_t threadCount);
+
+    /*
+      Arrête et attend les fils
+    */
+    void Shutdown();
+
+    /*
+      Appelle task(i) pour chaque i de [0, taskCount), réparti entre les fils,
+      et revient quand toutes les tâches sont faites
+      parametre "taskCount" Nombre de tâches
+      parametre "task" Fonction appelée avec le numéro de la tâche (doit vivre pendant l'appel)
+    */
+    template <class Task>
+    void Run(uint32_t taskCount, Task& task) {
+        Run(taskCount, &task, [](void* context, uint32_t index) { (*(Task*)context)(index); });
+    }
+
+    /*
+      retourne Le nombre de fils utilisés (appelant compris)
+    */
+    uint32_t ThreadCount() const { return (uint32_t)workers.size() + 1; }
+
+private:
+    typedef void (*TaskFunction)(void* context, uint32_t index);
+
+    void Run(uint32_t taskCount, void* context, TaskFunction function);
+    void WorkerLoop();
+    void RunTasks(uint32_t runEpoch, TaskFunction runFunction, void* runContext, uint32_t runCount);
+
+    TaskFunction function = nullptr;      // Tâche du travail en cours (protégé par runMutex)
+    void* context = nullptr;
+    uint32_t taskCount = 0;
+
+    std::vector<std::thread> workers;
+    std::mutex runMutex;
+    std::condition_variable startSignal;  // Un nouveau travail commence
+    std::condition_variable doneSignal;   // Toutes les tâches du travail sont faites
+    uint32_t epoch = 0;                   // Numéro du travail en cours (protégé par runMutex)
+    bool stopping = false;
+    // Prochaine tâche à prendre, avec le numéro du travail dans les 32 bits de poids fort :
+    // un fil en retard sur le travail précédent ne peut pas prendre une tâche du suivant
+    std::atomic<uint64_t> nextTask{ 0 };
+    std::atomic<uint32_t> remaining{ 0 }; // Tâches pas encore terminées
+};